@@ -0,0 +1,187 @@
+#include "Benchmark.h"
+
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/renderer/Renderer.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+void WriteJsonString(std::ostream& stream, std::string_view value)
+{
+    stream << '"';
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"': stream << "\\\""; break;
+        case '\\': stream << "\\\\"; break;
+        case '\b': stream << "\\b"; break;
+        case '\f': stream << "\\f"; break;
+        case '\n': stream << "\\n"; break;
+        case '\r': stream << "\\r"; break;
+        case '\t': stream << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                // Other control characters only have the \u form
+                const char* digits = "0123456789abcdef";
+                stream << "\\u00" << digits[(c >> 4) & 0xF] << digits[c & 0xF];
+            }
+            else
+            {
+                stream << c;
+            }
+            break;
+        }
+    }
+    stream << '"';
+}
+
+BenchmarkRecorder::BenchmarkRecorder(const std::string& sceneName, const BenchmarkSettings& settings)
+    : m_sceneName(sceneName), m_settings(settings)
+    , m_recording(false), m_frameStartTime(0.0), m_lastFrameStartTime(0.0)
+    , m_drawcalls(0.0), m_instances(0.0)
+    , m_issuedStateCalls(0.0), m_skippedStateCalls(0.0)
+    , m_visibleDrawcalls(0.0), m_culledDrawcalls(0.0), m_occludedDrawcalls(0.0), m_gpuDrawcalls(0.0), m_occlusionRasterTime(0.0)
+{
+    m_cpuTimes.reserve(settings.frameCount);
+    m_frameTimes.reserve(settings.frameCount);
+}
+
+void BenchmarkRecorder::BeginFrame(unsigned int frameIndex)
+{
+    m_lastFrameStartTime = m_frameStartTime;
+    m_frameStartTime = GetTime();
+
+    // The first recorded frame has no previous frame in the measured range, so it only has CPU time
+    bool wasRecording = m_recording;
+    m_recording = frameIndex >= m_settings.warmupFrames;
+    if (m_recording && wasRecording)
+    {
+        m_frameTimes.push_back(m_frameStartTime - m_lastFrameStartTime);
+    }
+}
+
+void BenchmarkRecorder::EndFrame(const DeviceGL& device, const Renderer& renderer)
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    m_cpuTimes.push_back(GetTime() - m_frameStartTime);
+
+    const DeviceGL::StateStats& stateStats = device.GetStateStats();
+    m_drawcalls += stateStats.drawcalls;
+    m_instances += stateStats.instances;
+    m_issuedStateCalls += stateStats.issuedCalls;
+    m_skippedStateCalls += stateStats.skippedCalls;
+
+    const Renderer::CullingStats& cullingStats = renderer.GetCullingStats();
+    m_visibleDrawcalls += cullingStats.visibleDrawcalls;
+    m_culledDrawcalls += cullingStats.culledDrawcalls;
+    m_occludedDrawcalls += cullingStats.occludedDrawcalls;
+    m_gpuDrawcalls += cullingStats.gpuDrawcalls;
+    m_occlusionRasterTime += renderer.GetFrameStats().occlusion.rasterTime;
+
+    // Timer results arrive a few frames late, so these are the times of an earlier frame. Skip passes without results yet
+    std::span<const RenderPassTimers::PassTiming> passTimings = renderer.GetPassTimers().GetPassTimings();
+    if (m_passTimes.size() < passTimings.size())
+    {
+        m_passTimes.resize(passTimings.size());
+    }
+    for (size_t i = 0; i < passTimings.size(); ++i)
+    {
+        const RenderPassTimers::PassTiming& passTiming = passTimings[i];
+        if (passTiming.historyCount > 0)
+        {
+            m_passTimes[i].name = passTiming.name;
+            m_passTimes[i].totalTime += passTiming.lastTime;
+            m_passTimes[i].totalSamplesPerPixel += passTiming.samplesPerPixel;
+            ++m_passTimes[i].sampleCount;
+        }
+    }
+}
+
+void BenchmarkRecorder::WriteJson(std::ostream& stream, int indent) const
+{
+    std::string pad(indent, ' ');
+    double frameCount = std::max(static_cast<double>(m_cpuTimes.size()), 1.0);
+
+    stream << std::fixed << std::setprecision(4);
+    stream << pad << "{\n";
+    stream << pad << "  \"name\": ";
+    WriteJsonString(stream, m_sceneName);
+    stream << ",\n";
+    stream << pad << "  \"frames\": " << m_cpuTimes.size() << ",\n";
+    stream << pad << "  \"cpuTimeMs\": ";
+    WritePercentiles(stream, m_cpuTimes);
+    stream << ",\n";
+    stream << pad << "  \"frameTimeMs\": ";
+    WritePercentiles(stream, m_frameTimes);
+    stream << ",\n";
+    stream << pad << "  \"drawcalls\": " << m_drawcalls / frameCount << ",\n";
+    stream << pad << "  \"instances\": " << m_instances / frameCount << ",\n";
+    stream << pad << "  \"stateChanges\": { \"issued\": " << m_issuedStateCalls / frameCount
+        << ", \"skipped\": " << m_skippedStateCalls / frameCount << " },\n";
+    stream << pad << "  \"culling\": { \"visible\": " << m_visibleDrawcalls / frameCount
+        << ", \"culled\": " << m_culledDrawcalls / frameCount
+        << ", \"occluded\": " << m_occludedDrawcalls / frameCount
+        << ", \"gpu\": " << m_gpuDrawcalls / frameCount
+        << ", \"occlusionRasterMs\": " << m_occlusionRasterTime / frameCount << " },\n";
+    stream << pad << "  \"gpuPasses\": [";
+    bool first = true;
+    for (size_t i = 0; i < m_passTimes.size(); ++i)
+    {
+        const PassTime& passTime = m_passTimes[i];
+        if (passTime.sampleCount == 0)
+        {
+            continue;
+        }
+        stream << (first ? "\n" : ",\n") << pad << "    { \"index\": " << i << ", \"name\": ";
+        WriteJsonString(stream, passTime.name);
+        stream << ", \"timeMs\": " << passTime.totalTime / passTime.sampleCount
+            << ", \"samplesPerPixel\": " << passTime.totalSamplesPerPixel / passTime.sampleCount << " }";
+        first = false;
+    }
+    stream << (first ? "]\n" : "\n" + pad + "  ]\n");
+    stream << pad << "}";
+}
+
+double BenchmarkRecorder::GetTime()
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    return std::chrono::duration_cast<Milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void BenchmarkRecorder::WritePercentiles(std::ostream& stream, std::vector<double> values)
+{
+    if (values.empty())
+    {
+        stream << "null";
+        return;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    // Nearest rank percentile
+    auto percentile = [&values](double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::clamp(rank, size_t(1), values.size()) - 1];
+    };
+
+    double sum = 0.0;
+    for (double value : values)
+    {
+        sum += value;
+    }
+
+    stream << "{ \"mean\": " << sum / values.size()
+        << ", \"min\": " << values.front()
+        << ", \"p50\": " << percentile(50.0)
+        << ", \"p95\": " << percentile(95.0)
+        << ", \"p99\": " << percentile(99.0)
+        << ", \"max\": " << values.back() << " }";
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DeviceGL;
+class Renderer;
+
+// Settings shared by all the benchmark scenes
+struct BenchmarkSettings
+{
+    // Frames measured, after the warmup frames
+    unsigned int frameCount = 600;
+    unsigned int warmupFrames = 60;
+    // Simulated time of each frame, so that all the runs render the same frames
+    float deltaTime = 1.0f / 60.0f;
+    // Size of the offscreen framebuffer
+    int width = 1280;
+    int height = 720;
+    // Seed for rand(), used by the scenes that place things randomly
+    unsigned int seed = 1;
+    // Fireflies of the fireflies scenes
+    unsigned int fireflyCount = 64;
+    // Lights and extra models of the stress scene
+    unsigned int stressLightCount = 256;
+    unsigned int stressModelCount = 1024;
+};
+
+// Write the value as a quoted JSON string, escaping quotes, backslashes and control characters
+void WriteJsonString(std::ostream& stream, std::string_view value);
+
+// Measurements of one scene, collected frame by frame
+class BenchmarkRecorder
+{
+public:
+    BenchmarkRecorder(const std::string& sceneName, const BenchmarkSettings& settings);
+
+    const std::string& GetSceneName() const { return m_sceneName; }
+
+    // Called at the start of each frame. Frames before the warmup ends are not recorded
+    void BeginFrame(unsigned int frameIndex);
+    // Called when the CPU finished submitting the frame. Reads the stats of the device and the renderer
+    void EndFrame(const DeviceGL& device, const Renderer& renderer);
+
+    unsigned int GetRecordedFrameCount() const { return static_cast<unsigned int>(m_cpuTimes.size()); }
+
+    // Write the results as a JSON object
+    void WriteJson(std::ostream& stream, int indent) const;
+
+private:
+    static double GetTime();
+    static void WritePercentiles(std::ostream& stream, std::vector<double> values);
+
+private:
+    std::string m_sceneName;
+    const BenchmarkSettings& m_settings;
+
+    bool m_recording;
+    double m_frameStartTime;
+    double m_lastFrameStartTime;
+
+    // Milliseconds from the start of Update to the end of Render, and between the start of consecutive frames
+    std::vector<double> m_cpuTimes;
+    std::vector<double> m_frameTimes;
+
+    // Sums over the recorded frames
+    double m_drawcalls;
+    double m_instances;
+    double m_issuedStateCalls;
+    double m_skippedStateCalls;
+    double m_visibleDrawcalls;
+    double m_culledDrawcalls;
+    double m_occludedDrawcalls;
+    // Static drawcalls left to the GPU culling, its results are not read back
+    double m_gpuDrawcalls;
+    // Milliseconds spent rasterizing the occluders on the CPU
+    double m_occlusionRasterTime;
+
+    // GPU time and samples per pixel of each render pass, summed over the frames with a new sample
+    struct PassTime
+    {
+        const char* name = nullptr;
+        double totalTime = 0.0;
+        double totalSamplesPerPixel = 0.0;
+        unsigned int sampleCount = 0;
+    };
+    std::vector<PassTime> m_passTimes;
+};
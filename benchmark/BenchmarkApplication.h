@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include <ituGL/camera/CameraPath.h>
+
+class Renderer;
+
+// Runs an application headless while its camera follows a path, recording each frame
+// Derived classes move the camera of the application. The application gives access to its renderer with GetRenderer
+template<class App>
+class BenchmarkApplication : public App
+{
+public:
+    BenchmarkApplication(BenchmarkRecorder& recorder, const CameraPath& cameraPath)
+        : m_recorder(recorder), m_cameraPath(cameraPath)
+    {
+    }
+
+protected:
+    void Update() override
+    {
+        m_recorder.BeginFrame(App::GetFrameCount());
+
+        // Move the camera before the application reads it
+        ApplyCamera(m_cameraPath, App::GetCurrentTime());
+
+        App::Update();
+    }
+
+    void Render() override
+    {
+        App::Render();
+
+        m_recorder.EndFrame(App::GetDevice(), App::GetRenderer());
+    }
+
+    virtual void ApplyCamera(const CameraPath& cameraPath, float time) = 0;
+
+private:
+    BenchmarkRecorder& m_recorder;
+    const CameraPath& m_cameraPath;
+};
@@ -0,0 +1,229 @@
+#include "BenchmarkScenes.h"
+
+#include "BenchmarkApplication.h"
+
+#include <exercise07/FirefliesApplication.h>
+#include <exercise08/SceneViewerApplication.h>
+#include <exercise09/PostFXSceneViewerApplication.h>
+#include <exercise10/RaymarchingApplication.h>
+#include <exercise11/RaytracingApplication.h>
+#include <ituGL/geometry/OccluderMesh.h>
+#include <ituGL/scene/Bounds.h>
+#include <ituGL/scene/SceneCamera.h>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/transform.hpp>
+#include <cmath>
+#include <cstdlib>
+
+// Fireflies over the floor, with one of the render modes
+// The stress scene adds more fireflies, and copies of the firefly model that don't move
+// Walls across the floor hide the models behind them, to measure occlusion culling on the CPU or on the GPU
+class FirefliesBenchmark : public BenchmarkApplication<FirefliesApplication>
+{
+public:
+    using FirefliesApplication::RenderMode;
+
+    FirefliesBenchmark(BenchmarkRecorder& recorder, const CameraPath& cameraPath, RenderMode renderMode,
+        unsigned int fireflyCount, unsigned int staticModelCount, bool depthPrePass, unsigned int wallCount = 0, bool gpuCulling = false)
+        : BenchmarkApplication(recorder, cameraPath)
+        , m_fireflyCount(fireflyCount), m_staticModelCount(staticModelCount), m_depthPrePass(depthPrePass), m_wallCount(wallCount)
+        , m_gpuCulling(gpuCulling)
+    {
+        SetRenderMode(renderMode);
+    }
+
+protected:
+    void Initialize() override
+    {
+        FirefliesApplication::Initialize();
+
+        Renderer& renderer = GetRenderer();
+        renderer.SetDepthPrePassEnabled(0, m_depthPrePass);
+        renderer.SetGpuCullingEnabled(m_gpuCulling);
+
+        for (unsigned int i = 0; i < m_fireflyCount; ++i)
+        {
+            AddFirefly(glm::vec2(RandomRange(-1.0f, 1.0f), RandomRange(-1.0f, 1.0f)));
+        }
+
+        // Square grid over the floor
+        unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(m_staticModelCount))));
+        for (unsigned int i = 0; i < m_staticModelCount; ++i)
+        {
+            glm::vec2 position = (glm::vec2(i % side, i / side) / std::max(side - 1.0f, 1.0f)) * 8.0f - 4.0f;
+            renderer.AddStaticModel(GetFireflyModel(), glm::translate(glm::vec3(position.x, 0.25f, position.y)) * glm::scale(glm::vec3(0.25f)));
+        }
+
+        // Walls are two copies of the floor standing back to back, so they are seen from both sides
+        // The occluder is the plane between them, the floor is 10 units wide and only a bit thicker than its base
+        m_wallOccluder = OccluderMesh::CreateBox(AabbBounds(glm::vec3(0.0f), glm::vec3(5.0f, 0.0f, 5.0f)));
+        const float wallHeight = 1.5f;
+        for (unsigned int i = 0; i < m_wallCount; ++i)
+        {
+            float z = m_wallCount > 1 ? (i / (m_wallCount - 1.0f)) * 6.0f - 3.0f : 0.0f;
+            glm::mat4 translation = glm::translate(glm::vec3(0.0f, wallHeight * 0.5f, z));
+            glm::mat4 scale = glm::scale(glm::vec3(0.9f, 1.0f, wallHeight / 10.0f));
+            glm::mat4 frontMatrix = translation * glm::rotate(glm::half_pi<float>(), glm::vec3(1, 0, 0)) * scale;
+            glm::mat4 backMatrix = translation * glm::rotate(-glm::half_pi<float>(), glm::vec3(1, 0, 0)) * scale;
+            renderer.AddStaticModel(GetFloorModel(), frontMatrix);
+            renderer.AddStaticModel(GetFloorModel(), backMatrix);
+            m_wallMatrices.push_back(frontMatrix);
+        }
+    }
+
+    void Update() override
+    {
+        BenchmarkApplication::Update();
+
+        // Occluders are only kept for one frame, like the dynamic models
+        for (const glm::mat4& wallMatrix : m_wallMatrices)
+        {
+            GetRenderer().AddOccluder(m_wallOccluder, wallMatrix);
+        }
+    }
+
+    void ApplyCamera(const CameraPath& cameraPath, float time) override
+    {
+        cameraPath.Apply(time, GetCamera());
+    }
+
+private:
+    unsigned int m_fireflyCount;
+    unsigned int m_staticModelCount;
+    bool m_depthPrePass;
+    unsigned int m_wallCount;
+    bool m_gpuCulling;
+
+    OccluderMesh m_wallOccluder;
+    std::vector<glm::mat4> m_wallMatrices;
+};
+
+// Applications with a camera controller. The camera is moved through the scene camera, so its transform stays in sync
+template<class App>
+class CameraControllerBenchmark : public BenchmarkApplication<App>
+{
+public:
+    CameraControllerBenchmark(BenchmarkRecorder& recorder, const CameraPath& cameraPath)
+        : BenchmarkApplication<App>(recorder, cameraPath)
+    {
+    }
+
+protected:
+    void ApplyCamera(const CameraPath& cameraPath, float time) override
+    {
+        std::shared_ptr<SceneCamera> sceneCamera = App::GetCameraController().GetCamera();
+        cameraPath.Apply(time, *sceneCamera->GetCamera());
+        sceneCamera->MatchTransformToCamera();
+    }
+};
+
+// The raytracer accumulates frames while the camera doesn't move, so it has to restart every frame
+class RaytracingBenchmark : public CameraControllerBenchmark<RaytracingApplication>
+{
+public:
+    using CameraControllerBenchmark::CameraControllerBenchmark;
+
+protected:
+    void ApplyCamera(const CameraPath& cameraPath, float time) override
+    {
+        CameraControllerBenchmark::ApplyCamera(cameraPath, time);
+        InvalidateScene();
+    }
+};
+
+// Post FX viewer, with the mip chain bloom or the separable blur it replaced
+class PostFXBenchmark : public CameraControllerBenchmark<PostFXSceneViewerApplication>
+{
+public:
+    PostFXBenchmark(BenchmarkRecorder& recorder, const CameraPath& cameraPath, bool mipChainBloom)
+        : CameraControllerBenchmark(recorder, cameraPath)
+    {
+        SetMipChainBloom(mipChainBloom);
+    }
+};
+
+template<class Benchmark, typename... Args>
+static int RunBenchmark(BenchmarkRecorder& recorder, const CameraPath& cameraPath, Args... args)
+{
+    Benchmark benchmark(recorder, cameraPath, args...);
+    return benchmark.Run();
+}
+
+std::vector<BenchmarkScene> GetBenchmarkScenes()
+{
+    using RenderMode = FirefliesBenchmark::RenderMode;
+
+    // Paths take 10 seconds, so the default frame count goes around once
+    const float duration = 10.0f;
+
+    return std::vector<BenchmarkScene>
+    {
+        { "fireflies-forward", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 3.0f, 6.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::Forward, settings.fireflyCount, 0u, false);
+            } },
+        { "fireflies-clustered", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 3.0f, 6.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::ClusteredForward, settings.fireflyCount, 0u, false);
+            } },
+        { "fireflies-deferred", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 3.0f, 6.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::Deferred, settings.fireflyCount, 0u, false);
+            } },
+        { "fireflies-forward-prepass", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 3.0f, 6.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::Forward, settings.fireflyCount, 0u, true);
+            } },
+        { "fireflies-deferred-prepass", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 3.0f, 6.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::Deferred, settings.fireflyCount, 0u, true);
+            } },
+        { "stress", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 4.0f, 4.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::ClusteredForward, settings.stressLightCount, settings.stressModelCount, false);
+            } },
+        { "stress-occlusion", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                // Low camera, so the walls hide most of the models
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 6.0f, 1.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::ClusteredForward, settings.stressLightCount, settings.stressModelCount, false, 4u);
+            } },
+        { "stress-occlusion-gpu", "exercise07", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                // Deferred, for the g-buffer depth the hierarchical-Z is built from. Falls back to CPU culling without OpenGL 4.3
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 6.0f, 1.0f, duration);
+                return RunBenchmark<FirefliesBenchmark>(recorder, path, RenderMode::Deferred, settings.stressLightCount, settings.stressModelCount, false, 4u, true);
+            } },
+        { "scene-viewer", "exercise08", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 1.5f, 1.0f, duration);
+                return RunBenchmark<CameraControllerBenchmark<SceneViewerApplication>>(recorder, path);
+            } },
+        { "postfx", "exercise09", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f, 0.5f, 0.0f), 2.8f, 0.5f, duration);
+                return RunBenchmark<PostFXBenchmark>(recorder, path, true);
+            } },
+        { "postfx-blur-bloom", "exercise09", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f, 0.5f, 0.0f), 2.8f, 0.5f, duration);
+                return RunBenchmark<PostFXBenchmark>(recorder, path, false);
+            } },
+        { "raymarching", "exercise10", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f, 0.0f, -10.0f), 6.0f, 1.0f, duration);
+                return RunBenchmark<CameraControllerBenchmark<RaymarchingApplication>>(recorder, path);
+            } },
+        { "raytracing", "exercise11", [=](BenchmarkRecorder& recorder, const BenchmarkSettings& settings)
+            {
+                CameraPath path = CameraPath::CreateOrbit(glm::vec3(0.0f), 10.0f, 2.0f, duration);
+                return RunBenchmark<RaytracingBenchmark>(recorder, path);
+            } },
+    };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Benchmark.h"
+
+#include <functional>
+#include <vector>
+
+// Scene of the benchmark, that runs one of the exercise applications
+struct BenchmarkScene
+{
+    const char* name;
+    // Folder of the exercise, that the application loads its assets from
+    const char* exercise;
+    // Run the application until all the frames are rendered, and return its exit code
+    std::function<int(BenchmarkRecorder& recorder, const BenchmarkSettings& settings)> run;
+};
+
+std::vector<BenchmarkScene> GetBenchmarkScenes();
@@ -0,0 +1,205 @@
+#include "Benchmark.h"
+#include "BenchmarkScenes.h"
+
+#include <ituGL/application/Application.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+static void PrintUsage(const std::vector<BenchmarkScene>& scenes)
+{
+    std::cerr << "Usage: itugl_bench [options]\n"
+        << "  --scene NAME     Run only this scene, can be repeated. Default runs all of them\n"
+        << "  --frames N       Frames measured in each scene\n"
+        << "  --warmup N       Frames rendered before measuring\n"
+        << "  --delta SECONDS  Simulated time of each frame\n"
+        << "  --width N        Width of the offscreen framebuffer\n"
+        << "  --height N       Height of the offscreen framebuffer\n"
+        << "  --fireflies N    Fireflies of the fireflies scenes\n"
+        << "  --lights N       Lights of the stress scenes\n"
+        << "  --models N       Extra models of the stress scenes\n"
+        << "  --seed N         Seed for the random placement\n"
+        << "  --output PATH    Write the JSON to a file instead of stdout\n"
+        << "Scenes:";
+    for (const BenchmarkScene& scene : scenes)
+    {
+        std::cerr << " " << scene.name;
+    }
+    std::cerr << std::endl;
+}
+
+// Parse the whole value as an integer of at least minValue. atoi would turn text into 0, and negative values into huge counts
+template<typename T>
+static bool ParseInteger(const char* value, long minValue, T& result)
+{
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0' || errno == ERANGE || parsed < minValue || parsed > std::numeric_limits<int>::max())
+    {
+        return false;
+    }
+    result = static_cast<T>(parsed);
+    return true;
+}
+
+// Sizes and frame counts of 0 can't be rendered
+template<typename T>
+static bool ParsePositive(const char* value, T& result)
+{
+    return ParseInteger(value, 1, result);
+}
+
+template<typename T>
+static bool ParseNonNegative(const char* value, T& result)
+{
+    return ParseInteger(value, 0, result);
+}
+
+// Without a positive delta the application falls back to the wall clock, and the frames are not the same between runs
+static bool ParsePositive(const char* value, float& result)
+{
+    char* end = nullptr;
+    float parsed = std::strtof(value, &end);
+    if (end == value || *end != '\0' || !(parsed > 0.0f) || !std::isfinite(parsed))
+    {
+        return false;
+    }
+    result = parsed;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<BenchmarkScene> scenes = GetBenchmarkScenes();
+
+    BenchmarkSettings settings;
+    std::vector<std::string> sceneNames;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value)
+        {
+            PrintUsage(scenes);
+            return 1;
+        }
+        ++i;
+
+        bool valid = true;
+        if (std::strcmp(arg, "--scene") == 0) sceneNames.push_back(value);
+        else if (std::strcmp(arg, "--frames") == 0) valid = ParsePositive(value, settings.frameCount);
+        else if (std::strcmp(arg, "--warmup") == 0) valid = ParseNonNegative(value, settings.warmupFrames);
+        else if (std::strcmp(arg, "--delta") == 0) valid = ParsePositive(value, settings.deltaTime);
+        else if (std::strcmp(arg, "--width") == 0) valid = ParsePositive(value, settings.width);
+        else if (std::strcmp(arg, "--height") == 0) valid = ParsePositive(value, settings.height);
+        else if (std::strcmp(arg, "--fireflies") == 0) valid = ParseNonNegative(value, settings.fireflyCount);
+        else if (std::strcmp(arg, "--lights") == 0) valid = ParseNonNegative(value, settings.stressLightCount);
+        else if (std::strcmp(arg, "--models") == 0) valid = ParseNonNegative(value, settings.stressModelCount);
+        else if (std::strcmp(arg, "--seed") == 0) valid = ParseNonNegative(value, settings.seed);
+        else if (std::strcmp(arg, "--output") == 0) outputPath = value;
+        else valid = false;
+
+        if (!valid)
+        {
+            PrintUsage(scenes);
+            return 1;
+        }
+    }
+
+    for (const std::string& sceneName : sceneNames)
+    {
+        bool found = false;
+        for (const BenchmarkScene& scene : scenes)
+        {
+            found |= sceneName == scene.name;
+        }
+        if (!found)
+        {
+            std::cerr << "Unknown scene: " << sceneName << std::endl;
+            PrintUsage(scenes);
+            return 1;
+        }
+    }
+
+    // Scenes change the working directory, so keep the output relative to where the benchmark was started
+    if (!outputPath.empty())
+    {
+        outputPath = std::filesystem::absolute(outputPath).string();
+    }
+
+    // Every scene runs headless with the same frames
+    Application::HeadlessSettings headlessSettings;
+    headlessSettings.enabled = true;
+    headlessSettings.width = settings.width;
+    headlessSettings.height = settings.height;
+    headlessSettings.frameCount = settings.warmupFrames + settings.frameCount;
+    headlessSettings.fixedDeltaTime = settings.deltaTime;
+    Application::SetDefaultHeadlessSettings(headlessSettings);
+
+    std::ostringstream scenesJson;
+    bool first = true;
+    int result = 0;
+    for (const BenchmarkScene& scene : scenes)
+    {
+        if (!sceneNames.empty() && std::find(sceneNames.begin(), sceneNames.end(), scene.name) == sceneNames.end())
+        {
+            continue;
+        }
+
+        std::cerr << "Running " << scene.name << std::endl;
+
+        // Applications load their assets relative to their exercise folder
+        std::filesystem::current_path(std::filesystem::path(ITUGL_EXERCISES_PATH) / scene.exercise);
+        std::srand(settings.seed);
+
+        BenchmarkRecorder recorder(scene.name, settings);
+        int sceneResult = scene.run(recorder, settings);
+        if (sceneResult != 0)
+        {
+            std::cerr << "Scene " << scene.name << " failed with code " << sceneResult << std::endl;
+            result = sceneResult;
+            continue;
+        }
+
+        scenesJson << (first ? "\n" : ",\n");
+        recorder.WriteJson(scenesJson, 4);
+        first = false;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty())
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputPath.empty() ? std::cout : file;
+
+    output << "{\n  \"settings\": {"
+        << "\"frames\": " << settings.frameCount
+        << ", \"warmup\": " << settings.warmupFrames
+        << ", \"deltaTime\": " << settings.deltaTime
+        << ", \"width\": " << settings.width
+        << ", \"height\": " << settings.height
+        << ", \"seed\": " << settings.seed
+        << ", \"fireflies\": " << settings.fireflyCount
+        << ", \"stressLights\": " << settings.stressLightCount
+        << ", \"stressModels\": " << settings.stressModelCount
+        << "},\n  \"scenes\": [" << scenesJson.str() << "\n  ]\n}\n";
+
+    return result;
+}
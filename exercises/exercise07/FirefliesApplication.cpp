@@ -4,8 +4,11 @@
 #include <ituGL/asset/ModelLoader.h>
 #include <ituGL/asset/Texture2DLoader.h>
 #include <ituGL/shader/Material.h>
+#include <ituGL/renderer/DepthPrePassRenderPass.h>
 #include <ituGL/renderer/ForwardRenderPass.h>
+#include <ituGL/renderer/ClusteredForwardRenderPass.h>
 #include <ituGL/renderer/GBufferRenderPass.h>
+#include <ituGL/renderer/HiZRenderPass.h>
 #include <ituGL/renderer/DeferredRenderPass.h>
 #include <glm/gtx/transform.hpp>
 #include <imgui.h>
@@ -50,6 +53,7 @@ void FirefliesApplication::Update()
 
     // Set current camera
     m_renderer.SetCurrentCamera(m_camera);
+    m_renderer.SetTime(GetCurrentTime());
 }
 
 void FirefliesApplication::Render()
@@ -118,10 +122,18 @@ Renderer::UpdateLightsFunction FirefliesApplication::GetUpdateLightsFunction(std
 }
 
 void FirefliesApplication::InitializeForwardMaterials()
+{
+    m_forwardMaterial = CreateForwardMaterial(false);
+    m_clusteredMaterial = CreateForwardMaterial(true);
+}
+
+std::shared_ptr<Material> FirefliesApplication::CreateForwardMaterial(bool clustered)
 {
     // Load and build shader
     std::vector<const char*> vertexShaderPaths;
     vertexShaderPaths.push_back("shaders/version330.glsl");
+    vertexShaderPaths.push_back("shaders/instancing.glsl");
+    vertexShaderPaths.push_back("shaders/utils.glsl");
     vertexShaderPaths.push_back("shaders/lit.vert");
     Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
@@ -130,6 +142,10 @@ void FirefliesApplication::InitializeForwardMaterials()
     fragmentShaderPaths.push_back("shaders/utils.glsl");
     fragmentShaderPaths.push_back("shaders/blinn-phong.glsl");
     fragmentShaderPaths.push_back("shaders/lighting.glsl");
+    if (clustered)
+    {
+        fragmentShaderPaths.push_back("shaders/clustered.glsl");
+    }
     fragmentShaderPaths.push_back("shaders/lit.frag");
     Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
 
@@ -137,19 +153,13 @@ void FirefliesApplication::InitializeForwardMaterials()
     shaderProgramPtr->Build(vertexShader, fragmentShader);
 
     // Get transform related uniform locations
-    ShaderProgram::Location cameraPositionLocation = shaderProgramPtr->GetUniformLocation("CameraPosition");
+    // Camera matrices and position come from the frame uniforms
     ShaderProgram::Location worldMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldMatrix");
-    ShaderProgram::Location viewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("ViewProjMatrix");
 
     // Register shader with renderer
     m_renderer.RegisterShaderProgram(shaderProgramPtr,
         [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
         {
-            if (cameraChanged)
-            {
-                shaderProgram.SetUniform(cameraPositionLocation, camera.ExtractTranslation());
-                shaderProgram.SetUniform(viewProjMatrixLocation, camera.GetViewProjectionMatrix());
-            }
             shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
         },
         GetUpdateLightsFunction(shaderProgramPtr)
@@ -158,15 +168,18 @@ void FirefliesApplication::InitializeForwardMaterials()
     // Filter out uniforms that are not material properties
     ShaderUniformCollection::NameSet filteredUniforms;
     filteredUniforms.insert("WorldMatrix");
-    filteredUniforms.insert("ViewProjMatrix");
     filteredUniforms.insert("AmbientColor");
     filteredUniforms.insert("LightColor");
     filteredUniforms.insert("LightPosition");
     filteredUniforms.insert("LightDirection");
     filteredUniforms.insert("LightAttenuation");
+    // Cluster textures are bound by the clustered pass
+    filteredUniforms.insert("LightDataTexture");
+    filteredUniforms.insert("ClusterRangesTexture");
+    filteredUniforms.insert("LightIndicesTexture");
 
     // Create reference material
-    m_forwardMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+    return std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
 }
 
 void FirefliesApplication::InitializeDeferredMaterials()
@@ -176,6 +189,8 @@ void FirefliesApplication::InitializeDeferredMaterials()
         // Load and build shader
         std::vector<const char*> vertexShaderPaths;
         vertexShaderPaths.push_back("shaders/version330.glsl");
+        vertexShaderPaths.push_back("shaders/instancing.glsl");
+        vertexShaderPaths.push_back("shaders/utils.glsl");
         vertexShaderPaths.push_back("shaders/gbuffer.vert");
         Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
@@ -188,23 +203,21 @@ void FirefliesApplication::InitializeDeferredMaterials()
         shaderProgramPtr->Build(vertexShader, fragmentShader);
 
         // Get transform related uniform locations
-        ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
-        ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+        // Camera matrices come from the frame uniforms, and instanced shaders get the world matrix per instance
+        ShaderProgram::Location worldMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldMatrix");
 
         // Register shader with renderer
         m_renderer.RegisterShaderProgram(shaderProgramPtr,
             [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
             {
-                shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
-                shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+                shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
             },
             nullptr
         );
 
         // Filter out uniforms that are not material properties
         ShaderUniformCollection::NameSet filteredUniforms;
-        filteredUniforms.insert("WorldViewMatrix");
-        filteredUniforms.insert("WorldViewProjMatrix");
+        filteredUniforms.insert("WorldMatrix");
 
         // Create material
         m_gbufferMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
@@ -230,23 +243,16 @@ void FirefliesApplication::InitializeDeferredMaterials()
 
         // Filter out uniforms that are not material properties
         ShaderUniformCollection::NameSet filteredUniforms;
-        filteredUniforms.insert("InvProjMatrix");
         filteredUniforms.insert("WorldViewProjMatrix");
 
         // Get transform related uniform locations
-        ShaderProgram::Location invViewMatrixLocation = shaderProgramPtr->GetUniformLocation("InvViewMatrix");
-        ShaderProgram::Location invProjMatrixLocation = shaderProgramPtr->GetUniformLocation("InvProjMatrix");
+        // Inverse camera matrices come from the frame uniforms
         ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
 
         // Register shader with renderer
         m_renderer.RegisterShaderProgram(shaderProgramPtr,
             [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
             {
-                if (cameraChanged)
-                {
-                    shaderProgram.SetUniform(invViewMatrixLocation, glm::inverse(camera.GetViewMatrix()));
-                    shaderProgram.SetUniform(invProjMatrixLocation, glm::inverse(camera.GetProjectionMatrix()));
-                }
                 shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
             },
             GetUpdateLightsFunction(shaderProgramPtr)
@@ -259,7 +265,19 @@ void FirefliesApplication::InitializeDeferredMaterials()
 
 void FirefliesApplication::InitializeModels()
 {
-    std::shared_ptr<Material> material = m_renderMode == RenderMode::Forward ? m_forwardMaterial : m_gbufferMaterial;
+    std::shared_ptr<Material> material;
+    switch (m_renderMode)
+    {
+    case RenderMode::Forward:
+        material = m_forwardMaterial;
+        break;
+    case RenderMode::ClusteredForward:
+        material = m_clusteredMaterial;
+        break;
+    case RenderMode::Deferred:
+        material = m_gbufferMaterial;
+        break;
+    }
 
     material->SetUniformValue("Color", glm::vec3(1.0f));
     material->SetUniformValue("AmbientReflectance", 1.0f);
@@ -276,6 +294,8 @@ void FirefliesApplication::InitializeModels()
     loader.SetMaterialProperty(ModelLoader::MaterialProperty::DiffuseColor, "Color");
     loader.SetMaterialProperty(ModelLoader::MaterialProperty::DiffuseTexture, "ColorTexture");
     loader.SetMaterialProperty(ModelLoader::MaterialProperty::SpecularExponent, "SpecularExponent");
+    // Crowded views draw the far models with fewer triangles
+    loader.SetLodCount(4);
 
     // Load models
     m_fireflyModel = loader.Load("models/firefly/firefly.obj");
@@ -305,8 +325,13 @@ void FirefliesApplication::InitializeRenderer()
     switch (m_renderMode)
     {
     case RenderMode::Forward:
+        m_renderer.AddRenderPass(std::make_unique<DepthPrePassRenderPass>());
         m_renderer.AddRenderPass(std::make_unique<ForwardRenderPass>());
         break;
+    case RenderMode::ClusteredForward:
+        m_renderer.AddRenderPass(std::make_unique<DepthPrePassRenderPass>());
+        m_renderer.AddRenderPass(std::make_unique<ClusteredForwardRenderPass>());
+        break;
     case RenderMode::Deferred:
         {
             // Set up deferred passes
@@ -320,12 +345,19 @@ void FirefliesApplication::InitializeRenderer()
             m_deferredMaterial->SetUniformValue("NormalTexture", gbufferRenderPass->GetNormalTexture());
             m_deferredMaterial->SetUniformValue("OthersTexture", gbufferRenderPass->GetOthersTexture());
 
-            // Add the render passes
+            // Add the render passes. The pre-pass draws into the depth of the g-buffer, so it clears it
+            m_renderer.AddRenderPass(std::make_unique<DepthPrePassRenderPass>(0, gbufferRenderPass->GetTargetFramebuffer(), true));
+            std::shared_ptr<const Texture2DObject> depthTexture = gbufferRenderPass->GetDepthTexture();
             m_renderer.AddRenderPass(std::move(gbufferRenderPass));
+            // The depth of the g-buffer is used by GPU culling to hide static models in the next frame
+            m_renderer.AddRenderPass(std::make_unique<HiZRenderPass>(depthTexture, width, height));
             m_renderer.AddRenderPass(std::make_unique<DeferredRenderPass>(m_deferredMaterial));
             break;
         }
     }
+
+    // The floor never moves, so it is registered once instead of being added every frame
+    m_renderer.AddStaticModel(m_floorModel, glm::mat4(1.0f));
 }
 
 void FirefliesApplication::RenderGUI()
@@ -338,6 +370,28 @@ void FirefliesApplication::RenderGUI()
     ImGui::ColorEdit3("Light color", &m_lightColor[0]);
     ImGui::DragFloat("Light intensity", &m_lightIntensity, 0.05f, 0.0f, 100.0f);
     ImGui::Checkbox("Use random color", &m_useRandomColor);
+    ImGui::Separator();
+    bool depthPrePass = m_renderer.IsDepthPrePassEnabled(0);
+    if (ImGui::Checkbox("Depth pre-pass", &depthPrePass))
+    {
+        m_renderer.SetDepthPrePassEnabled(0, depthPrePass);
+    }
+    bool lodSelection = m_renderer.IsLodSelectionEnabled();
+    if (ImGui::Checkbox("Levels of detail", &lodSelection))
+    {
+        m_renderer.SetLodSelectionEnabled(lodSelection);
+    }
+    if (GpuCuller::IsSupported())
+    {
+        bool gpuCulling = m_renderer.IsGpuCullingEnabled();
+        if (ImGui::Checkbox("GPU culling", &gpuCulling))
+        {
+            m_renderer.SetGpuCullingEnabled(gpuCulling);
+        }
+    }
+
+    // Draw the work issued by the last frame
+    m_renderer.DrawFrameStatsGUI(m_imGui);
 
     m_imGui.EndFrame();
 }
@@ -356,7 +410,6 @@ void FirefliesApplication::UpdateFireflies()
         m_mouseClicked = false;
     }
 
-    m_renderer.AddModel(m_floorModel, glm::mat4(1.0f));
     for (Firefly& firefly : m_fireflies)
     {
         float deltaTime = GetDeltaTime();
@@ -23,8 +23,27 @@ protected:
     void Render() override;
     void Cleanup() override;
 
+    // Access for applications that extend this one, like the benchmark scenes
+    enum class RenderMode
+    {
+        Forward,
+        // Forward in a single pass, with the lights assigned to clusters of the view frustum
+        ClusteredForward,
+        Deferred
+    };
+    void SetRenderMode(RenderMode renderMode) { m_renderMode = renderMode; }
+
+    Renderer& GetRenderer() { return m_renderer; }
+    Camera& GetCamera() { return m_camera; }
+    const Model& GetFloorModel() const { return m_floorModel; }
+    const Model& GetFireflyModel() const { return m_fireflyModel; }
+
+    void AddFirefly(glm::vec2 position);
+    float RandomRange(float from, float to);
+
 private:
     void InitializeForwardMaterials();
+    std::shared_ptr<Material> CreateForwardMaterial(bool clustered);
     void InitializeDeferredMaterials();
     void InitializeModels();
     void InitializeCamera();
@@ -35,20 +54,12 @@ private:
 
     void UpdateFireflies();
 
-    void AddFirefly(glm::vec2 position);
-
     float Random01();
-    float RandomRange(float from, float to);
     Color RandomColor();
 
     void RenderGUI();
 
 private:
-    enum class RenderMode
-    {
-        Forward,
-        Deferred
-    };
     RenderMode m_renderMode;
 
     // Helper object for debug GUI
@@ -59,6 +70,7 @@ private:
 
     // Default materials
     std::shared_ptr<Material> m_forwardMaterial;
+    std::shared_ptr<Material> m_clusteredMaterial;
     std::shared_ptr<Material> m_gbufferMaterial;
     std::shared_ptr<Material> m_deferredMaterial;
 
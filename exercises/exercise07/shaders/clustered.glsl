@@ -0,0 +1,58 @@
+// Lights assigned to the clusters of the view frustum, filled by the LightClusters of the renderer
+// Must be included after lighting.glsl
+#define CLUSTERED
+
+layout(std140) uniform LightClusterUniforms
+{
+	// Number of clusters in x, y and z, and number of lights
+	uvec4 ClusterCount;
+	// Near and far distance, and scale and bias to get the depth slice from the log of the view depth
+	vec4 ClusterDepthParams;
+};
+
+// 4 texels per light: color, position, direction and attenuation
+uniform samplerBuffer LightDataTexture;
+// Offset in the light indices and number of lights of each cluster
+uniform usamplerBuffer ClusterRangesTexture;
+uniform usamplerBuffer LightIndicesTexture;
+
+// Cluster containing a world position. Clusters are uniform in screen space and exponential in depth
+int GetClusterIndex(vec3 position)
+{
+	vec4 clipPosition = ViewProjMatrix * vec4(position, 1);
+
+	vec2 clusterXY = (clipPosition.xy / clipPosition.w * 0.5f + 0.5f) * vec2(ClusterCount.xy);
+	ivec2 xy = clamp(ivec2(clusterXY), ivec2(0), ivec2(ClusterCount.xy) - 1);
+
+	// With a perspective projection, w is the depth in view space
+	float slice = log(clipPosition.w) * ClusterDepthParams.z + ClusterDepthParams.w;
+	int z = clamp(int(slice), 0, int(ClusterCount.z) - 1);
+
+	return (z * int(ClusterCount.y) + xy.y) * int(ClusterCount.x) + xy.x;
+}
+
+LightData GetClusterLight(int lightIndex)
+{
+	int texel = lightIndex * 4;
+
+	LightData light;
+	light.color = texelFetch(LightDataTexture, texel).rgb;
+	light.position = texelFetch(LightDataTexture, texel + 1).xyz;
+	light.direction = texelFetch(LightDataTexture, texel + 2).xyz;
+	light.attenuation = texelFetch(LightDataTexture, texel + 3);
+	return light;
+}
+
+vec3 ComputeClusteredLighting(vec3 position, SurfaceData data, vec3 viewDir)
+{
+	vec3 light = ComputeIndirectLighting(data, viewDir);
+
+	uvec2 range = texelFetch(ClusterRangesTexture, GetClusterIndex(position)).xy;
+	for (uint i = 0u; i < range.y; ++i)
+	{
+		int lightIndex = int(texelFetch(LightIndicesTexture, int(range.x + i)).r);
+		light += ComputeLight(GetClusterLight(lightIndex), data, viewDir, position);
+	}
+
+	return light;
+}
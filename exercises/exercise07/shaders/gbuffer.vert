@@ -2,17 +2,29 @@
 layout (location = 0) in vec3 VertexPosition;
 layout (location = 1) in vec3 VertexNormal;
 layout (location = 2) in vec2 VertexTexCoord;
+#ifdef INSTANCING
+layout (location = 12) in mat4 InstanceWorldMatrix;
+#endif
 
 //Outputs
 out vec3 ViewNormal;
 out vec2 TexCoord;
 
+// Must match the depth pre-pass
+invariant gl_Position;
+
 //Uniforms
-uniform mat4 WorldViewMatrix;
-uniform mat4 WorldViewProjMatrix;
+#ifndef INSTANCING
+uniform mat4 WorldMatrix;
+#endif
 
 void main()
 {
+#ifdef INSTANCING
+	mat4 WorldMatrix = InstanceWorldMatrix;
+#endif
+	mat4 WorldViewMatrix = ViewMatrix * WorldMatrix;
+
 	// normal in view space (for lighting computation)
 	ViewNormal = normalize((WorldViewMatrix * vec4(VertexNormal, 0.0)).xyz);
 
@@ -20,5 +32,6 @@ void main()
 	TexCoord = VertexTexCoord;
 
 	// final vertex position (for opengl rendering, not for lighting)
-	gl_Position = WorldViewProjMatrix * vec4(VertexPosition, 1.0);
+	// Same expression as the depth pre-pass, to get the same depth
+	gl_Position = ViewProjMatrix * (WorldMatrix * vec4(VertexPosition, 1.0));
 }
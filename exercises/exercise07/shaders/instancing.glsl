@@ -0,0 +1,2 @@
+// Include after version330.glsl to draw with per-instance world matrices
+#define INSTANCING
@@ -4,48 +4,80 @@ uniform vec3 LightPosition;
 uniform vec3 LightDirection;
 uniform vec4 LightAttenuation;
 
-float ComputeDistanceAttenuation(vec3 position)
+// Properties of one light, from the uniforms or from a light list
+struct LightData
 {
-	// Compute distance attenuation, reading the range from LightAttenuation.x (fade start) and LightAttenuation.y (fade end)
-	return smoothstep(LightAttenuation.y, LightAttenuation.x, distance(position, LightPosition));
+	vec3 color;
+	vec3 position;
+	vec3 direction;
+	vec4 attenuation;
+};
+
+LightData GetUniformLight()
+{
+	LightData light;
+	light.color = LightColor;
+	light.position = LightPosition;
+	light.direction = LightDirection;
+	light.attenuation = LightAttenuation;
+	return light;
+}
+
+float ComputeDistanceAttenuation(LightData light, vec3 position)
+{
+	// Compute distance attenuation, reading the range from attenuation.x (fade start) and attenuation.y (fade end)
+	return smoothstep(light.attenuation.y, light.attenuation.x, distance(position, light.position));
 }
 
-float ComputeAngularAttenuation(vec3 lightDir)
+float ComputeAngularAttenuation(LightData light, vec3 lightDir)
 {
-	float angle = acos(dot(LightDirection, lightDir));
-	vec2 attAngle = LightAttenuation.zw;
+	float angle = acos(dot(light.direction, lightDir));
+	vec2 attAngle = light.attenuation.zw;
 	return smoothstep(attAngle.y, attAngle.x, angle);
 }
 
-float ComputeAttenuation(vec3 position, vec3 lightDir)
+float ComputeAttenuation(LightData light, vec3 position, vec3 lightDir)
 {
 	float attenuation = 1.0f;
-	if (LightAttenuation.y > 0)
+	if (light.attenuation.y > 0)
 	{
-		attenuation *= ComputeDistanceAttenuation(position);
+		attenuation *= ComputeDistanceAttenuation(light, position);
 	}
-	if (LightAttenuation.w > 0)
+	if (light.attenuation.w > 0)
 	{
-		attenuation *= ComputeAngularAttenuation(lightDir);
+		attenuation *= ComputeAngularAttenuation(light, lightDir);
 	}
 	return attenuation;
 }
 
-vec3 ComputeLightDirection(vec3 position)
+vec3 ComputeLightDirection(LightData light, vec3 position)
 {
-	return LightAttenuation.y >= 0 ? GetDirection(position, LightPosition) : LightDirection;
+	return light.attenuation.y >= 0 ? GetDirection(position, light.position) : light.direction;
+}
+
+vec3 ComputeLight(LightData light, SurfaceData data, vec3 viewDir, vec3 position)
+{
+	vec3 lightDir = ComputeLightDirection(light, position);
+
+	vec3 lighting = vec3(0);
+	lighting += ComputeDiffuseLighting(data, lightDir);
+	lighting += ComputeSpecularLighting(data, lightDir, viewDir);
+
+	float attenuation = ComputeAttenuation(light, position, lightDir);
+	return lighting * light.color * attenuation;
 }
 
 vec3 ComputeLight(SurfaceData data, vec3 viewDir, vec3 position)
 {
-	vec3 lightDir = ComputeLightDirection(position);
+	return ComputeLight(GetUniformLight(), data, viewDir, position);
+}
 
+vec3 ComputeIndirectLighting(SurfaceData data, vec3 viewDir)
+{
 	vec3 light = vec3(0);
-	light += ComputeDiffuseLighting(data, lightDir);
-	light += ComputeSpecularLighting(data, lightDir, viewDir);
-
-	float attenuation = ComputeAttenuation(position, lightDir);
-	return light * LightColor * attenuation;
+	light += ComputeDiffuseIndirectLighting(data);
+	light += ComputeSpecularIndirectLighting(data, viewDir);
+	return light;
 }
 
 vec3 ComputeLighting(vec3 position, SurfaceData data, vec3 viewDir, bool indirect)
@@ -54,8 +86,7 @@ vec3 ComputeLighting(vec3 position, SurfaceData data, vec3 viewDir, bool indirec
 	
 	if (indirect)
 	{
-		light += ComputeDiffuseIndirectLighting(data);
-		light += ComputeSpecularIndirectLighting(data, viewDir);
+		light += ComputeIndirectLighting(data, viewDir);
 	}
 
 	light += ComputeLight(data, viewDir, position);
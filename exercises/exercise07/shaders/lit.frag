@@ -15,7 +15,6 @@ uniform float DiffuseReflectance;
 uniform float SpecularReflectance;
 uniform float SpecularExponent;
 
-uniform vec3 CameraPosition;
 
 void main()
 {
@@ -29,6 +28,10 @@ void main()
 
 	vec3 position = WorldPosition;
 	vec3 viewDir = GetDirection(position, CameraPosition);
+#ifdef CLUSTERED
+	vec3 color = ComputeClusteredLighting(position, data, viewDir);
+#else
 	vec3 color = ComputeLighting(position, data, viewDir, true);
+#endif
 	FragColor = vec4(color.rgb, 1);
 }
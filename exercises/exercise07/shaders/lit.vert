@@ -2,18 +2,29 @@
 layout (location = 0) in vec3 VertexPosition;
 layout (location = 1) in vec3 VertexNormal;
 layout (location = 2) in vec2 VertexTexCoord;
+#ifdef INSTANCING
+layout (location = 12) in mat4 InstanceWorldMatrix;
+#endif
 
 //Outputs
 out vec3 WorldPosition;
 out vec3 WorldNormal;
 out vec2 TexCoord;
 
+// Must match the depth pre-pass
+invariant gl_Position;
+
 //Uniforms
+#ifndef INSTANCING
 uniform mat4 WorldMatrix;
-uniform mat4 ViewProjMatrix;
+#endif
 
 void main()
 {
+#ifdef INSTANCING
+	mat4 WorldMatrix = InstanceWorldMatrix;
+#endif
+
 	// vertex position in world space (for lighting computation)
 	WorldPosition = (WorldMatrix * vec4(VertexPosition, 1.0)).xyz;
 
@@ -24,5 +35,6 @@ void main()
 	TexCoord = VertexTexCoord;
 
 	// final vertex position (for opengl rendering, not for lighting)
-	gl_Position = ViewProjMatrix * vec4(WorldPosition, 1.0);
+	// Same expression as the depth pre-pass, to get the same depth
+	gl_Position = ViewProjMatrix * (WorldMatrix * vec4(VertexPosition, 1.0));
 }
@@ -19,6 +19,7 @@
 
 #include <ituGL/renderer/SkyboxRenderPass.h>
 #include <ituGL/renderer/ForwardRenderPass.h>
+#include <ituGL/texture/FramebufferObject.h>
 #include <ituGL/scene/RendererSceneVisitor.h>
 #include <ituGL/scene/CubeRendererSceneVisitor.h>
 
@@ -73,6 +74,8 @@ void SceneViewerApplication::Update()
     // Update camera controller
     m_cameraController.Update(GetMainWindow(), GetDeltaTime());
 
+    m_renderer.SetTime(GetCurrentTime());
+
     // Add the scene nodes to the renderer
     RendererSceneVisitor rendererSceneVisitor(m_renderer);
     m_scene.AcceptVisitor(rendererSceneVisitor);
@@ -135,6 +138,7 @@ void SceneViewerApplication::InitializeMaterial()
     // Load and build shader
     std::vector<const char*> vertexShaderPaths;
     vertexShaderPaths.push_back("shaders/version330.glsl");
+    vertexShaderPaths.push_back("shaders/utils.glsl");
     vertexShaderPaths.push_back("shaders/default.vert");
     Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
@@ -158,14 +162,13 @@ void SceneViewerApplication::InitializeMaterial()
 
     // Filter out uniforms that are not material properties
     ShaderUniformCollection::NameSet filteredUniforms;
-    filteredUniforms.insert("CameraPosition");
     filteredUniforms.insert("WorldMatrix");
-    filteredUniforms.insert("ViewProjMatrix");
     filteredUniforms.insert("LightIndirect");
     filteredUniforms.insert("LightColor");
     filteredUniforms.insert("LightPosition");
     filteredUniforms.insert("LightDirection");
     filteredUniforms.insert("LightAttenuation");
+    filteredUniforms.insert("LightArrayEnabled");
 
 
     // Create reference material
@@ -273,6 +276,9 @@ void SceneViewerApplication::RenderGUI()
     // Draw GUI for camera controller
     m_cameraController.DrawGUI(m_imGui);
 
+    // Draw the work issued by the last frame
+    m_renderer.DrawFrameStatsGUI(m_imGui);
+
     m_imGui.EndFrame();
 }
 
@@ -282,8 +288,7 @@ std::shared_ptr<ShaderProgram> SceneViewerApplication::MakeProgram(Shader& fragm
     prog->Build(vertexShader, fragmentShader);
 
     // cache uniform locations
-    auto camLoc = prog->GetUniformLocation("CameraPosition");
-    auto timeLoc = prog->GetUniformLocation("Time");
+    // camera and time uniforms come from the frame uniforms
     auto outlineLoc = prog->GetUniformLocation("outlineOn");
     auto flickerLoc = prog->GetUniformLocation("flickerOn");
     auto refractionLoc = prog->GetUniformLocation("refractionOn");
@@ -299,20 +304,13 @@ std::shared_ptr<ShaderProgram> SceneViewerApplication::MakeProgram(Shader& fragm
     auto IORLoc = prog->GetUniformLocation("IOR");
 
     auto worldLoc = prog->GetUniformLocation("WorldMatrix");
-    auto vpLoc = prog->GetUniformLocation("ViewProjMatrix");
 
     m_renderer.RegisterShaderProgram(
         prog,
         [=](auto& shader, const glm::mat4& world, const Camera& cam, bool camChanged)
         {
-            if (camChanged) {
-                shader.SetUniform(camLoc, cam.ExtractTranslation());
-                shader.SetUniform(vpLoc, cam.GetViewProjectionMatrix());
-            }
             shader.SetUniform(worldLoc, world);
             // Uniforms for invis shader. Inefficent, but others shaders simply ignore
-            float currentTime = static_cast<float>(glfwGetTime());
-            shader.SetUniform(timeLoc, currentTime);
             shader.SetUniform(outlineLoc, static_cast<int>(m_outline));
             shader.SetUniform(flickerLoc, static_cast<int>(m_flicker));
             shader.SetUniform(refractionLoc, static_cast<int>(m_refract));
@@ -497,8 +495,8 @@ std::shared_ptr<TextureCubemapObject> SceneViewerApplication::GenerateSceneCubem
         m_renderer.Render();
     };
     
-    // Return to default buffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // Return to default buffer, which is not the window framebuffer when running headless
+    FramebufferObject::Unbind();
 
     cubemap->Bind();
     cubemap->GenerateMipmap();
@@ -26,6 +26,10 @@ protected:
     void Render() override;
     void Cleanup() override;
 
+    // Access for applications that extend this one, like the benchmark scenes
+    Renderer& GetRenderer() { return m_renderer; }
+    CameraController& GetCameraController() { return m_cameraController; }
+
 private:
     void InitializeCamera();
     void InitializeLights();
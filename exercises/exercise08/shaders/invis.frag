@@ -15,9 +15,6 @@ uniform sampler2D NormalTexture;
 uniform sampler2D SpecularTexture;
 uniform sampler2D NoiseTexture;
 
-uniform vec3 CameraPosition;
-uniform float Time;
-
 uniform bool outlineOn;
 uniform bool flickerOn;
 uniform bool refractionOn;
@@ -1,4 +1,17 @@
 
+// Per-frame constants, uploaded once per frame by the renderer and shared by all the shaders
+layout(std140) uniform FrameUniforms
+{
+	mat4 ViewMatrix;
+	mat4 ProjMatrix;
+	mat4 ViewProjMatrix;
+	mat4 InvViewMatrix;
+	mat4 InvProjMatrix;
+	mat4 InvViewProjMatrix;
+	vec3 CameraPosition;
+	float Time;
+};
+
 // Returns camera position, extracted from view matrix
 vec3 GetCameraPosition(mat4 viewMatrix)
 {
@@ -16,19 +16,27 @@
 #include <ituGL/geometry/Model.h>
 #include <ituGL/scene/SceneModel.h>
 
+#include <ituGL/renderer/ShadowMapRenderPass.h>
+#include <ituGL/renderer/DepthPrePassRenderPass.h>
 #include <ituGL/renderer/SkyboxRenderPass.h>
 #include <ituGL/renderer/GBufferRenderPass.h>
 #include <ituGL/renderer/DeferredRenderPass.h>
 #include <ituGL/renderer/PostFXRenderPass.h>
+#include <ituGL/renderer/BloomRenderPass.h>
+#include <ituGL/renderer/PostFXComposer.h>
+#include <ituGL/renderer/RenderGraph.h>
 #include <ituGL/scene/RendererSceneVisitor.h>
 
 #include <ituGL/scene/ImGuiSceneVisitor.h>
+#include <ituGL/utils/Profiler.h>
 #include <imgui.h>
 
 PostFXSceneViewerApplication::PostFXSceneViewerApplication()
     : Application(1024, 1024, "Post FX Scene Viewer demo")
     , m_renderer(GetDevice())
-    , m_sceneFramebuffer(std::make_shared<FramebufferObject>())
+    , m_shadowMapRenderPass(nullptr)
+    , m_mipChainBloom(true)
+    , m_bloomRenderPass(nullptr)
     , m_exposure(1.0f)
     , m_contrast(1.0f)
     , m_hueShift(0.0f)
@@ -112,6 +120,9 @@ void PostFXSceneViewerApplication::InitializeLights()
     directionalLight->SetIntensity(3.0f);
     m_scene.AddSceneNode(std::make_shared<SceneLight>("directional light", directionalLight));
 
+    // This light casts shadows
+    m_shadowLight = directionalLight;
+
     // Create a point light and add it to the scene
     //std::shared_ptr<PointLight> pointLight = std::make_shared<PointLight>();
     //pointLight->SetPosition(glm::vec3(0, 0, 0));
@@ -126,6 +137,7 @@ void PostFXSceneViewerApplication::InitializeMaterials()
         // Load and build shader
         std::vector<const char*> vertexShaderPaths;
         vertexShaderPaths.push_back("shaders/version330.glsl");
+        vertexShaderPaths.push_back("shaders/utils.glsl");
         vertexShaderPaths.push_back("shaders/default.vert");
         Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
@@ -139,23 +151,21 @@ void PostFXSceneViewerApplication::InitializeMaterials()
         shaderProgramPtr->Build(vertexShader, fragmentShader);
 
         // Get transform related uniform locations
-        ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
-        ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+        // Camera matrices come from the frame uniforms
+        ShaderProgram::Location worldMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldMatrix");
 
         // Register shader with renderer
         m_renderer.RegisterShaderProgram(shaderProgramPtr,
             [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
             {
-                shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
-                shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+                shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
             },
             nullptr
         );
 
         // Filter out uniforms that are not material properties
         ShaderUniformCollection::NameSet filteredUniforms;
-        filteredUniforms.insert("WorldViewMatrix");
-        filteredUniforms.insert("WorldViewProjMatrix");
+        filteredUniforms.insert("WorldMatrix");
 
         // Create material
         m_defaultMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
@@ -173,6 +183,7 @@ void PostFXSceneViewerApplication::InitializeMaterials()
         fragmentShaderPaths.push_back("shaders/version330.glsl");
         fragmentShaderPaths.push_back("shaders/utils.glsl");
         fragmentShaderPaths.push_back("shaders/lambert-ggx.glsl");
+        fragmentShaderPaths.push_back("shaders/shadows.glsl");
         fragmentShaderPaths.push_back("shaders/lighting.glsl");
         fragmentShaderPaths.push_back("shaders/renderer/deferred.frag");
         Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
@@ -182,34 +193,30 @@ void PostFXSceneViewerApplication::InitializeMaterials()
 
         // Filter out uniforms that are not material properties
         ShaderUniformCollection::NameSet filteredUniforms;
-        filteredUniforms.insert("InvViewMatrix");
-        filteredUniforms.insert("InvProjMatrix");
         filteredUniforms.insert("WorldViewProjMatrix");
         filteredUniforms.insert("LightIndirect");
         filteredUniforms.insert("LightColor");
         filteredUniforms.insert("LightPosition");
         filteredUniforms.insert("LightDirection");
         filteredUniforms.insert("LightAttenuation");
+        filteredUniforms.insert("LightArrayEnabled");
 
         // Get transform related uniform locations
-        ShaderProgram::Location invViewMatrixLocation = shaderProgramPtr->GetUniformLocation("InvViewMatrix");
-        ShaderProgram::Location invProjMatrixLocation = shaderProgramPtr->GetUniformLocation("InvProjMatrix");
+        // Inverse camera matrices come from the frame uniforms
         ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
 
         // Register shader with renderer
         m_renderer.RegisterShaderProgram(shaderProgramPtr,
             [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
             {
-                if (cameraChanged)
-                {
-                    shaderProgram.SetUniform(invViewMatrixLocation, glm::inverse(camera.GetViewMatrix()));
-                    shaderProgram.SetUniform(invProjMatrixLocation, glm::inverse(camera.GetProjectionMatrix()));
-                }
                 shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
             },
             m_renderer.GetDefaultUpdateLightsFunction(*shaderProgramPtr)
         );
 
+        // The shadow matrices come from the uniform buffer of the shadow map pass
+        ShadowMapRenderPass::SetupShaderProgram(*shaderProgramPtr);
+
         // Create material
         m_deferredMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
     }
@@ -237,6 +244,9 @@ void PostFXSceneViewerApplication::InitializeModels()
     // Flip vertically textures loaded by the model loader
     loader.GetTexture2DLoader().SetFlipVertical(true);
 
+    // Coarser versions of the meshes, drawn when the model is small on the screen
+    loader.SetLodCount(4);
+
     // Link vertex properties to attributes
     loader.SetMaterialAttribute(VertexAttribute::Semantic::Position, "VertexPosition");
     loader.SetMaterialAttribute(VertexAttribute::Semantic::Normal, "VertexNormal");
@@ -255,112 +265,137 @@ void PostFXSceneViewerApplication::InitializeModels()
     m_scene.AddSceneNode(std::make_shared<SceneModel>("cannon", cannonModel));
 }
 
-void PostFXSceneViewerApplication::InitializeFramebuffers()
-{
-    int width, height;
-    GetMainWindow().GetDimensions(width, height);
-
-    // Scene Texture
-    m_sceneTexture = std::make_shared<Texture2DObject>();
-    m_sceneTexture->Bind();
-    m_sceneTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormat::InternalFormatRGBA16F);
-    m_sceneTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
-    m_sceneTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
-    Texture2DObject::Unbind();
-
-    // Scene framebuffer
-    m_sceneFramebuffer->Bind();
-    m_sceneFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Depth, *m_depthTexture);
-    m_sceneFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_sceneTexture);
-    m_sceneFramebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 1>({ FramebufferObject::Attachment::Color0 }));
-    FramebufferObject::Unbind();
-
-    // Add temp textures and frame buffers
-    for (int i = 0; i < m_tempFramebuffers.size(); ++i)
-    {
-        m_tempTextures[i] = std::make_shared<Texture2DObject>();
-        m_tempTextures[i]->Bind();
-        m_tempTextures[i]->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormat::InternalFormatRGBA16F);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
-        m_tempTextures[i]->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
-
-        m_tempFramebuffers[i] = std::make_shared<FramebufferObject>();
-        m_tempFramebuffers[i]->Bind();
-        m_tempFramebuffers[i]->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_tempTextures[i]);
-        m_tempFramebuffers[i]->SetDrawBuffers(std::array<FramebufferObject::Attachment, 1>({ FramebufferObject::Attachment::Color0 }));
-    }
-    Texture2DObject::Unbind();
-    FramebufferObject::Unbind();
-}
-
 void PostFXSceneViewerApplication::InitializeRenderer()
 {
     int width, height;
     GetMainWindow().GetDimensions(width, height);
 
-    // Set up deferred passes
-    {
-        std::unique_ptr<GBufferRenderPass> gbufferRenderPass(std::make_unique<GBufferRenderPass>(width, height));
+    // Shadows of the directional light, read by the deferred pass
+    std::unique_ptr<ShadowMapRenderPass> shadowMapRenderPass(std::make_unique<ShadowMapRenderPass>(m_shadowLight));
+    m_deferredMaterial->SetUniformValue("ShadowMapTexture", shadowMapRenderPass->GetShadowMapTexture());
+    m_shadowMapRenderPass = shadowMapRenderPass.get();
+    m_renderer.AddRenderPass(std::move(shadowMapRenderPass));
 
-        // Set the g-buffer textures as properties of the deferred material
-        m_deferredMaterial->SetUniformValue("DepthTexture", gbufferRenderPass->GetDepthTexture());
-        m_deferredMaterial->SetUniformValue("AlbedoTexture", gbufferRenderPass->GetAlbedoTexture());
-        m_deferredMaterial->SetUniformValue("NormalTexture", gbufferRenderPass->GetNormalTexture());
-        m_deferredMaterial->SetUniformValue("OthersTexture", gbufferRenderPass->GetOthersTexture());
+    // The g-buffer pass keeps its own framebuffer, and runs before the passes of the graph
+    std::unique_ptr<GBufferRenderPass> gbufferRenderPass(std::make_unique<GBufferRenderPass>(width, height));
 
-        // Get the depth texture from the gbuffer pass - This could be reworked
-        m_depthTexture = gbufferRenderPass->GetDepthTexture();
+    // Set the g-buffer textures as properties of the deferred material
+    m_deferredMaterial->SetUniformValue("DepthTexture", gbufferRenderPass->GetDepthTexture());
+    m_deferredMaterial->SetUniformValue("AlbedoTexture", gbufferRenderPass->GetAlbedoTexture());
+    m_deferredMaterial->SetUniformValue("NormalTexture", gbufferRenderPass->GetNormalTexture());
+    m_deferredMaterial->SetUniformValue("OthersTexture", gbufferRenderPass->GetOthersTexture());
 
-        // Add the render passes
-        m_renderer.AddRenderPass(std::move(gbufferRenderPass));
-        m_renderer.AddRenderPass(std::make_unique<DeferredRenderPass>(m_deferredMaterial, m_sceneFramebuffer));
-    }
+    // Optional depth pre-pass, into the depth of the g-buffer. It clears the depth, as the g-buffer pass doesn't when it is enabled
+    m_renderer.AddRenderPass(std::make_unique<DepthPrePassRenderPass>(0, gbufferRenderPass->GetTargetFramebuffer(), true));
 
-    // Initialize the framebuffers and the textures they use
-    InitializeFramebuffers();
+    std::shared_ptr<Texture2DObject> depthTexture = gbufferRenderPass->GetDepthTexture();
+    m_renderer.AddRenderPass(std::move(gbufferRenderPass));
 
-    // Skybox pass
-    m_renderer.AddRenderPass(std::make_unique<SkyboxRenderPass>(m_skyboxTexture));
+    // The rest of the frame is described by the textures each pass reads and writes
+    // The graph allocates the textures and framebuffers, and reuses the textures that are no longer needed
+    m_renderGraph = std::make_unique<RenderGraph>(width, height);
 
-    // Create a copy pass from m_sceneTexture to the first temporary texture
-    std::shared_ptr<Material> copyMaterial = CreatePostFXMaterial("shaders/postfx/copy.frag", m_sceneTexture);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(copyMaterial, m_tempFramebuffers[0]));
+    RenderGraph::TextureDesc sceneDesc = { width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
+    // Bloom is blurred at half resolution, the blur hides the difference
+    RenderGraph::TextureDesc bloomDesc = { width / 2, height / 2, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
 
-    // Replace the copy pass with a new bloom pass
-    m_bloomMaterial = CreatePostFXMaterial("shaders/postfx/bloom.frag", m_sceneTexture);
-    m_bloomMaterial->SetUniformValue("Range", glm::vec2(2.0f, 3.0f));
-    m_bloomMaterial->SetUniformValue("Intensity", 1.0f);
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_bloomMaterial, m_tempFramebuffers[0]));
+    RenderGraph::ResourceId depth = m_renderGraph->ImportTexture("Depth", depthTexture, { width, height, TextureObject::FormatDepth, TextureObject::InternalFormatDepth });
+    RenderGraph::ResourceId scene = m_renderGraph->CreateTexture("Scene", sceneDesc);
 
-    // Add blur passes
-    std::shared_ptr<Material> blurHorizontalMaterial = CreatePostFXMaterial("shaders/postfx/blur.frag", m_tempTextures[0]);
-    blurHorizontalMaterial->SetUniformValue("Scale", glm::vec2(1.0f / width, 0.0f));
-    std::shared_ptr<Material> blurVerticalMaterial = CreatePostFXMaterial("shaders/postfx/blur.frag", m_tempTextures[1]);
-    blurVerticalMaterial->SetUniformValue("Scale", glm::vec2(0.0f, 1.0f / height));
-    for (int i = 0; i < m_blurIterations; ++i)
+    // Deferred pass. The scene framebuffer uses the g-buffer depth, so the light volumes can be depth tested
+    m_renderGraph->AddPass("Deferred", { depth }, { scene, depth },
+        [this](const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+        {
+            std::unique_ptr<DeferredRenderPass> deferredRenderPass(std::make_unique<DeferredRenderPass>(m_deferredMaterial, targetFramebuffer));
+            deferredRenderPass->SetLightVolumeDepthTest(true);
+            return deferredRenderPass;
+        });
+
+    // Skybox pass, drawn where the depth was not written
+    m_renderGraph->AddPass("Skybox", { depth }, { scene, depth },
+        [this](const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+        {
+            return std::make_unique<SkyboxRenderPass>(m_skyboxTexture, targetFramebuffer);
+        });
+
+    RenderGraph::ResourceId bloom = m_renderGraph->CreateTexture("Bloom", bloomDesc);
+    RenderGraph::ResourceId blurred = bloom;
+    if (m_mipChainBloom)
     {
-        m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(blurHorizontalMaterial, m_tempFramebuffers[1]));
-        m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(blurVerticalMaterial, m_tempFramebuffers[0]));
+        // Bloom pass, keeping the bright pixels of the scene and blurring them down a mip chain and back
+        m_renderGraph->AddPass("Bloom", { scene }, { bloom },
+            [this, scene, bloom, bloomDesc](const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+            {
+                std::unique_ptr<BloomRenderPass> bloomRenderPass(std::make_unique<BloomRenderPass>(graph.GetTexture(scene), graph.GetTexture(bloom), targetFramebuffer, bloomDesc.width, bloomDesc.height));
+                m_bloomRenderPass = bloomRenderPass.get();
+                return bloomRenderPass;
+            });
     }
+    else
+    {
+        // Bloom pass, keeping the bright pixels of the scene
+        m_bloomMaterial = CreatePostFXMaterial("shaders/postfx/bloom.frag");
+        m_bloomMaterial->SetUniformValue("Range", glm::vec2(2.0f, 3.0f));
+        m_bloomMaterial->SetUniformValue("Intensity", 1.0f);
 
-    // Final pass
-    m_composeMaterial = CreatePostFXMaterial("shaders/postfx/compose.frag", m_sceneTexture);
+        m_renderGraph->AddPass("Bloom", { scene }, { bloom },
+            [this, scene](const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+            {
+                m_bloomMaterial->SetUniformValue("SourceTexture", graph.GetTexture(scene));
+                return std::make_unique<PostFXRenderPass>(m_bloomMaterial, targetFramebuffer);
+            });
+
+        // Add blur passes. Each pass writes a new resource, the graph makes them alternate between two textures
+        std::shared_ptr<Material> blurHorizontalMaterial = CreatePostFXMaterial("shaders/postfx/blur.frag");
+        blurHorizontalMaterial->SetUniformValue("Scale", glm::vec2(1.0f / bloomDesc.width, 0.0f));
+        std::shared_ptr<Material> blurVerticalMaterial = CreatePostFXMaterial("shaders/postfx/blur.frag");
+        blurVerticalMaterial->SetUniformValue("Scale", glm::vec2(0.0f, 1.0f / bloomDesc.height));
+
+        // Each pass gets a copy of the material, because they read different textures
+        auto createBlurPass = [](std::shared_ptr<const Material> blurMaterial, RenderGraph::ResourceId source)
+        {
+            return [blurMaterial, source](const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+            {
+                std::shared_ptr<Material> material = std::make_shared<Material>(*blurMaterial);
+                material->SetUniformValue("SourceTexture", graph.GetTexture(source));
+                return std::make_unique<PostFXRenderPass>(material, targetFramebuffer);
+            };
+        };
 
-    // Set exposure uniform default value
-    m_composeMaterial->SetUniformValue("Exposure", m_exposure);
+        for (int i = 0; i < m_blurIterations; ++i)
+        {
+            RenderGraph::ResourceId blurredHorizontal = m_renderGraph->CreateTexture("BlurHorizontal", bloomDesc);
+            m_renderGraph->AddPass("BlurHorizontal", { blurred }, { blurredHorizontal }, createBlurPass(blurHorizontalMaterial, blurred));
 
-    // Set uniform default values
-    m_composeMaterial->SetUniformValue("Contrast", m_contrast);
-    m_composeMaterial->SetUniformValue("HueShift", m_hueShift);
-    m_composeMaterial->SetUniformValue("Saturation", m_saturation);
-    m_composeMaterial->SetUniformValue("ColorFilter", m_colorFilter);
+            blurred = m_renderGraph->CreateTexture("BlurVertical", bloomDesc);
+            m_renderGraph->AddPass("BlurVertical", { blurredHorizontal }, { blurred }, createBlurPass(blurVerticalMaterial, blurredHorizontal));
+        }
+    }
 
-    // Set the bloom texture uniform
-    m_composeMaterial->SetUniformValue("BloomTexture", m_tempTextures[0]);
+    // Final pass. The stages only read their own pixel, so they are fused into one shader and the scene is read once
+    PostFXComposer composer;
+    composer.AddSharedSourceFile("shaders/utils.glsl");
+    composer.AddStageFile("Bloom", "shaders/postfx/stages/bloom.glsl");
+    composer.AddStageFile("ToneMapping", "shaders/postfx/stages/tonemapping.glsl");
+    composer.AddStageFile("ColorGrading", "shaders/postfx/stages/colorgrading.glsl");
+    m_composeMaterial = CreatePostFXMaterial(composer);
+
+    // Set uniform default values. Their names have the stage as prefix
+    m_composeMaterial->SetUniformValue("ToneMapping_Exposure", m_exposure);
+    m_composeMaterial->SetUniformValue("ColorGrading_Contrast", m_contrast);
+    m_composeMaterial->SetUniformValue("ColorGrading_HueShift", m_hueShift);
+    m_composeMaterial->SetUniformValue("ColorGrading_Saturation", m_saturation);
+    m_composeMaterial->SetUniformValue("ColorGrading_ColorFilter", m_colorFilter);
+
+    m_renderGraph->AddPass("Compose", { scene, blurred }, { m_renderGraph->GetBackbuffer() },
+        [this, scene, blurred](const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+        {
+            m_composeMaterial->SetUniformValue("SourceTexture", graph.GetTexture(scene));
+            m_composeMaterial->SetUniformValue("Bloom_Texture", graph.GetTexture(blurred));
+            return std::make_unique<PostFXRenderPass>(m_composeMaterial, targetFramebuffer);
+        });
 
-    m_renderer.AddRenderPass(std::make_unique<PostFXRenderPass>(m_composeMaterial, m_renderer.GetDefaultFramebuffer()));
+    m_renderGraph->Compile(m_renderer);
 }
 
 std::shared_ptr<Material> PostFXSceneViewerApplication::CreatePostFXMaterial(const char* fragmentShaderPath, std::shared_ptr<Texture2DObject> sourceTexture)
@@ -387,6 +422,20 @@ std::shared_ptr<Material> PostFXSceneViewerApplication::CreatePostFXMaterial(con
     return material;
 }
 
+std::shared_ptr<Material> PostFXSceneViewerApplication::CreatePostFXMaterial(const PostFXComposer& composer)
+{
+    std::vector<const char*> vertexShaderPaths;
+    vertexShaderPaths.push_back("shaders/version330.glsl");
+    vertexShaderPaths.push_back("shaders/renderer/fullscreen.vert");
+    Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
+
+    // Create material with the generated fragment shader
+    std::shared_ptr<Material> material = std::make_shared<Material>(composer.Build(vertexShader));
+    material->SetUniformValue("SourceTexture", std::shared_ptr<Texture2DObject>());
+
+    return material;
+}
+
 Renderer::UpdateTransformsFunction PostFXSceneViewerApplication::GetFullscreenTransformFunction(std::shared_ptr<ShaderProgram> shaderProgramPtr) const
 {
     // Get transform related uniform locations
@@ -417,44 +466,104 @@ void PostFXSceneViewerApplication::RenderGUI()
     // Draw GUI for camera controller
     m_cameraController.DrawGUI(m_imGui);
 
+    // Draw GUI for the CPU zones of the last frame
+    Profiler::GetInstance().DrawGUI(m_imGui);
+
+    // Draw GUI for the GPU time of each render pass
+    m_renderer.GetPassTimers().DrawGUI(m_imGui);
+
+    if (auto window = m_imGui.UseWindow("Renderer"))
+    {
+        bool depthPrePass = m_renderer.IsDepthPrePassEnabled(0);
+        if (ImGui::Checkbox("Depth pre-pass", &depthPrePass))
+        {
+            m_renderer.SetDepthPrePassEnabled(0, depthPrePass);
+        }
+        bool lodSelection = m_renderer.IsLodSelectionEnabled();
+        if (ImGui::Checkbox("Levels of detail", &lodSelection))
+        {
+            m_renderer.SetLodSelectionEnabled(lodSelection);
+        }
+
+        ImGui::Separator();
+
+        bool shadows = m_shadowMapRenderPass->IsEnabled();
+        if (ImGui::Checkbox("Shadows", &shadows))
+        {
+            m_shadowMapRenderPass->SetEnabled(shadows);
+        }
+        bool staticCache = m_shadowMapRenderPass->IsStaticCacheEnabled();
+        if (ImGui::Checkbox("Cache static shadows", &staticCache))
+        {
+            m_shadowMapRenderPass->SetStaticCacheEnabled(staticCache);
+        }
+        const ShadowMapRenderPass::Stats& shadowStats = m_shadowMapRenderPass->GetStats();
+        ImGui::Text("Shadow cascades updated: %u (%u static)", shadowStats.updatedCascades, shadowStats.staticCascades);
+        ImGui::Text("Shadow casters: %u static, %u dynamic", shadowStats.staticDrawcalls, shadowStats.dynamicDrawcalls);
+    }
+
+    // Draw the work issued by the last frame
+    m_renderer.DrawFrameStatsGUI(m_imGui);
+
     if (auto window = m_imGui.UseWindow("Post FX"))
     {
         if (m_composeMaterial)
         {
             if (ImGui::DragFloat("Exposure", &m_exposure, 0.01f, 0.01f, 5.0f))
             {
-                m_composeMaterial->SetUniformValue("Exposure", m_exposure);
+                m_composeMaterial->SetUniformValue("ToneMapping_Exposure", m_exposure);
             }
 
             ImGui::Separator();
 
             if (ImGui::SliderFloat("Contrast", &m_contrast, 0.5f, 1.5f))
             {
-                m_composeMaterial->SetUniformValue("Contrast", m_contrast);
+                m_composeMaterial->SetUniformValue("ColorGrading_Contrast", m_contrast);
             }
             if (ImGui::SliderFloat("Hue Shift", &m_hueShift, -0.5f, 0.5f))
             {
-                m_composeMaterial->SetUniformValue("HueShift", m_hueShift);
+                m_composeMaterial->SetUniformValue("ColorGrading_HueShift", m_hueShift);
             }
             if (ImGui::SliderFloat("Saturation", &m_saturation, 0.0f, 2.0f))
             {
-                m_composeMaterial->SetUniformValue("Saturation", m_saturation);
+                m_composeMaterial->SetUniformValue("ColorGrading_Saturation", m_saturation);
             }
             if (ImGui::ColorEdit3("Color Filter", &m_colorFilter[0]))
             {
-                m_composeMaterial->SetUniformValue("ColorFilter", m_colorFilter);
+                m_composeMaterial->SetUniformValue("ColorGrading_ColorFilter", m_colorFilter);
             }
 
             ImGui::Separator();
 
             if (ImGui::DragFloat2("Bloom Range", &m_bloomRange[0], 0.1f, 0.1f, 10.0f))
             {
-                m_bloomMaterial->SetUniformValue("Range", m_bloomRange);
+                if (m_bloomRenderPass)
+                {
+                    m_bloomRenderPass->SetRange(m_bloomRange);
+                }
+                else
+                {
+                    m_bloomMaterial->SetUniformValue("Range", m_bloomRange);
+                }
             }
             if (ImGui::DragFloat("Bloom Intensity", &m_bloomIntensity, 0.1f, 0.0f, 5.0f))
             {
-                m_bloomMaterial->SetUniformValue("Intensity", m_bloomIntensity);
+                if (m_bloomRenderPass)
+                {
+                    m_bloomRenderPass->SetIntensity(m_bloomIntensity);
+                }
+                else
+                {
+                    m_bloomMaterial->SetUniformValue("Intensity", m_bloomIntensity);
+                }
             }
+
+            ImGui::Separator();
+
+            // Memory saved by sharing the textures of the render graph
+            ImGui::Text("Render graph: %u passes, %u culled", m_renderGraph->GetPassCount(), m_renderGraph->GetCulledPassCount());
+            ImGui::Text("Textures: %u for %u resources", m_renderGraph->GetAllocatedTextureCount(), m_renderGraph->GetTransientTextureCount());
+            ImGui::Text("Memory: %.1f MB (%.1f MB without sharing)", m_renderGraph->GetAllocatedTextureBytes() / (1024.0f * 1024.0f), m_renderGraph->GetTransientTextureBytes() / (1024.0f * 1024.0f));
         }
     }
 
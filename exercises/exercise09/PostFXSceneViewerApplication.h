@@ -3,15 +3,18 @@
 #include <ituGL/application/Application.h>
 
 #include <ituGL/scene/Scene.h>
-#include <ituGL/texture/FramebufferObject.h>
 #include <ituGL/renderer/Renderer.h>
+#include <ituGL/renderer/RenderGraph.h>
 #include <ituGL/camera/CameraController.h>
 #include <ituGL/utils/DearImGui.h>
-#include <array>
 
 class Texture2DObject;
 class TextureCubemapObject;
 class Material;
+class DirectionalLight;
+class ShadowMapRenderPass;
+class BloomRenderPass;
+class PostFXComposer;
 
 class PostFXSceneViewerApplication : public Application
 {
@@ -24,15 +27,20 @@ protected:
     void Render() override;
     void Cleanup() override;
 
+    // Access for applications that extend this one, like the benchmark scenes
+    Renderer& GetRenderer() { return m_renderer; }
+    CameraController& GetCameraController() { return m_cameraController; }
+    void SetMipChainBloom(bool enabled) { m_mipChainBloom = enabled; }
+
 private:
     void InitializeCamera();
     void InitializeLights();
     void InitializeMaterials();
     void InitializeModels();
-    void InitializeFramebuffers();
     void InitializeRenderer();
 
     std::shared_ptr<Material> CreatePostFXMaterial(const char* fragmentShaderPath, std::shared_ptr<Texture2DObject> sourceTexture = nullptr);
+    std::shared_ptr<Material> CreatePostFXMaterial(const PostFXComposer& composer);
 
     Renderer::UpdateTransformsFunction GetFullscreenTransformFunction(std::shared_ptr<ShaderProgram> shaderProgramPtr) const;
 
@@ -51,6 +59,10 @@ private:
     // Renderer
     Renderer m_renderer;
 
+    // Light with shadows, and the pass that renders them. The pass is owned by the renderer
+    std::shared_ptr<DirectionalLight> m_shadowLight;
+    ShadowMapRenderPass* m_shadowMapRenderPass;
+
     // Skybox texture
     std::shared_ptr<TextureCubemapObject> m_skyboxTexture;
 
@@ -60,12 +72,12 @@ private:
     std::shared_ptr<Material> m_composeMaterial;
     std::shared_ptr<Material> m_bloomMaterial;
 
-    // Framebuffers
-    std::shared_ptr<FramebufferObject> m_sceneFramebuffer;
-    std::shared_ptr<Texture2DObject> m_depthTexture;
-    std::shared_ptr<Texture2DObject> m_sceneTexture;
-    std::array<std::shared_ptr<FramebufferObject>, 2> m_tempFramebuffers;
-    std::array<std::shared_ptr<Texture2DObject>, 2> m_tempTextures;
+    // Bloom with a mip chain, owned by the renderer. Without it, the bloom material is blurred at one size
+    bool m_mipChainBloom;
+    BloomRenderPass* m_bloomRenderPass;
+
+    // Passes after the g-buffer, with the textures and framebuffers they use
+    std::unique_ptr<RenderGraph> m_renderGraph;
 
     // Configuration values
     float m_exposure;
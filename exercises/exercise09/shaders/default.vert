@@ -11,12 +11,16 @@ out vec3 ViewTangent;
 out vec3 ViewBitangent;
 out vec2 TexCoord;
 
+// Must match the depth pre-pass
+invariant gl_Position;
+
 //Uniforms
-uniform mat4 WorldViewMatrix;
-uniform mat4 WorldViewProjMatrix;
+uniform mat4 WorldMatrix;
 
 void main()
 {
+	mat4 WorldViewMatrix = ViewMatrix * WorldMatrix;
+
 	// normal in view space (for lighting computation)
 	ViewNormal = (WorldViewMatrix * vec4(VertexNormal, 0.0)).xyz;
 
@@ -30,5 +34,6 @@ void main()
 	TexCoord = VertexTexCoord;
 
 	// final vertex position (for opengl rendering, not for lighting)
-	gl_Position = WorldViewProjMatrix * vec4(VertexPosition, 1.0);
+	// Same expression as the depth pre-pass, to get the same depth
+	gl_Position = ViewProjMatrix * (WorldMatrix * vec4(VertexPosition, 1.0));
 }
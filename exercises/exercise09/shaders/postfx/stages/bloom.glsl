@@ -0,0 +1,8 @@
+//Uniforms
+uniform sampler2D @Texture;
+
+// Add the blurred bright pixels, before the exposure
+vec4 @Apply(vec4 color, vec2 texCoord)
+{
+	return vec4(color.rgb + texture(@Texture, texCoord).rgb, color.a);
+}
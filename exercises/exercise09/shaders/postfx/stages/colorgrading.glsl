@@ -0,0 +1,40 @@
+//Uniforms
+uniform float @Contrast;
+uniform float @HueShift;
+uniform float @Saturation;
+uniform vec3 @ColorFilter;
+
+vec3 @AdjustContrast(vec3 color)
+{
+	color = (color - vec3(0.5f)) * @Contrast + vec3(0.5f);
+	return clamp(color, 0, 1);
+}
+
+vec3 @AdjustHue(vec3 color)
+{
+	vec3 hsvColor = RGBToHSV(color);
+	hsvColor.x = fract(hsvColor.x + @HueShift + 1.0f);
+	return HSVToRGB(hsvColor);
+}
+
+vec3 @AdjustSaturation(vec3 color)
+{
+	vec3 luminance = vec3(GetLuminance(color));
+	color = (color - luminance) * @Saturation + luminance;
+	return clamp(color, 0, 1);
+}
+
+vec3 @ApplyColorFilter(vec3 color)
+{
+	return color * @ColorFilter;
+}
+
+// Color grading, after the exposure
+vec4 @Apply(vec4 color, vec2 texCoord)
+{
+	vec3 result = @AdjustContrast(color.rgb);
+	result = @AdjustHue(result);
+	result = @AdjustSaturation(result);
+	result = @ApplyColorFilter(result);
+	return vec4(result, color.a);
+}
@@ -0,0 +1,8 @@
+//Uniforms
+uniform float @Exposure;
+
+// Map the HDR color to the displayable range
+vec4 @Apply(vec4 color, vec2 texCoord)
+{
+	return vec4(vec3(1.0f) - exp(-color.rgb * @Exposure), 1.0f);
+}
@@ -0,0 +1,50 @@
+
+// Cascaded shadows of one directional light. Must match ShadowMapRenderPass::ShadowUniforms
+// Must be included before lighting.glsl
+#define MAX_SHADOW_CASCADES 4
+layout(std140) uniform ShadowUniforms
+{
+	mat4 ShadowMatrices[MAX_SHADOW_CASCADES];
+	vec4 ShadowSplits;
+	vec4 ShadowTexelSizes;
+	vec4 ShadowLightDirection;
+};
+uniform sampler2DShadow ShadowMapTexture;
+
+// Fraction of the light that reaches the position. Only the light with the shadow map has shadows
+float ComputeShadow(vec3 lightDirection, vec3 position, vec3 normal)
+{
+	int cascadeCount = int(ShadowLightDirection.w);
+	if (cascadeCount == 0 || dot(lightDirection, ShadowLightDirection.xyz) < 0.999)
+	{
+		return 1.0;
+	}
+
+	// First cascade that reaches the view depth. Farther positions have no shadows
+	float viewDepth = -(ViewMatrix * vec4(position, 1)).z;
+	int cascade = 0;
+	while (cascade < cascadeCount && viewDepth > ShadowSplits[cascade])
+	{
+		++cascade;
+	}
+	if (cascade == cascadeCount)
+	{
+		return 1.0;
+	}
+
+	// Moving the position along the normal, by the size of a texel, avoids self shadowing on the slopes
+	vec3 offsetPosition = position + normal * ShadowTexelSizes[cascade] * 1.5;
+	vec3 shadowCoords = (ShadowMatrices[cascade] * vec4(offsetPosition, 1)).xyz;
+
+	// 3x3 lookups, each one already blends the comparison of 2x2 texels
+	vec2 texelSize = 1.0 / vec2(textureSize(ShadowMapTexture, 0));
+	float shadow = 0.0;
+	for (int y = -1; y <= 1; ++y)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			shadow += texture(ShadowMapTexture, vec3(shadowCoords.xy + vec2(x, y) * texelSize, shadowCoords.z));
+		}
+	}
+	return shadow / 9.0;
+}
@@ -21,6 +21,13 @@ protected:
     void Render() override;
     void Cleanup() override;
 
+    // Access for applications that extend this one, like the benchmark scenes
+    Renderer& GetRenderer() { return m_renderer; }
+    CameraController& GetCameraController() { return m_cameraController; }
+
+    // Restart the accumulation of frames, after the camera or the scene changed
+    void InvalidateScene();
+
 private:
     void InitializeCamera();
     void InitializeMaterial();
@@ -30,8 +37,6 @@ private:
     std::shared_ptr<Material> CreateCopyMaterial();
     std::shared_ptr<Material> CreateRaytracingMaterial(const char* fragmentShaderPath);
 
-    void InvalidateScene();
-
     void RenderGUI();
 
 private:
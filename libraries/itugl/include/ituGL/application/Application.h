@@ -2,13 +2,45 @@
 
 #include <ituGL/core/DeviceGL.h>
 #include <ituGL/application/Window.h>
+#include <memory>
 #include <string>
 
+class FramebufferObject;
+class Texture2DObject;
+
 class Application
 {
+public:
+    // Settings to run without a visible window, for automated jobs on machines without a display
+    // The window is hidden and the frames are rendered into a framebuffer that replaces the default one
+    struct HeadlessSettings
+    {
+        bool enabled = false;
+        // Size of the offscreen framebuffer, and of the hidden window. 0 keeps the size requested by the application
+        int width = 0;
+        int height = 0;
+        // Frames rendered before closing. 0 runs until Close is called
+        unsigned int frameCount = 0;
+        // Time of each frame in seconds, so that the runs are reproducible. 0 uses the real time
+        float fixedDeltaTime = 0.0f;
+        // Image of the last frame, written as a binary PPM. Empty to skip it
+        std::string outputPath;
+
+        // Headless is enabled if ITUGL_HEADLESS_FRAMES is set. The other variables are
+        // ITUGL_HEADLESS_SIZE (as WIDTHxHEIGHT), ITUGL_HEADLESS_DELTA_TIME and ITUGL_HEADLESS_OUTPUT
+        static HeadlessSettings FromEnvironment();
+    };
+
+    // Settings used by the applications that don't pass their own. They are read from the environment, unless replaced here
+    // Replacing them lets a program run other applications headless, like a benchmark
+    static HeadlessSettings GetDefaultHeadlessSettings();
+    static void SetDefaultHeadlessSettings(const HeadlessSettings& headlessSettings);
+
 public:
     // Construct the application specifying the dimensions of the window and its title
+    // Uses the default headless settings
     Application(int width, int height, const char* title);
+    Application(int width, int height, const char* title, const HeadlessSettings& headlessSettings);
 
     // Destroy de application
     virtual ~Application();
@@ -18,6 +50,11 @@ public:
 
     inline const Window& GetMainWindow() const { return m_mainWindow; }
 
+    inline bool IsHeadless() const { return m_headlessSettings.enabled; }
+
+    // Number of frames completed since the main loop started
+    inline unsigned int GetFrameCount() const { return m_frameCount; }
+
 protected:
     // (C++) 1
     // Get the OpenGL device
@@ -61,6 +98,11 @@ private:
     // Set the new current time and compute the delta since the last time
     void UpdateTime(float newCurrentTime);
 
+    // Create the framebuffer that replaces the default one when running headless
+    void InitializeOffscreenFramebuffer();
+    // Write the color of the offscreen framebuffer as a binary PPM
+    bool SaveOffscreenImage(const char* path) const;
+
 private:
     // OpenGL device
     DeviceGL m_device;
@@ -68,6 +110,14 @@ private:
     // Main window
     Window m_mainWindow;
 
+    HeadlessSettings m_headlessSettings;
+    // Replaces the default framebuffer when running headless. Destroyed before the window, while the context is alive
+    std::shared_ptr<FramebufferObject> m_offscreenFramebuffer;
+    std::shared_ptr<Texture2DObject> m_offscreenColorTexture;
+    std::shared_ptr<Texture2DObject> m_offscreenDepthTexture;
+
+    unsigned int m_frameCount;
+
     // Time in seconds from the start of the application
     float m_currentTime;
     // Time in seconds of the current frame
@@ -77,4 +127,7 @@ private:
     int m_exitCode;
     // Error message to display on exit
     std::string m_errorMessage;
+
+    // Replacement of the settings read from the environment
+    static std::unique_ptr<HeadlessSettings> s_defaultHeadlessSettings;
 };
@@ -6,7 +6,8 @@
 class Window
 {
 public:
-    Window(int width, int height, const char* title);
+    // Hidden windows still have an OpenGL context, to render offscreen
+    Window(int width, int height, const char* title, bool visible = true);
     ~Window();
 
     // (C++) 1
@@ -27,6 +27,10 @@ public:
     bool GetCreateMaterials() const;
     void SetCreateMaterials(bool createMaterials);
 
+    // Levels of detail generated for the triangle submeshes, including the original. Each level has about half the triangles
+    unsigned int GetLodCount() const;
+    void SetLodCount(unsigned int lodCount);
+
     Texture2DLoader& GetTexture2DLoader();
     const Texture2DLoader& GetTexture2DLoader() const;
 
@@ -57,6 +61,11 @@ private:
     static std::vector<GLubyte> CollectElementData(const aiMesh& meshData, Data::Type& elementType,
         std::vector<Drawcall::Primitive>& primitives, std::vector<int>& elementCounts);
 
+    // Simplify the triangle ranges of the element data, and append the elements of each level of detail to it
+    // elementEnds are the byte offsets where each range ends. Returns the drawcalls of the coarser levels of each range
+    std::vector<std::vector<Drawcall>> GenerateLods(const aiMesh& meshData, std::vector<GLubyte>& elementData, Data::Type elementType,
+        std::span<const Drawcall::Primitive> primitives, std::span<const int> elementEnds) const;
+
     // Get the correct vertex data pointer for a specific semantic
     static const void* GetVertexDataPointer(const aiMesh& meshData, VertexAttribute::Semantic semantic, int& stride);
 
@@ -82,6 +91,9 @@ private:
     // Should create new materials for each submesh or use the reference material
     bool m_createMaterials;
 
+    // Levels of detail of each submesh, 1 to keep only the original
+    unsigned int m_lodCount;
+
     // Texture loader to cache already loaded shared textures
     mutable Texture2DLoader m_textureLoader;
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <vector>
+
+class Camera;
+
+// Scripted camera movement, with the position and the target of the camera at some times
+// Keyframes are interpolated with Catmull-Rom splines, so the camera moves smoothly through all of them
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        float time;
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+
+public:
+    // Looping paths go back to the first keyframe after the last one, and repeat
+    CameraPath(bool loop = true);
+
+    // Keyframes must be added in increasing time. Looping paths take as long to return to the first keyframe as
+    // from the first keyframe to the second one
+    void AddKeyframe(float time, const glm::vec3& position, const glm::vec3& target);
+
+    const std::vector<Keyframe>& GetKeyframes() const { return m_keyframes; }
+
+    // Time from the first keyframe to the end of the path, including the return to the first keyframe if looping
+    float GetDuration() const;
+
+    void Evaluate(float time, glm::vec3& position, glm::vec3& target) const;
+
+    // Set the view matrix of the camera to the position and the target at this time
+    void Apply(float time, Camera& camera) const;
+
+    // Circle around the center at a fixed height, looking at the center
+    static CameraPath CreateOrbit(const glm::vec3& center, float radius, float height, float duration, unsigned int keyframeCount = 8);
+
+private:
+    const Keyframe& GetKeyframe(int index) const;
+
+private:
+    bool m_loop;
+    std::vector<Keyframe> m_keyframes;
+};
@@ -13,6 +13,14 @@ public:
         ArrayBuffer = GL_ARRAY_BUFFER,
         // Element Buffer Object
         ElementArrayBuffer = GL_ELEMENT_ARRAY_BUFFER,
+        // Uniform Buffer Object
+        UniformBuffer = GL_UNIFORM_BUFFER,
+        // Data read by a buffer texture
+        TextureBuffer = GL_TEXTURE_BUFFER,
+        // Read and written by shaders, OpenGL 4.3
+        ShaderStorageBuffer = GL_SHADER_STORAGE_BUFFER,
+        // Parameters of indirect drawcalls, OpenGL 4.0
+        DrawIndirectBuffer = GL_DRAW_INDIRECT_BUFFER,
         // TODO: There are more types, add them when they are supported
     };
 
@@ -58,6 +66,9 @@ public:
     // Modify the contents of the buffer, starting at offset
     void UpdateData(std::span<const std::byte> data, size_t offset = 0);
 
+    // Bind to an indexed binding point of an indexed target (uniform or shader storage), whatever the target of the buffer
+    void BindBase(Target target, GLuint bindingPoint) const;
+
 protected:
     // Bind the specific target. Used by the Bind() method in derived classes
     void Bind(Target target) const;
@@ -2,6 +2,10 @@
 
 #include <ituGL/core/Color.h>
 #include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
 
 class Window;
 struct GLFWwindow;
@@ -46,16 +50,117 @@ public:
     inline void EnableFeature(GLenum feature) { SetFeatureEnabled(feature, true); }
     inline void DisableFeature(GLenum feature) { SetFeatureEnabled(feature, false); }
 
+    // enable / disable writing to the color attachments. Not cached
+    void SetColorWrite(bool enabled);
+
     // enable / disable wireframe mode
     void SetWireframeEnabled(bool enabled);
 
     // enable / disable v-sync
     void SetVSyncEnabled(bool enabled);
 
+    // Counters of the work submitted to OpenGL, and of the state changes that went through the state cache
+    struct StateStats
+    {
+        // Calls that reached OpenGL because the state was different
+        unsigned int issuedCalls = 0;
+        // Calls skipped because the state was already set
+        unsigned int skippedCalls = 0;
+        // Drawcalls issued with Drawcall, and the ones of them that were instanced
+        unsigned int drawcalls = 0;
+        unsigned int instancedDrawcalls = 0;
+        // Instances, vertices and triangles drawn, counting every instance
+        unsigned int instances = 0;
+        uint64_t vertices = 0;
+        uint64_t triangles = 0;
+        // Shader programs and textures actually bound, after the state cache
+        unsigned int programBinds = 0;
+        unsigned int textureBinds = 0;
+        // Calls to glUniform*, framebuffer binds and bytes copied into buffer objects
+        unsigned int uniformUploads = 0;
+        unsigned int framebufferBinds = 0;
+        uint64_t bufferBytesUploaded = 0;
+    };
+
+    // Get the counters since the last reset
+    inline const StateStats& GetStateStats() const { return m_stateStats; }
+    // Count a drawcall in the stats. Instanced draws are the ones issued with DrawInstanced, even with one instance
+    void AddDrawcallStats(bool instanced, unsigned int instanceCount, unsigned int vertexCount, unsigned int triangleCount);
+    // Count other work submitted outside of DeviceGL
+    inline void AddUniformUploadStats() { ++m_stateStats.uniformUploads; }
+    inline void AddFramebufferBindStats() { ++m_stateStats.framebufferBinds; }
+    inline void AddBufferUploadStats(size_t bytes) { m_stateStats.bufferBytesUploaded += bytes; }
+    // Reset the state cache counters, usually once per frame
+    void ResetStateStats();
+
+    // Forget all the cached state. Needed if OpenGL state was changed without going through DeviceGL
+    void InvalidateState();
+
+    // Set the shader program in use, skipped if it is already in use
+    void UseShaderProgram(GLuint handle);
+    // Bind the vertex array object, skipped if it is already bound
+    void BindVertexArray(GLuint handle);
+    // Set the active texture unit, skipped if it is already active
+    void SetActiveTextureUnit(GLint textureUnit);
+    // Bind the texture to the active texture unit, skipped if it is already bound
+    void BindTexture(GLenum target, GLuint handle);
+
+    // Remove deleted objects from the cache, as their handles can be reused
+    void InvalidateShaderProgram(GLuint handle);
+    void InvalidateVertexArray(GLuint handle);
+    void InvalidateTexture(GLuint handle);
+
+    // Set the depth test function and depth write
+    void SetDepthFunction(GLenum function);
+    void SetDepthWrite(bool enabled);
+
+    // Set the faces removed when GL_CULL_FACE is enabled: GL_FRONT, GL_BACK or GL_FRONT_AND_BACK
+    void SetCullFace(GLenum face);
+
+    // Set the stencil test function and operations. Face can be GL_FRONT, GL_BACK or GL_FRONT_AND_BACK
+    void SetStencilFunction(GLenum face, GLenum function, GLint refValue, GLuint mask);
+    void SetStencilOperations(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass);
+
+    // Set the blend equations, params and color
+    void SetBlendEquation(GLenum colorEquation, GLenum alphaEquation);
+    void SetBlendFunction(GLenum sourceColor, GLenum destinationColor, GLenum sourceAlpha, GLenum destinationAlpha);
+    void SetBlendColor(const Color& color);
+
+private:
+    // Compare the cached state with the new value. Returns true if the GL call needs to be issued
+    template<typename T>
+    bool UpdateState(std::optional<T>& state, const T& value);
+
 private:
     // Has a context been loaded? We use the context of the current window
     bool m_contextLoaded;
 
+    // Number of texture units tracked by the state cache. Units beyond this are never skipped
+    static const int MaxCachedTextureUnits = 32;
+
+    // Last known values of the OpenGL state. Empty values are unknown and will always be issued
+    struct StateCache
+    {
+        std::optional<GLuint> shaderProgram;
+        std::optional<GLuint> vertexArray;
+        std::optional<GLint> activeTextureUnit;
+        // Last target and texture bound to each unit
+        std::array<std::optional<std::pair<GLenum, GLuint>>, MaxCachedTextureUnits> textures;
+        std::unordered_map<GLenum, bool> features;
+        std::optional<GLenum> depthFunction;
+        std::optional<bool> depthWrite;
+        std::optional<GLenum> cullFace;
+        // Front and back stencil function (function, ref value, mask) and operations
+        std::array<std::optional<std::array<GLuint, 3>>, 2> stencilFunctions;
+        std::array<std::optional<std::array<GLenum, 3>>, 2> stencilOperations;
+        std::optional<std::array<GLenum, 2>> blendEquation;
+        std::optional<std::array<GLenum, 4>> blendFunction;
+        std::optional<std::array<float, 4>> blendColor;
+    };
+    StateCache m_stateCache;
+
+    StateStats m_stateStats;
+
 private:
     // Singleton instance
     static DeviceGL* m_instance;
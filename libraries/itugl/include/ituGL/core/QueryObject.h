@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ituGL/core/Object.h>
+
+// Query objects ask the GPU for information about the commands between Begin and End, like their time or the samples drawn
+// Results are ready some time after the commands run. Check IsResultAvailable to read them without waiting for the GPU
+class QueryObject : public Object
+{
+public:
+    // Type of the query
+    enum Target : GLenum
+    {
+        SamplesPassed = GL_SAMPLES_PASSED,
+        AnySamplesPassed = GL_ANY_SAMPLES_PASSED,
+        PrimitivesGenerated = GL_PRIMITIVES_GENERATED,
+        TimeElapsed = GL_TIME_ELAPSED,
+    };
+
+public:
+    QueryObject();
+    virtual ~QueryObject();
+
+    // Move semantics
+    QueryObject(QueryObject&& queryObject) noexcept;
+    QueryObject& operator = (QueryObject&& queryObject) noexcept;
+
+    // Implements the Bind required by Object. Queries are started with Begin instead
+    void Bind() const override;
+
+    // Only one query of each target can be active at the same time
+    void Begin(Target target) const;
+    static void End(Target target);
+
+    // Record the GPU time when the previous commands complete, in nanoseconds
+    void QueryTimestamp() const;
+
+    // Check if the GPU finished the commands of the query, without waiting for it
+    bool IsResultAvailable() const;
+
+    // Get the result of the query. Waits for the GPU if the result is not available yet
+    GLuint64 GetResult() const;
+};
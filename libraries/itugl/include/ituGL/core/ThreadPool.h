@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of worker threads to split CPU work in tasks
+// No OpenGL calls can be done from the tasks, the context belongs to the main thread
+class ThreadPool
+{
+public:
+    // Function called for each task with the range [begin, end) of elements and the index of the task
+    using TaskFunction = std::function<void(unsigned int begin, unsigned int end, unsigned int taskIndex)>;
+
+public:
+    // By default, one worker less than the hardware threads, because the calling thread also runs tasks
+    ThreadPool();
+    ThreadPool(unsigned int workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator = (const ThreadPool&) = delete;
+
+    inline unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+    // Number of tasks that ParallelFor will create for this element count
+    unsigned int GetTaskCount(unsigned int count, unsigned int minTaskSize) const;
+
+    // Split count elements in tasks of at least minTaskSize elements, and wait until all of them are done
+    // Tasks cover consecutive ranges in order, so results stored by task index can be merged deterministically
+    void ParallelFor(unsigned int count, unsigned int minTaskSize, const TaskFunction& function);
+
+private:
+    void WorkerLoop(unsigned int workerIndex);
+
+private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_jobs;
+    bool m_stopping;
+};
@@ -31,9 +31,21 @@ public:
     // Check if the drawcall is valid
     inline bool IsValid() const { return m_primitive != Primitive::Invalid && m_count > 0; }
 
+    inline Primitive GetPrimitive() const { return m_primitive; }
+    // Offset in bytes if there is an EBO, first vertex otherwise
+    inline GLint GetFirst() const { return m_first; }
+    inline GLsizei GetCount() const { return m_count; }
+    inline Data::Type GetEBOType() const { return m_eboType; }
+
+    // Number of triangles assembled from the vertices, 0 for points, lines and patches
+    unsigned int GetTriangleCount() const;
+
     // Execute the drawcall
     void Draw() const;
 
+    // Execute the drawcall several times, with per-instance vertex attributes advancing for each instance
+    void DrawInstanced(GLsizei instanceCount) const;
+
 private:
     // Type of primitive to be rendered
     Primitive m_primitive;
@@ -6,8 +6,10 @@
 #include <ituGL/geometry/VertexAttribute.h>
 #include <ituGL/geometry/Drawcall.h>
 #include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/scene/Bounds.h>
 #include <vector>
 #include <unordered_map>
+#include <optional>
 
 // Class that groups several VBO, EBO and VAO that are part of the same object
 // Can contain several drawcalls using the data in those objects
@@ -113,6 +115,20 @@ public:
     inline const VertexArrayObject& GetSubmeshVertexArray(unsigned int submeshIndex) const { return m_vaos[m_submeshes[submeshIndex].vaoIndex]; }
     inline const Drawcall& GetSubmeshDrawcall(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].drawcall; }
 
+    // Levels of detail of a submesh, drawn with the same VAO. Level 0 is the drawcall of the submesh, and each level adds a coarser one
+    unsigned int AddSubmeshLod(unsigned int submeshIndex, const Drawcall& drawcall);
+    inline unsigned int GetSubmeshLodCount(unsigned int submeshIndex) const { return static_cast<unsigned int>(m_submeshes[submeshIndex].lodDrawcalls.size()) + 1; }
+    const Drawcall& GetSubmeshDrawcall(unsigned int submeshIndex, unsigned int lod) const;
+
+    // Bounds of a submesh in mesh space. Submeshes without bounds are never culled
+    void SetSubmeshBounds(unsigned int submeshIndex, const AabbBounds& bounds);
+    inline bool HasSubmeshBounds(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].bounds.has_value(); }
+    inline const AabbBounds& GetSubmeshBounds(unsigned int submeshIndex) const { return *m_submeshes[submeshIndex].bounds; }
+
+    // Bounds of all the submeshes in mesh space. Only available if all the submeshes have bounds
+    inline bool HasBounds() const { return m_bounds.has_value() && m_boundedSubmeshCount == GetSubmeshCount(); }
+    inline const AabbBounds& GetBounds() const { return *m_bounds; }
+
     // Draws a submesh
     void DrawSubmesh(int submeshIndex) const;
 
@@ -123,6 +139,9 @@ private:
     {
         unsigned int vaoIndex;
         Drawcall drawcall;
+        std::optional<AabbBounds> bounds;
+        // Coarser levels of detail, starting at level 1
+        std::vector<Drawcall> lodDrawcalls;
     };
 
 private:
@@ -151,6 +170,10 @@ private:
 
     // Submeshes contained in this mesh
     std::vector<Submesh> m_submeshes;
+
+    // Union of the submesh bounds, and how many submeshes contribute to it
+    std::optional<AabbBounds> m_bounds;
+    unsigned int m_boundedSubmeshCount;
 };
 
 template<typename T>
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+// Reduces the triangles of an indexed mesh with quadric error edge collapses (Garland and Heckbert)
+// Vertices are never moved or created, a collapse replaces one vertex with the other end of the edge,
+// so the simplified indices can be drawn with the original vertex buffer
+// Vertices on seams (same position, different attributes), borders and non-manifold edges are kept, to avoid opening holes
+class MeshSimplifier
+{
+public:
+    MeshSimplifier(std::span<const glm::vec3> positions, std::span<const unsigned int> indices);
+
+    // Collapse the cheapest edges until there are at most targetTriangleCount triangles, or no edge can collapse
+    // The error keeps accumulating, so it can be called again with a lower target to build the next level of detail
+    void Simplify(unsigned int targetTriangleCount);
+
+    std::span<const unsigned int> GetIndices() const { return m_indices; }
+    unsigned int GetTriangleCount() const { return static_cast<unsigned int>(m_indices.size() / 3); }
+
+private:
+    // Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+    struct Quadric
+    {
+        double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+
+        void AddPlane(const glm::vec3& normal, float distance, float weight);
+        void Add(const Quadric& other);
+        double Evaluate(const glm::vec3& position) const;
+    };
+
+    // Move the vertex "from" to the vertex "to"
+    struct Collapse
+    {
+        double cost;
+        unsigned int from;
+        unsigned int to;
+    };
+
+private:
+    void WeldVertices();
+    void InitializeQuadrics();
+    void LockBorders();
+    void BuildAdjacency();
+
+    // Collapse a batch of edges that don't share triangles. Returns false if none could collapse
+    bool SimplifyPass(unsigned int targetTriangleCount);
+
+    // True if any triangle around "from", that stays after the collapse, would turn too much
+    bool FlipsTriangles(unsigned int from, unsigned int to) const;
+
+private:
+    std::vector<glm::vec3> m_positions;
+    std::vector<unsigned int> m_indices;
+
+    // First vertex with the same position. Welded vertices share the quadric and the locked state
+    std::vector<unsigned int> m_welded;
+    std::vector<Quadric> m_quadrics;
+    std::vector<bool> m_locked;
+
+    // Triangles around each vertex, rebuilt every pass
+    std::vector<unsigned int> m_adjacencyOffsets;
+    std::vector<unsigned int> m_adjacency;
+
+    // Per pass state, kept to reuse the memory
+    std::vector<Collapse> m_collapses;
+    std::vector<unsigned int> m_remap;
+    std::vector<bool> m_touched;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include <vector>
 
 class Mesh;
@@ -33,6 +34,14 @@ public:
     // Clear the list of materials
     void ClearMaterials();
 
+    // Screen sizes where the coarser levels of detail of the submeshes start: level i + 1 is used below threshold i
+    // The screen size is the diameter of the bounding sphere, as a fraction of the screen height
+    std::span<const float> GetLodThresholds() const;
+    void SetLodThresholds(std::span<const float> lodThresholds);
+
+    // Level of detail for a screen size. The previous level is kept until the size passes the threshold by the hysteresis fraction
+    unsigned int SelectLod(float screenSize, unsigned int lodCount, unsigned int previousLod = 0, float hysteresis = 0.0f) const;
+
     // Draw all the submeshes of the mesh, each one with a material on the list
     void Draw();
 
@@ -42,4 +51,7 @@ private:
 
     // List of material pointers, one for each submesh
     std::vector<std::shared_ptr<Material>> m_materials;
+
+    // Decreasing screen sizes, one less than the levels of detail
+    std::vector<float> m_lodThresholds;
 };
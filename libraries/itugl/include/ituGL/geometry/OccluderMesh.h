@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+class AabbBounds;
+
+// Simplified geometry of a model, kept on the CPU to be rasterized by the OcclusionCuller
+// It should be closed and fit inside the rendered mesh, or it could hide things that are visible around it
+class OccluderMesh
+{
+public:
+    OccluderMesh();
+    OccluderMesh(std::span<const glm::vec3> vertices, std::span<const unsigned int> indices);
+
+    std::span<const glm::vec3> GetVertices() const { return m_vertices; }
+    std::span<const unsigned int> GetIndices() const { return m_indices; }
+    unsigned int GetTriangleCount() const { return static_cast<unsigned int>(m_indices.size() / 3); }
+
+    // Box with the 12 triangles of the bounds, good enough for walls and buildings
+    static OccluderMesh CreateBox(const AabbBounds& bounds);
+
+private:
+    std::vector<glm::vec3> m_vertices;
+    std::vector<unsigned int> m_indices;
+};
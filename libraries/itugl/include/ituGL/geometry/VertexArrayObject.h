@@ -27,6 +27,9 @@ public:
     // stride: how far each element is from the previous one. Default value 0 will use the attribute size
     void SetAttribute(GLuint location, const VertexAttribute& attribute, GLint offset, GLsizei stride = 0);
 
+    // Sets how often the attribute in that location advances: 0 for every vertex, N for every N instances
+    void SetAttributeDivisor(GLuint location, GLuint divisor);
+
 #ifndef NDEBUG
     // Check if there is any VertexArrayObject currently bound
     inline static bool IsAnyBound() { return s_boundHandle != Object::NullHandle; }
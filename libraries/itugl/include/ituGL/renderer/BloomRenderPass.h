@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+#include <glm/vec2.hpp>
+#include <vector>
+
+class Texture2DObject;
+class FramebufferObject;
+class ShaderProgram;
+
+// Bloom with a mip chain: the bright pixels of the source are downsampled level by level with a 13-tap filter,
+// then each level is upsampled with a tent filter and added to the next bigger one
+// Every level halves the size, so the blur gets wide while most of the passes only touch a few pixels
+// The target is the first level, at half the size of the source. It ends with the sum of all the levels
+class BloomRenderPass : public RenderPass
+{
+public:
+    BloomRenderPass(std::shared_ptr<const Texture2DObject> sourceTexture, std::shared_ptr<const Texture2DObject> targetTexture,
+        std::shared_ptr<const FramebufferObject> targetFramebuffer, int width, int height, int maxLevelCount = 6);
+    ~BloomRenderPass();
+
+    void Render() override;
+
+    const char* GetName() const override { return "Bloom"; }
+
+    // Luminance where the bloom starts and where it reaches full intensity
+    const glm::vec2& GetRange() const { return m_range; }
+    void SetRange(const glm::vec2& range) { m_range = range; }
+
+    float GetIntensity() const { return m_intensity; }
+    void SetIntensity(float intensity) { m_intensity = intensity; }
+
+    // Levels of the chain, counting the target. Fewer than requested if the window is small
+    int GetLevelCount() const { return m_levelCount; }
+
+private:
+    void InitializeShaderPrograms();
+
+private:
+    std::shared_ptr<const Texture2DObject> m_sourceTexture;
+    std::shared_ptr<const Texture2DObject> m_targetTexture;
+    int m_width;
+    int m_height;
+    int m_levelCount;
+
+    glm::vec2 m_range;
+    float m_intensity;
+
+    // Levels after the target, as the mips of one texture, with one framebuffer to write each of them
+    std::shared_ptr<Texture2DObject> m_chainTexture;
+    std::vector<std::shared_ptr<FramebufferObject>> m_levelFramebuffers;
+
+    std::shared_ptr<ShaderProgram> m_downsampleShaderProgram;
+    std::shared_ptr<ShaderProgram> m_upsampleShaderProgram;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+
+#include <ituGL/renderer/LightClusters.h>
+#include <vector>
+
+// Forward pass that draws each drawcall once, with all the lights that reach it
+// Lights are assigned to the clusters of the view frustum, and the shaders only evaluate the lights of their cluster
+// Shaders read the clusters with the LightClusterUniforms block and the cluster textures (see LightClusters)
+class ClusteredForwardRenderPass : public RenderPass
+{
+public:
+    ClusteredForwardRenderPass();
+    ClusteredForwardRenderPass(int drawcallCollectionIndex);
+
+    void Render() override;
+
+    const char* GetName() const override { return "ClusteredForward"; }
+
+    const LightClusters& GetLightClusters() const { return m_lightClusters; }
+
+private:
+    void SetupShaderProgram(const ShaderProgram& shaderProgram);
+
+private:
+    int m_drawcallCollectionIndex;
+
+    LightClusters m_lightClusters;
+
+    // Programs that have the cluster resources assigned, indexed by program id
+    std::vector<bool> m_setupShaderPrograms;
+};
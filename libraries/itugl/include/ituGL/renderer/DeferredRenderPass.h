@@ -4,10 +4,13 @@
 
 #include <ituGL/shader/ShaderProgram.h>
 #include <ituGL/geometry/Mesh.h>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
 #include <memory>
 
 class Texture2DObject;
 class Material;
+class Light;
 
 class DeferredRenderPass: public RenderPass
 {
@@ -16,9 +19,34 @@ public:
 
     void Render() override;
 
+    const char* GetName() const override { return "Deferred"; }
+
+    // Point and spot lights are drawn as volumes that only cover the pixels in their range
+    // If the target framebuffer has the depth of the g-buffer attached, the volumes can also be depth tested
+    // to skip the pixels behind them. Without it, the depth buffer of the target would reject the wrong pixels
+    bool GetLightVolumeDepthTest() const { return m_lightVolumeDepthTest; }
+    void SetLightVolumeDepthTest(bool enabled) { m_lightVolumeDepthTest = enabled; }
+
+    // Matrix that places the unit cone over the lit area of a spot light, with the apex at the light
+    // The angle is the outer angle of the light, and must be below 90 degrees
+    static glm::mat4 GetSpotLightConeMatrix(const glm::vec3& position, const glm::vec3& direction, float range, float angle);
+
 private:
     void InitializeMeshes();
+    void InitializeSphereMesh();
+    void InitializeConeMesh();
+
+    // Select the volume that contains the lit area of the light, and the matrix to place it
+    // Returns nullptr if the light needs the fullscreen triangle
+    const Mesh* GetLightVolume(const Light& light, glm::mat4& worldMatrix) const;
 
 private:
     std::shared_ptr<Material> m_material;
+
+    // Unit volumes, with all the points at distance 1 inside them
+    // Sphere centered at the origin, and cone with the apex at the origin and the base at z = -1
+    Mesh m_sphereMesh;
+    Mesh m_coneMesh;
+
+    bool m_lightVolumeDepthTest;
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+#include <glm/mat4x4.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ShaderProgram;
+class VertexArrayObject;
+class Drawcall;
+
+// Draws the depth of the opaque drawcalls of a collection, before the passes that shade them
+// It only runs if the pre-pass is enabled in the collection. Then, the passes drawing the collection test the depth with GL_EQUAL,
+// so the expensive fragment shaders only run once per pixel
+// To match the depth exactly, the vertex shaders of the collection must compute the position as
+// ViewProjMatrix * (WorldMatrix * vec4(VertexPosition, 1.0)) and declare gl_Position invariant
+class DepthPrePassRenderPass : public RenderPass
+{
+public:
+    // If clearDepth is set, the depth of the target framebuffer is cleared before drawing. Nothing is cleared while disabled
+    DepthPrePassRenderPass(int drawcallCollectionIndex = 0, std::shared_ptr<const FramebufferObject> targetFramebuffer = nullptr, bool clearDepth = false);
+    ~DepthPrePassRenderPass();
+
+    void Render() override;
+
+    const char* GetName() const override { return "DepthPrePass"; }
+
+private:
+    void InitializeShaderProgram();
+
+private:
+    int m_drawcallCollectionIndex;
+    bool m_clearDepth;
+
+    // Position only program, drawing all the drawcalls as instances
+    std::shared_ptr<ShaderProgram> m_shaderProgram;
+
+    // Drawcalls of the frame with the same mesh, drawn together as instances. Kept between frames to reuse the memory
+    struct InstanceGroup
+    {
+        const VertexArrayObject* vao;
+        const Drawcall* drawcall;
+        std::vector<glm::mat4> worldMatrices;
+    };
+    std::vector<InstanceGroup> m_instanceGroups;
+    unsigned int m_instanceGroupCount;
+    std::unordered_map<const Drawcall*, unsigned int> m_instanceGroupIndices;
+
+    // View depth and index of the opaque drawcalls, sorted front to back
+    std::vector<std::pair<float, unsigned int>> m_sortedDrawcalls;
+};
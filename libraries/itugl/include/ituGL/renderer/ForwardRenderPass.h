@@ -10,6 +10,8 @@ public:
 
     void Render() override;
 
+    const char* GetName() const override { return "Forward"; }
+
 private:
     int m_drawcallCollectionIndex;
 };
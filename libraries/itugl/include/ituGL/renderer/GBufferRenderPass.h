@@ -11,6 +11,8 @@ public:
 
     void Render() override;
 
+    const char* GetName() const override { return "GBuffer"; }
+
     const std::shared_ptr<Texture2DObject> GetDepthTexture() const { return m_depthTexture; }
     const std::shared_ptr<Texture2DObject> GetAlbedoTexture() const { return m_albedoTexture; }
     const std::shared_ptr<Texture2DObject> GetNormalTexture() const { return m_normalTexture; }
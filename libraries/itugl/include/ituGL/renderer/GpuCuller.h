@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/shader/ShaderStorageBufferObject.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+class ShaderProgram;
+class Texture2DObject;
+
+using DrawIndirectBufferObject = BufferObjectBase<BufferObject::DrawIndirectBuffer>;
+
+// Culls instances on the GPU with a compute shader, and compacts the visible ones in indirect drawcalls
+// Instances are tested against the camera frustum, and against the hierarchical depth of the previous frame if there is one
+// The world matrices of the visible instances are written to a buffer read by the instance attribute, so the
+// instanced shaders don't change. The CPU never reads the results back
+// Compute shaders and multi draw indirect need OpenGL 4.3
+class GpuCuller
+{
+public:
+    // Instance to test. Must match the std430 layout of the Instances block in the compute shader
+    struct Instance
+    {
+        glm::mat4 worldMatrix;
+        // Local bounds of the mesh. The w of the center is the index of the draw command
+        glm::vec4 boundsCenter;
+        glm::vec4 boundsSize;
+    };
+    static_assert(sizeof(Instance) == 96, "Instance must follow the std430 layout");
+
+    // Same layout as the commands read by glMultiDrawElementsIndirect
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+public:
+    GpuCuller();
+    ~GpuCuller();
+
+    // True if the current context can run the culling
+    static bool IsSupported();
+
+    // Instances of each command must be consecutive, starting at the base instance of the command
+    // The instance count of the commands is ignored, it is written by the culling
+    void SetInstances(std::span<const Instance> instances, std::span<const DrawCommand> drawCommands);
+    unsigned int GetInstanceCount() const { return m_instanceCount; }
+
+    // Depth of the previous frame, and the view projection matrix it was rendered with. Set by HiZRenderPass
+    void SetHiZ(std::shared_ptr<const Texture2DObject> hiZTexture, int levelCount, const glm::mat4& viewProjMatrix);
+    // Stop using the depth, for example after the depth texture is resized
+    void InvalidateHiZ();
+
+    // Reset the commands and test all the instances. Drawcalls issued after it read the results
+    void Cull(const glm::mat4& viewProjMatrix);
+
+    // Buffer with the world matrices of the visible instances. The base instance of each command points to its range
+    const VertexBufferObject& GetWorldMatrixBuffer() const { return m_worldMatrixBuffer; }
+
+    // Draw a range of commands. The VAO must be bound, with the instance attribute reading the world matrix buffer
+    void Draw(unsigned int firstCommand, unsigned int commandCount, Drawcall::Primitive primitive, Data::Type eboType) const;
+
+private:
+    void InitializeShaderProgram();
+
+private:
+    unsigned int m_instanceCount;
+    ShaderStorageBufferObject m_instanceBuffer;
+    std::vector<DrawCommand> m_drawCommands;
+    // Written by the compute shader, as storage, and read by the drawcalls, as indirect buffer
+    DrawIndirectBufferObject m_drawCommandBuffer;
+    VertexBufferObject m_worldMatrixBuffer;
+
+    std::shared_ptr<const Texture2DObject> m_hiZTexture;
+    int m_hiZLevelCount;
+    glm::mat4 m_hiZViewProjMatrix;
+
+    std::shared_ptr<ShaderProgram> m_shaderProgram;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+class Texture2DObject;
+class FramebufferObject;
+class ShaderProgram;
+
+// Builds a hierarchical depth buffer from a depth texture: each mip level keeps the farthest depth of the texels below it
+// Add it after the pass that writes the depth. The GPU culler of the renderer tests the next frame against it
+// It only uses fragment shaders, so it runs with OpenGL 4.1
+class HiZRenderPass : public RenderPass
+{
+public:
+    HiZRenderPass(std::shared_ptr<const Texture2DObject> depthTexture, int width, int height);
+    ~HiZRenderPass();
+
+    void Render() override;
+
+    const char* GetName() const override { return "HiZ"; }
+
+    // Red float texture with the whole mip chain, down to 1x1
+    std::shared_ptr<const Texture2DObject> GetHiZTexture() const { return m_hiZTexture; }
+    int GetLevelCount() const { return static_cast<int>(m_levelFramebuffers.size()); }
+
+private:
+    void InitializeShaderPrograms();
+
+private:
+    std::shared_ptr<const Texture2DObject> m_depthTexture;
+    std::shared_ptr<Texture2DObject> m_hiZTexture;
+    int m_width;
+    int m_height;
+
+    // One framebuffer to write each level
+    std::vector<std::shared_ptr<FramebufferObject>> m_levelFramebuffers;
+
+    // Copies the depth to the first level, and reduces each level to the next one
+    std::shared_ptr<ShaderProgram> m_copyShaderProgram;
+    std::shared_ptr<ShaderProgram> m_reduceShaderProgram;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <ituGL/shader/UniformBufferObject.h>
+#include <ituGL/texture/TextureBufferObject.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <vector>
+
+class Camera;
+class Light;
+class ShaderProgram;
+class ThreadPool;
+
+// Grid of clusters that splits the view frustum, with the list of lights that can reach each cluster
+// Clusters are uniform in screen space and exponential in depth, so they keep a similar shape along the frustum
+// Shaders find their cluster from the position, and only evaluate the lights in it
+class LightClusters
+{
+public:
+    // Values used by the shaders to find the cluster of a position
+    // Must match the std140 layout of the LightClusterUniforms block in the shaders
+    struct ClusterUniforms
+    {
+        // Number of clusters in x, y and z, and number of lights
+        glm::uvec4 clusterCount;
+        // Near and far distance, and scale and bias to get the depth slice from the log of the view depth
+        glm::vec4 depthParams;
+    };
+    static_assert(sizeof(ClusterUniforms) == 32, "ClusterUniforms must follow the std140 layout");
+
+    // Binding point of the LightClusterUniforms block
+    static const GLuint ClusterUniformsBinding = 1;
+
+    // Texture units of the buffer textures. Materials assign their textures from unit 0, so these use the last ones
+    static constexpr GLint LightDataTextureUnit = 13;
+    static constexpr GLint ClusterRangesTextureUnit = 14;
+    static constexpr GLint LightIndicesTextureUnit = 15;
+
+    // Each light takes 4 texels in the light data: color, position, direction and attenuation
+    static const unsigned int TexelsPerLight = 4;
+
+public:
+    LightClusters(unsigned int countX = 16, unsigned int countY = 9, unsigned int countZ = 24);
+
+    const glm::uvec3& GetClusterCount() const { return m_clusterCount; }
+
+    // Assign the lights to the clusters of the camera frustum. Only supports perspective cameras
+    // It is only CPU work, lights and depth slices are split in tasks for the thread pool
+    void Build(std::span<const Light* const> lights, const Camera& camera, ThreadPool& threadPool);
+
+    // Upload the last build and bind the buffers to the units and binding point used by the shaders
+    void Upload();
+
+    // Assign the cluster resources declared by the shader program to the units and binding point above
+    // Sampler and block bindings are stored in the program, so this is only needed once per program
+    static void SetupShaderProgram(const ShaderProgram& shaderProgram);
+
+    // Total number of light references in the clusters, to see how well the lights are distributed
+    unsigned int GetLightIndexCount() const { return static_cast<unsigned int>(m_lightIndices.size()); }
+
+private:
+    // Range of clusters affected by a light, inclusive. Empty if min > max
+    struct LightRange
+    {
+        glm::uvec3 min;
+        glm::uvec3 max;
+    };
+    LightRange ComputeLightRange(const Light& light, const glm::mat4& viewMatrix, const glm::mat4& projMatrix) const;
+
+    unsigned int GetDepthSlice(float depth) const;
+
+    inline unsigned int GetClusterIndex(unsigned int x, unsigned int y, unsigned int z) const
+    {
+        return (z * m_clusterCount.y + y) * m_clusterCount.x + x;
+    }
+
+    // Light indices of a group of depth slices, filled by one task
+    // Cluster offsets are relative to the bucket until the buckets are merged
+    struct SliceBucket
+    {
+        unsigned int beginSlice = 0;
+        unsigned int endSlice = 0;
+        std::vector<unsigned int> lightIndices;
+        std::vector<unsigned int> sliceLights;
+    };
+    void BuildSlices(unsigned int beginSlice, unsigned int endSlice, SliceBucket& bucket);
+
+private:
+    glm::uvec3 m_clusterCount;
+
+    ClusterUniforms m_uniforms;
+
+    // CPU copy of the data, rebuilt every frame. Vectors keep their memory between frames
+    std::vector<LightRange> m_lightRanges;
+    std::vector<glm::vec4> m_lightData;
+    // Offset in the light indices and number of lights of each cluster
+    std::vector<glm::uvec2> m_clusterRanges;
+    std::vector<unsigned int> m_lightIndices;
+    std::vector<SliceBucket> m_sliceBuckets;
+
+    UniformBufferObject m_uniformBuffer;
+    TextureBufferDataObject m_lightDataBuffer;
+    TextureBufferDataObject m_clusterRangesBuffer;
+    TextureBufferDataObject m_lightIndicesBuffer;
+    TextureBufferObject m_lightDataTexture;
+    TextureBufferObject m_clusterRangesTexture;
+    TextureBufferObject m_lightIndicesTexture;
+};
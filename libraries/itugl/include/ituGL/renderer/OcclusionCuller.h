@@ -0,0 +1,104 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+class OccluderMesh;
+class BoxBounds;
+class ThreadPool;
+
+// Rasterizes the occluders of the frame in a small depth buffer on the CPU, to cull the models hidden behind them
+// The buffer is split in tiles that are rasterized in parallel, 4 pixels at a time with SSE2 when it is available
+// A hierarchical buffer keeps the farthest depth of each block, so most bounds are rejected or accepted without reading pixels
+// It doesn't use OpenGL, so it can run and be tested without a GPU
+class OcclusionCuller
+{
+public:
+    // Work done by the last Rasterize
+    struct Stats
+    {
+        unsigned int occluders = 0;
+        // Triangles submitted, and the ones that covered the screen after clipping
+        unsigned int triangles = 0;
+        unsigned int rasterizedTriangles = 0;
+        // CPU time of the rasterization, in milliseconds
+        float rasterTime = 0.0f;
+    };
+
+    // Square tiles rasterized by one task, and blocks of the hierarchical depth buffer
+    static const int TileSize = 32;
+    static const int BlockSize = 8;
+
+public:
+    // Low resolutions are enough, occluders are big. Both sizes must be multiples of the block size
+    OcclusionCuller(int width = 256, int height = 128);
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    void SetResolution(int width, int height);
+
+    // The mesh must stay alive until the occluders are cleared
+    void AddOccluder(const OccluderMesh& mesh, const glm::mat4& worldMatrix);
+    bool HasOccluders() const { return !m_occluders.empty(); }
+    // Remove the occluders, and stop culling until the next Rasterize
+    void Clear();
+
+    // Draw the depth of the occluders as seen with the matrix. Tiles are split in tasks for the thread pool
+    void Rasterize(const glm::mat4& viewProjMatrix, ThreadPool& threadPool);
+    bool IsRasterized() const { return m_rasterized; }
+
+    // False if the box is completely behind the occluders. Always true if nothing was rasterized
+    // Only reads the depth buffer, so it can be called from several threads after Rasterize
+    bool IsVisible(const BoxBounds& box) const;
+
+    // Depth in [0, 1] of each pixel, by rows from the bottom. Far is 1
+    std::span<const float> GetDepthBuffer() const { return m_depthBuffer; }
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+    // Screen space triangle ready to rasterize: edge functions and depth plane as a * x + b * y + c
+    struct Triangle
+    {
+        glm::vec3 edgeA;
+        glm::vec3 edgeB;
+        glm::vec3 edgeC;
+        glm::vec3 depthPlane;
+        // Pixels covered by the bounding rectangle, inclusive
+        int minX, minY, maxX, maxY;
+    };
+
+    // Clip the triangle against the near plane, and set up the resulting triangles
+    void AddTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+    void AddScreenTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+    glm::vec3 GetScreenPosition(const glm::vec4& clipPosition) const;
+
+    void RasterizeTile(unsigned int tileIndex);
+    void RasterizeTriangle(const Triangle& triangle, int minX, int minY, int maxX, int maxY);
+
+private:
+    int m_width;
+    int m_height;
+    int m_tileCountX;
+    int m_tileCountY;
+
+    std::vector<std::pair<const OccluderMesh*, glm::mat4>> m_occluders;
+
+    glm::mat4 m_viewProjMatrix;
+    bool m_rasterized;
+
+    // Buffers reused every frame, to avoid allocations
+    std::vector<glm::vec4> m_clipPositions;
+    std::vector<Triangle> m_triangles;
+    // Indices of the triangles overlapping each tile
+    std::vector<std::vector<unsigned int>> m_tileTriangles;
+
+    std::vector<float> m_depthBuffer;
+    // Farthest depth of each block
+    std::vector<float> m_blockDepthBuffer;
+
+    Stats m_stats;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Shader;
+class ShaderProgram;
+
+// Fuses post effects that only read their own pixel into one fragment shader, so they run in a single pass,
+// without writing and reading a fullscreen texture between them. Effects that read the neighbours, like blurs, still need their own pass
+// Each stage is a GLSL snippet with a function "vec4 @Apply(vec4 color, vec2 texCoord)", called with the color of the previous stage.
+// The first stage gets the color of SourceTexture. Names that start with @ get the name of the stage as prefix, so stages can
+// use the same names for their uniforms and functions. Set those uniforms with the names from GetUniformName
+class PostFXComposer
+{
+public:
+    PostFXComposer();
+
+    // Code added once before the stages, like helper functions. It is not prefixed
+    void AddSharedSource(std::string_view source);
+    void AddSharedSourceFile(const char* path);
+
+    // The name must be a valid GLSL identifier, different for each stage. Stages run in the order they are added
+    void AddStage(std::string_view name, std::string_view source);
+    void AddStageFile(std::string_view name, const char* path);
+
+    unsigned int GetStageCount() const { return static_cast<unsigned int>(m_stages.size()); }
+
+    // Fragment shader with all the stages. Its inputs match renderer/fullscreen.vert: TexCoord in, FragColor out
+    std::string GenerateFragmentShaderSource() const;
+
+    // Program with the generated fragment shader
+    std::shared_ptr<ShaderProgram> Build(const Shader& vertexShader) const;
+
+    // Name in the program of the uniform declared as @name in the stage
+    static std::string GetUniformName(std::string_view stageName, std::string_view name);
+
+private:
+    static std::string ReadFile(const char* path);
+
+private:
+    struct Stage
+    {
+        std::string name;
+        std::string source;
+    };
+
+    std::vector<std::string> m_sharedSources;
+    std::vector<Stage> m_stages;
+};
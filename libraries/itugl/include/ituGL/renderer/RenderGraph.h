@@ -0,0 +1,164 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class Renderer;
+class RenderPass;
+class FramebufferObject;
+class Texture2DObject;
+
+// Describes a chain of render passes by the textures they read and write, and builds it into a Renderer
+// When compiled, the graph:
+// - Orders the passes so that each pass runs after the passes writing the textures it reads
+// - Removes the passes whose outputs are never read, nor are outputs of the graph
+// - Allocates the transient textures, sharing the same texture between resources that are not alive at the same time
+// - Creates the framebuffers with the written textures attached, and sets the viewport to their size
+class RenderGraph
+{
+public:
+    using ResourceId = unsigned int;
+    static const ResourceId InvalidResource = ~0u;
+
+    // Size and format of a texture resource
+    struct TextureDesc
+    {
+        int width;
+        int height;
+        TextureObject::Format format;
+        TextureObject::InternalFormat internalFormat;
+
+        bool operator == (const TextureDesc& other) const = default;
+    };
+
+    // Creates the render pass of a node, once the textures have been allocated
+    // The target framebuffer has the written textures attached, or it is the default framebuffer if the pass writes the backbuffer
+    // Use GetTexture to find the textures that the pass reads
+    using CreatePassFunction = std::function<std::unique_ptr<RenderPass>(const RenderGraph& graph, std::shared_ptr<const FramebufferObject> targetFramebuffer)>;
+
+public:
+    // Width and height of the default framebuffer
+    RenderGraph(int width, int height);
+    ~RenderGraph();
+
+    // Texture owned by the graph, only alive between the first and the last pass that use it
+    ResourceId CreateTexture(const char* name, const TextureDesc& desc);
+    // Texture owned by someone else. It keeps its contents, so it is never shared with other resources
+    ResourceId ImportTexture(const char* name, std::shared_ptr<Texture2DObject> texture, const TextureDesc& desc);
+
+    // The default framebuffer. It is always an output of the graph
+    ResourceId GetBackbuffer() const { return m_backbuffer; }
+    const TextureDesc& GetTextureDesc(ResourceId resourceId) const;
+
+    // Keep the passes writing the resource, even if no pass reads it
+    void MarkOutput(ResourceId resourceId);
+
+    // Passes that only read a resource run after all the passes that write it
+    // Passes that write the same resource run in the order they are added, and read what the previous writers left
+    // For example, a pass that depth tests against a depth texture can list it as read and written
+    void AddPass(const char* name, std::initializer_list<ResourceId> reads, std::initializer_list<ResourceId> writes, const CreatePassFunction& createPass);
+
+    // Order and cull the passes, and assign the transient resources to shared textures, without creating them
+    // It doesn't use OpenGL, so the result can be inspected without a GPU. Compile plans the graph if it wasn't
+    void Plan();
+    bool IsPlanned() const { return m_planned; }
+
+    // Order and cull the passes, allocate the resources, and add the passes to the renderer
+    // Can only be done once. Passes added to the renderer before are executed before the graph
+    void Compile(Renderer& renderer);
+
+    // Indices of the live passes, in the order they were added, sorted in execution order. Only valid after Plan
+    std::span<const unsigned int> GetExecutionOrder() const { return m_executionOrder; }
+    // Index of the shared texture assigned to a transient resource, or InvalidResource if it is imported or unused
+    // Resources with the same index use the same texture. Only valid after Plan
+    unsigned int GetTextureIndex(ResourceId resourceId) const;
+
+    // Texture assigned to a resource. Only valid after the resources are allocated, while creating the passes and after
+    std::shared_ptr<Texture2DObject> GetTexture(ResourceId resourceId) const;
+
+    // Statistics of the compiled graph
+    unsigned int GetPassCount() const { return static_cast<unsigned int>(m_passes.size()); }
+    unsigned int GetCulledPassCount() const { return m_culledPassCount; }
+    unsigned int GetTransientTextureCount() const { return m_transientTextureCount; }
+    unsigned int GetAllocatedTextureCount() const { return static_cast<unsigned int>(m_pooledTextures.size()); }
+    // Memory of the allocated textures, and the memory they would need without sharing
+    size_t GetAllocatedTextureBytes() const { return m_allocatedTextureBytes; }
+    size_t GetTransientTextureBytes() const { return m_transientTextureBytes; }
+
+private:
+    struct Resource
+    {
+        std::string name;
+        TextureDesc desc;
+        std::shared_ptr<Texture2DObject> texture;
+        bool imported = false;
+        bool output = false;
+        // Range of execution positions where the resource is used. Empty if first > last
+        unsigned int firstUse = ~0u;
+        unsigned int lastUse = 0;
+        // Pooled texture of a transient resource
+        unsigned int textureIndex = InvalidResource;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        CreatePassFunction createPass;
+        bool alive = false;
+    };
+
+    class ViewportRenderPass;
+
+    // Returns the live passes in execution order
+    std::vector<unsigned int> SortPasses() const;
+    void CullPasses();
+    void AssignTextures();
+    void CreateTextures();
+    std::shared_ptr<const FramebufferObject> GetFramebuffer(const Pass& pass);
+
+    static bool IsDepthFormat(TextureObject::Format format);
+    static size_t GetTextureBytes(const TextureDesc& desc);
+
+private:
+    int m_width;
+    int m_height;
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    ResourceId m_backbuffer;
+
+    // Live passes in execution order
+    std::vector<unsigned int> m_executionOrder;
+
+    // Textures shared by the transient resources. They are created when the graph is compiled
+    struct PooledTexture
+    {
+        std::shared_ptr<Texture2DObject> texture;
+        TextureDesc desc;
+        // Last execution position where the current resource uses it
+        unsigned int lastUse;
+    };
+    std::vector<PooledTexture> m_pooledTextures;
+
+    // Framebuffers are shared by the passes writing the same textures
+    struct CachedFramebuffer
+    {
+        std::vector<const Texture2DObject*> textures;
+        std::shared_ptr<FramebufferObject> framebuffer;
+    };
+    std::vector<CachedFramebuffer> m_framebuffers;
+
+    bool m_planned;
+    bool m_compiled;
+    unsigned int m_culledPassCount;
+    unsigned int m_transientTextureCount;
+    size_t m_allocatedTextureBytes;
+    size_t m_transientTextureBytes;
+};
@@ -15,6 +15,9 @@ public:
 
     virtual void Render() = 0;
 
+    // Name of the pass in the profiler. Must have static lifetime
+    virtual const char* GetName() const { return "RenderPass"; }
+
 protected:
     Renderer& GetRenderer();
     const Renderer& GetRenderer() const;
@@ -24,6 +27,7 @@ protected:
 
 private:
     friend class Renderer;
+    friend class RenderGraph;
     void SetRenderer(Renderer* renderer);
 
 private:
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ituGL/core/QueryObject.h>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class DearImGui;
+
+// Measures the GPU time of each render pass with timer queries, and the samples that pass the depth test with occlusion queries
+// Queries are buffered for a few frames, so their results are read when they are ready, without stalling the pipeline
+class RenderPassTimers
+{
+public:
+    // Frames between issuing the queries and reading them back
+    static const unsigned int FrameLatency = 3;
+    // Samples used for the rolling average
+    static const unsigned int HistorySize = 64;
+
+    struct PassTiming
+    {
+        // Name of the pass, with static lifetime
+        const char* name = nullptr;
+        // Milliseconds of the last sample read, and rolling average
+        float lastTime = 0.0f;
+        float averageTime = 0.0f;
+        // Last samples, oldest at historyOffset
+        std::array<float, HistorySize> history = {};
+        unsigned int historyOffset = 0;
+        unsigned int historyCount = 0;
+        // Samples that passed the depth and stencil tests in the last sample read, and the same per pixel of the viewport
+        // For passes shading geometry, samples per pixel above 1 is overdraw
+        uint64_t samplesPassed = 0;
+        float samplesPerPixel = 0.0f;
+    };
+
+public:
+    RenderPassTimers();
+
+    bool IsEnabled() const { return m_enabled; }
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    // Read the queries that finished, and prepare the queries of a new frame. The viewport must have the size of the frame
+    void BeginFrame(unsigned int passCount);
+
+    void BeginPass(unsigned int passIndex, const char* name);
+    void EndPass();
+
+    // Timings of the passes, indexed like the passes of the renderer
+    std::span<const PassTiming> GetPassTimings() const { return m_passTimings; }
+    // Sum of the average time of all the passes, in milliseconds
+    float GetTotalAverageTime() const;
+
+    // Draw the timings, with a graph of the last samples for each pass
+    void DrawGUI(DearImGui& imGui);
+
+private:
+    void AddSample(PassTiming& passTiming, float time);
+    void SetSamplesPassed(PassTiming& passTiming, uint64_t samplesPassed, unsigned int pixelCount);
+
+private:
+    bool m_enabled;
+
+    // Queries of one frame, one per pass
+    struct FrameQueries
+    {
+        std::vector<QueryObject> queries;
+        std::vector<QueryObject> sampleQueries;
+        // Passes that issued their query in this frame
+        std::vector<bool> issued;
+        // Pixels of the viewport when the frame started
+        unsigned int pixelCount = 0;
+    };
+    std::array<FrameQueries, FrameLatency> m_frames;
+    unsigned int m_frameIndex;
+
+    // Pass with an active query, or ~0u
+    unsigned int m_activePass;
+
+    std::vector<PassTiming> m_passTimings;
+};
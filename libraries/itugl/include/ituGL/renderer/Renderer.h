@@ -1,16 +1,24 @@
 #pragma once
 
 #include <ituGL/core/DeviceGL.h>
+#include <ituGL/core/ThreadPool.h>
 #include <ituGL/renderer/RenderPass.h>
+#include <ituGL/renderer/RenderPassTimers.h>
+#include <ituGL/renderer/OcclusionCuller.h>
+#include <ituGL/renderer/GpuCuller.h>
 #include <ituGL/geometry/Drawcall.h>
 #include <ituGL/geometry/Mesh.h>
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/shader/UniformBufferObject.h>
 #include <ituGL/shader/Material.h>
 #include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
 #include <vector>
-#include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <span>
 #include <functional>
+#include <cstdint>
 
 class Camera;
 class Light;
@@ -20,6 +28,10 @@ class VertexArrayObject;
 class Drawcall;
 class Model;
 class FramebufferObject;
+class FrustumBounds;
+class OccluderMesh;
+class Transform;
+class DearImGui;
 
 class Renderer
 {
@@ -34,14 +46,21 @@ public:
         const VertexArrayObject& GetVAO() const { return m_vao; }
         const Drawcall& GetDrawcall() const { return m_drawcall; }
 
+        // Key used to sort the drawcalls, computed once per frame by the renderer
+        uint64_t GetSortKey() const { return m_sortKey; }
+        void SetSortKey(uint64_t sortKey) { m_sortKey = sortKey; }
+
     private:
         std::reference_wrapper<const Material> m_material;
         unsigned int m_worldMatrixIndex;
         std::reference_wrapper<const VertexArrayObject> m_vao;
         std::reference_wrapper<const Drawcall> m_drawcall;
+        uint64_t m_sortKey;
     };
 
     using DrawcallSupportedFunction = std::function<bool(const DrawcallInfo& drawcallInfo)>;
+    using DrawcallSortFunction = std::function<bool(const DrawcallInfo&, const DrawcallInfo&)>;
+
     class DrawcallCollection
     {
     public:
@@ -54,24 +73,116 @@ public:
         std::span<const DrawcallInfo> GetDrawcalls() const { return m_drawcallInfos; }
 
         void AddDrawcall(const DrawcallInfo& drawcallInfo);
+        // Add drawcalls that already passed IsSupported, keeping their order
+        void AddSupportedDrawcalls(std::span<const DrawcallInfo> drawcallInfos);
+        // Merge drawcalls that already passed IsSupported into the sorted collection. Both must be sorted by the function
+        void MergeSupportedDrawcalls(std::span<const DrawcallInfo> drawcallInfos, const DrawcallSortFunction& drawcallSortFunction);
         void Clear();
 
+        // Sort the drawcalls by their sort key, using a stable LSD radix sort
+        void SortByKey();
+
+        // Sort the drawcalls with a custom function. It replaces sorting by key until the collection is cleared
+        void Sort(const DrawcallSortFunction& drawcallSortFunction);
+        bool IsSorted() const { return m_sorted; }
+        bool HasSortFunction() const { return static_cast<bool>(m_sortFunction); }
+        // Sort again with the custom function, if drawcalls were added after the last sort
+        void SortWithSortFunction();
+
+        // The opaque drawcalls of the collection write their depth in a DepthPrePassRenderPass before they are shaded
+        bool IsDepthPrePassEnabled() const { return m_depthPrePass; }
+        void SetDepthPrePassEnabled(bool enabled) { m_depthPrePass = enabled; }
+
     private:
         DrawcallSupportedFunction m_isSupported;
         std::vector<DrawcallInfo> m_drawcallInfos;
+        DrawcallSortFunction m_sortFunction;
+        bool m_sorted;
+        bool m_depthPrePass;
+
+        // Buffers reused every frame by SortByKey, to avoid allocations
+        std::vector<std::pair<uint64_t, unsigned int>> m_sortKeys;
+        std::vector<std::pair<uint64_t, unsigned int>> m_sortKeysTemp;
+        std::vector<DrawcallInfo> m_sortedDrawcallInfos;
     };
 
-    using DrawcallSortFunction = std::function<bool(const DrawcallInfo&, const DrawcallInfo&)>;
-
     using UpdateTransformsFunction = std::function<void(const ShaderProgram&, const glm::mat4&, const Camera&, bool)>;
     using UpdateLightsFunction = std::function<bool(const ShaderProgram&, std::span<const Light* const>, unsigned int&)>;
 
+    // Shader programs that declare this attribute are drawn with instancing. Being a mat4, it uses 4 consecutive locations
+    static const GLuint InstanceWorldMatrixLocation = 12;
+
+    // Identifier of a model registered once with AddStaticModel
+    using StaticModelId = unsigned int;
+
+    // Number of drawcalls that passed or failed frustum culling in the last frame, and the ones hidden by occluders
+    struct CullingStats
+    {
+        unsigned int visibleDrawcalls = 0;
+        unsigned int culledDrawcalls = 0;
+        unsigned int occludedDrawcalls = 0;
+        // Static drawcalls left to the GPU culler. Only the GPU knows which ones are visible
+        unsigned int gpuDrawcalls = 0;
+        // Visible drawcalls drawn with a coarser level of detail
+        unsigned int reducedLodDrawcalls = 0;
+    };
+
+    // Work issued by the last frame rendered: the device counters from the start of Render to its end, and the culling
+    struct FrameStats
+    {
+        DeviceGL::StateStats state;
+        CullingStats culling;
+        OcclusionCuller::Stats occlusion;
+    };
+
+    // Per-frame constants shared by all shader programs through a uniform buffer
+    // Must match the std140 layout of the FrameUniforms block in the shaders
+    struct FrameUniforms
+    {
+        glm::mat4 viewMatrix;
+        glm::mat4 projMatrix;
+        glm::mat4 viewProjMatrix;
+        glm::mat4 invViewMatrix;
+        glm::mat4 invProjMatrix;
+        glm::mat4 invViewProjMatrix;
+        glm::vec3 cameraPosition;
+        float time;
+    };
+    static_assert(sizeof(FrameUniforms) == 6 * 64 + 16, "FrameUniforms must follow the std140 layout");
+
+    // Binding point of the FrameUniforms block. Registered programs have their block assigned to it
+    static const GLuint FrameUniformsBinding = 0;
+
+    // Lights of the frame packed in a uniform buffer, so that programs declaring the block draw all of them in one pass
+    // Must match the std140 layout of the LightArrayUniforms block in the shaders
+    static const unsigned int MaxArrayLights = 8;
+    struct LightArrayUniforms
+    {
+        struct LightUniforms
+        {
+            glm::vec4 color;
+            glm::vec4 position;
+            glm::vec4 direction;
+            glm::vec4 attenuation;
+        };
+        // Number of lights in x
+        glm::ivec4 lightCount;
+        LightUniforms lights[MaxArrayLights];
+    };
+    static_assert(sizeof(LightArrayUniforms) == 16 + MaxArrayLights * 64, "LightArrayUniforms must follow the std140 layout");
+
+    // Binding point of the LightArrayUniforms block. Binding 1 is used by the light clusters
+    static const GLuint LightArrayUniformsBinding = 2;
+
 public:
     Renderer(DeviceGL& device);
 
     const DeviceGL& GetDevice() const { return m_device; }
     DeviceGL& GetDevice() { return m_device; }
 
+    // Workers used by the renderer, also available to the passes for their own CPU work
+    ThreadPool& GetThreadPool() { return m_threadPool; }
+
     int AddRenderPass(std::unique_ptr<RenderPass> renderPass);
 
     bool HasCamera() const;
@@ -82,16 +193,91 @@ public:
     std::shared_ptr<const FramebufferObject> GetCurrentFramebuffer() const;
     void SetCurrentFramebuffer(std::shared_ptr<const FramebufferObject> framebuffer);
 
+    // Time in seconds, uploaded with the frame uniforms
+    float GetTime() const { return m_frameUniforms.time; }
+    void SetTime(float time) { m_frameUniforms.time = time; }
+
+    // Values uploaded for the current frame. Only valid during Render
+    const FrameUniforms& GetFrameUniforms() const { return m_frameUniforms; }
+
     std::span<const Light* const> GetLights() const;
     void AddLight(const Light& light);
 
     std::span<const DrawcallInfo> GetDrawcalls(unsigned int collectionIndex) const;
+    // Models are culled against the camera frustum when rendering, and then added to the drawcall collections
     void AddModel(const Model& model, const glm::mat4& worldMatrix);
 
+    // Static models stay registered between frames. Their drawcalls are filtered and sorted once, and only culled every frame
+    // If a transform is provided, the world matrix is updated when the transform changes
+    StaticModelId AddStaticModel(const Model& model, const glm::mat4& worldMatrix);
+    StaticModelId AddStaticModel(const Model& model, std::shared_ptr<const Transform> transform);
+    void SetStaticModelWorldMatrix(StaticModelId staticModelId, const glm::mat4& worldMatrix);
+    void RemoveStaticModel(StaticModelId staticModelId);
+    // Rebuild the static drawcalls in the next frame. Needed if the materials of the static models change
+    void InvalidateStaticDrawcalls() { m_staticDrawcallsDirty = true; ++m_staticModelsVersion; }
+    // Changes every time static models are added, removed or moved, so passes can keep what they render from them
+    uint64_t GetStaticModelsVersion() const { return m_staticModelsVersion; }
+
+    // Opaque drawcalls writing depth that intersect the bounds, to render the shadows of a light. Only valid during Render
+    // Static casters come from the static models, and dynamic ones from the models added this frame. They are not culled by the camera
+    void GetShadowCasters(const FrustumBounds& bounds, bool staticCasters, std::vector<DrawcallInfo>& drawcallInfos) const;
+
+    bool IsFrustumCullingEnabled() const { return m_frustumCullingEnabled; }
+    void SetFrustumCullingEnabled(bool enabled) { m_frustumCullingEnabled = enabled; }
+    const CullingStats& GetCullingStats() const { return m_cullingStats; }
+
+    // Occluders hide the models behind them, after frustum culling. They are rasterized on the CPU before culling
+    // Like models, they are only kept for the current frame
+    void AddOccluder(const OccluderMesh& occluder, const glm::mat4& worldMatrix);
+    bool IsOcclusionCullingEnabled() const { return m_occlusionCullingEnabled; }
+    void SetOcclusionCullingEnabled(bool enabled) { m_occlusionCullingEnabled = enabled; }
+    const OcclusionCuller& GetOcclusionCuller() const { return m_occlusionCuller; }
+    OcclusionCuller& GetOcclusionCuller() { return m_occlusionCuller; }
+
+    // Submeshes with levels of detail are drawn with the level that the model selects for their screen size
+    // Static models keep their level until the size passes the threshold by the hysteresis fraction, to avoid popping back and forth
+    bool IsLodSelectionEnabled() const { return m_lodSelectionEnabled; }
+    void SetLodSelectionEnabled(bool enabled) { m_lodSelectionEnabled = enabled; }
+    float GetLodHysteresis() const { return m_lodHysteresis; }
+    void SetLodHysteresis(float hysteresis) { m_lodHysteresis = hysteresis; }
+
+    // Static opaque drawcalls with instanced programs and an EBO can be culled on the GPU instead, every frame before the passes
+    // They are tested against the frustum, and against the depth of the previous frame if there is a HiZRenderPass
+    // Passes draw them with PrepareGpuDrawcall and DrawGpuDrawcall. Only active if the context supports it (OpenGL 4.3)
+    bool IsGpuCullingEnabled() const { return m_gpuCullingEnabled; }
+    void SetGpuCullingEnabled(bool enabled);
+    bool IsGpuCullingActive() const;
+    const GpuCuller& GetGpuCuller() const { return m_gpuCuller; }
+    GpuCuller& GetGpuCuller() { return m_gpuCuller; }
+
+    // Indirect drawcalls of the collection. Each one draws the visible instances of several static drawcalls with the same material and VAO
+    unsigned int GetGpuDrawcallCount(unsigned int collectionIndex) const;
+    // Like PrepareDrawcall, and also points the instance attribute to the culled world matrices. Returns the drawcall of the first instance
+    const DrawcallInfo& PrepareGpuDrawcall(unsigned int collectionIndex, unsigned int index, Material::OverrideFlags materialOverride = Material::NoOverride);
+    void DrawGpuDrawcall(unsigned int collectionIndex, unsigned int index) const;
+
+    // Stats of the last frame rendered, and an overlay that shows them
+    const FrameStats& GetFrameStats() const { return m_frameStats; }
+    void DrawFrameStatsGUI(DearImGui& imGui) const;
+
+    // GPU time of each render pass, read a few frames after it was rendered
+    const RenderPassTimers& GetPassTimers() const { return m_passTimers; }
+    RenderPassTimers& GetPassTimers() { return m_passTimers; }
+
     unsigned int AddDrawcallCollection(const DrawcallSupportedFunction &drawcallSupportedFunction);
     void SetDrawcallCollectionSupportedFunction(unsigned int index, const DrawcallSupportedFunction& drawcallSupportedFunction);
 
+    // Sort the collection with a custom function instead of the sort key, until the end of the frame
     void SortDrawcallCollection(unsigned int index, const DrawcallSortFunction& drawcallSortFunction);
+
+    // Draw the depth of the opaque drawcalls of the collection in a pre-pass, and then shade only the visible fragments
+    // Requires a DepthPrePassRenderPass for the collection before the passes that draw it
+    bool IsDepthPrePassEnabled(unsigned int collectionIndex) const;
+    void SetDepthPrePassEnabled(unsigned int collectionIndex, bool enabled);
+    // Drawcalls in the pre-pass: opaque and writing depth. Materials that discard fragments must not use a collection with the pre-pass
+    static bool IsInDepthPrePass(const DrawcallInfo& drawcallInfo);
+    // Use after preparing a drawcall in the pre-pass with OverrideDepthTest: pass only the fragments that wrote the depth
+    void SetDepthPrePassRenderStates();
     bool IsBackToFront(const DrawcallInfo& a, const DrawcallInfo& b) const;
     bool IsFrontToBack(const DrawcallInfo& a, const DrawcallInfo& b) const;
 
@@ -101,31 +287,114 @@ public:
         const UpdateTransformsFunction& updateTransformFunction,
         const UpdateLightsFunction& updateLightsFunction);
 
-    void UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& worldMatrix, bool cameraChanged = true) const;
-    void UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, unsigned int worldMatrixIndex, bool cameraChanged = true) const;
+    // Hooks are found with the id of the shader program, so they can be called for every drawcall and light
+    void UpdateTransforms(const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, bool cameraChanged = true) const;
+    void UpdateTransforms(const ShaderProgram& shaderProgram, unsigned int worldMatrixIndex, bool cameraChanged = true) const;
 
+    // Programs declaring the LightArrayUniforms block draw all the lights in a single pass if they fit in the array,
+    // and one pass per light otherwise. The other programs always use one pass per light
     UpdateLightsFunction GetDefaultUpdateLightsFunction(const ShaderProgram& shaderProgram);
-    bool UpdateLights(std::shared_ptr<const ShaderProgram> shaderProgramPtr, std::span<const Light* const> lights, unsigned int& lightIndex) const;
+    bool UpdateLights(const ShaderProgram& shaderProgram, std::span<const Light* const> lights, unsigned int& lightIndex) const;
 
     void PrepareDrawcall(const DrawcallInfo& drawcallInfo, Material::OverrideFlags materialOverride = Material::NoOverride);
 
+    // Prepare the first drawcall and, if its shader program supports instancing, merge the following drawcalls
+    // with the same material, VAO and drawcall. Returns the number of drawcalls merged, to be drawn as instances
+    unsigned int PrepareInstancedDrawcall(std::span<const DrawcallInfo> drawcallInfos, Material::OverrideFlags materialOverride = Material::NoOverride);
+
+    bool IsInstancingSupported(const ShaderProgram& shaderProgram) const;
+
+    // Stream the world matrices of the instances for the bound VAO, for programs with the instance world matrix attribute
+    void SetInstanceWorldMatrices(const VertexArrayObject& vao, std::span<const glm::mat4> worldMatrices);
+
     void SetLightingRenderStates(bool firstPass);
 
+    const glm::mat4& GetWorldMatrix(const DrawcallInfo& drawcallInfo) const;
+
+    // Distance from the camera plane to the drawcall origin, positive in front of the camera
+    float GetViewDepth(const DrawcallInfo& drawcallInfo) const;
+
     void Render();
 
 private:
     void Reset();
 
+    const glm::mat4& GetWorldMatrix(unsigned int worldMatrixIndex) const;
     void InitializeFullscreenMesh();
 
-    const glm::mat4& GetWorldMatrix(const DrawcallInfo& drawcallInfo) const;
+    // Add the submeshes of the models that intersect the camera frustum to the drawcall collections
+    // Models are split in tasks for the worker threads, and their results are merged in the same order as the models
+    void CullModels();
+
+    // Drawcalls and stats produced by one culling task, kept between frames to reuse the memory
+    struct CullingBucket
+    {
+        std::vector<std::vector<DrawcallInfo>> drawcallInfos;
+        CullingStats stats;
+    };
+    void CullModels(unsigned int begin, unsigned int end, const FrustumBounds& frustum, CullingBucket& bucket) const;
+
+    // Level of detail of a submesh for the current camera, starting from the level of the previous frame
+    unsigned int SelectLod(const Model& model, unsigned int submeshIndex, const glm::mat4& worldMatrix, unsigned int previousLod, float hysteresis) const;
+
+    // Compute the sort keys of all drawcalls with the current camera and sort the collections
+    void SortDrawcalls();
+    uint64_t ComputeSortKey(const DrawcallInfo& drawcallInfo, float viewDepth) const;
+    // Order of the sort keys ignoring the depth of opaque drawcalls, used to merge the static drawcalls
+    static bool IsStateSortedBefore(const DrawcallInfo& a, const DrawcallInfo& b);
+
+    // Update the static world matrices from their transforms, and rebuild the static drawcalls if needed
+    void UpdateStaticModels();
+    void BuildStaticDrawcalls();
+    // Group the static drawcalls that can be culled on the GPU in draw commands, and the commands in indirect drawcalls
+    void BuildGpuDrawcalls();
+    void UploadGpuInstances();
+    bool IsGpuCullingSupported(const DrawcallInfo& drawcallInfo, const Mesh& mesh, unsigned int submeshIndex) const;
+    // Point the instance world matrix attribute of the VAO to the buffer
+    void SetInstanceAttributes(const VertexArrayObject& vao, const VertexBufferObject& buffer);
+    void CullStaticDrawcalls(const FrustumBounds& frustum);
+    // Cached drawcall of a static submesh, with the level of detail selected this frame
+    DrawcallInfo GetStaticDrawcallInfo(unsigned int staticDrawcallIndex) const;
+
+    // Compute the frame uniforms from the current camera and upload them, once per frame
+    void UpdateFrameUniforms();
+
+    // Upload the lights of the frame to the light array, if they fit in it
+    void UpdateLightArrayUniforms();
+    // True if the light array has exactly these lights, so they can be drawn in a single pass
+    bool IsLightArrayUploaded(std::span<const Light* const> lights) const;
+
+    // Check if the current camera is different from the last one uploaded to the shader program, and remember it
+    bool UpdateCameraState(const ShaderProgram& shaderProgram);
+
+    struct RegisteredShaderProgram;
+    // Returns nullptr if the shader program was not registered
+    const RegisteredShaderProgram* FindShaderProgram(const ShaderProgram& shaderProgram) const;
 
 private:
     DeviceGL& m_device;
 
     const Camera *m_currentCamera;
 
-    std::shared_ptr<const Material> m_currentMaterial;
+    // Material with the uniforms currently set, to skip Material::Use for consecutive drawcalls. Reset on every pass
+    const Material* m_currentMaterial;
+
+    // Camera matrices last uploaded to each shader program this frame, indexed by shader program id
+    struct CameraState
+    {
+        glm::mat4 viewMatrix;
+        glm::mat4 projectionMatrix;
+        bool valid = false;
+    };
+    std::vector<CameraState> m_cameraStates;
+
+    FrameUniforms m_frameUniforms;
+    UniformBufferObject m_frameUniformBuffer;
+
+    LightArrayUniforms m_lightArrayUniforms;
+    UniformBufferObject m_lightArrayUniformBuffer;
+    // False if the lights of the frame didn't fit in the array
+    bool m_lightArrayUploaded;
 
     std::shared_ptr<const FramebufferObject> m_defaultFramebuffer;
     std::shared_ptr<const FramebufferObject> m_currentFramebuffer;
@@ -134,12 +403,99 @@ private:
 
     std::vector<glm::mat4> m_worldMatrices;
 
+    // Static models, indexed by their id. Removed models leave an empty slot to be reused
+    struct StaticModel
+    {
+        const Model* model;
+        std::shared_ptr<const Transform> transform;
+        uint64_t transformVersion;
+    };
+    std::vector<StaticModel> m_staticModels;
+    std::vector<StaticModelId> m_freeStaticModelIds;
+    uint64_t m_staticModelsVersion;
+
+    // World matrices of static models, indexed by id. Drawcalls refer to them with the static flag in the index
+    std::vector<glm::mat4> m_staticWorldMatrices;
+    static const unsigned int StaticWorldMatrixFlag = 1u << 31;
+
+    // Drawcalls of all static models, opaque ones sorted by state. Only rebuilt when they change
+    struct StaticDrawcall
+    {
+        DrawcallInfo drawcallInfo;
+        StaticModelId staticModelId;
+        unsigned int submeshIndex;
+        // Draw command in the GPU culler, or NoGpuCommand if it is culled on the CPU
+        unsigned int gpuCommandIndex;
+    };
+    static const unsigned int NoGpuCommand = ~0u;
+    std::vector<StaticDrawcall> m_staticDrawcalls;
+    // Indices of the static drawcalls supported by each collection, in the cached order
+    std::vector<std::vector<unsigned int>> m_staticDrawcallIndices;
+    // Result of culling each static drawcall this frame
+    enum StaticVisibility : uint8_t { Visible, Culled, Occluded, GpuCulled };
+    std::vector<uint8_t> m_staticDrawcallVisible;
+    // Level of detail of each static drawcall, kept between frames for the hysteresis
+    std::vector<uint8_t> m_staticDrawcallLods;
+    std::vector<DrawcallInfo> m_visibleStaticDrawcalls;
+    bool m_staticDrawcallsDirty;
+
+    // Models added this frame, with the index of their world matrix
+    std::vector<std::pair<const Model*, unsigned int>> m_models;
+
+    bool m_frustumCullingEnabled;
+    bool m_occlusionCullingEnabled;
+    OcclusionCuller m_occlusionCuller;
+
+    bool m_lodSelectionEnabled;
+    float m_lodHysteresis;
+
+    bool m_gpuCullingEnabled;
+    GpuCuller m_gpuCuller;
+    std::vector<GpuCuller::DrawCommand> m_gpuDrawCommands;
+    std::vector<GpuCuller::Instance> m_gpuInstances;
+    // Instances must be uploaded again when the static drawcalls or their world matrices change
+    bool m_gpuInstancesDirty;
+    // Consecutive draw commands with the same material and VAO, drawn with a single indirect drawcall
+    struct GpuDrawcall
+    {
+        DrawcallInfo drawcallInfo;
+        unsigned int firstCommand;
+        unsigned int commandCount;
+    };
+    std::vector<std::vector<GpuDrawcall>> m_gpuDrawcalls;
+    CullingStats m_cullingStats;
+    FrameStats m_frameStats;
+
+    // Workers for the CPU side of the frame preparation. They never call OpenGL
+    // Small tasks cost more to schedule than to run, so they have a minimum size
+    ThreadPool m_threadPool;
+    static const unsigned int MinModelsPerCullingTask = 256;
+    static const unsigned int MinDrawcallsPerSortTask = 1024;
+    std::vector<CullingBucket> m_cullingBuckets;
+
     std::vector<DrawcallCollection> m_drawcallCollections;
 
-    std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateTransformsFunction> m_updateTransformsFunctions;
-    std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateLightsFunction> m_updateLightsFunctions;
+    // Hooks of the registered shader programs, indexed by shader program id. Unregistered ids have a null program
+    struct RegisteredShaderProgram
+    {
+        // Keeps the program alive while its hooks can be called
+        std::shared_ptr<const ShaderProgram> shaderProgram;
+        UpdateTransformsFunction updateTransformsFunction;
+        UpdateLightsFunction updateLightsFunction;
+        // Reads the world matrix from the instance buffer
+        bool instanced = false;
+    };
+    std::vector<RegisteredShaderProgram> m_shaderPrograms;
+
+    // Per-instance world matrices, streamed before every instanced drawcall
+    VertexBufferObject m_instanceBuffer;
+    std::vector<glm::mat4> m_instanceWorldMatrices;
+
+    // VAOs that already have the instance attributes set up this frame
+    std::unordered_set<const VertexArrayObject*> m_instancedVAOs;
 
     Mesh m_fullscreenMesh;
 
     std::vector<std::unique_ptr<RenderPass>> m_passes;
+    RenderPassTimers m_passTimers;
 };
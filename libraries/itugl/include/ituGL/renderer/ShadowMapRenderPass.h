@@ -0,0 +1,181 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/UniformBufferObject.h>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class DirectionalLight;
+class Texture2DObject;
+class FramebufferObject;
+class VertexArrayObject;
+class Drawcall;
+
+// Cascaded shadow maps of a directional light, in the tiles of a depth atlas
+// Each cascade covers a region around a slice of the view frustum. The region only moves when the slice leaves it,
+// so the depth of the static models is rendered once into a cache and reused while the light and the static models don't change
+// Updating a cascade copies its cached tile to the atlas and draws the dynamic models on top. Cascades without dynamic casters
+// keep their tile, and farther cascades can be updated less often, so the cost of a frame follows the dynamic content
+// Add it before the passes that read the shadows. Their programs must be set up with SetupShaderProgram
+class ShadowMapRenderPass : public RenderPass
+{
+public:
+    static const unsigned int MaxCascades = 4;
+
+    // Values used by the shaders to find the shadow of a position
+    // Must match the std140 layout of the ShadowUniforms block in the shaders
+    struct ShadowUniforms
+    {
+        // World space to the texture coordinates and depth of each cascade in the atlas
+        glm::mat4 cascadeMatrices[MaxCascades];
+        // Far view depth of each cascade
+        glm::vec4 cascadeSplits;
+        // World size of a texel in each cascade, to offset the positions along the normal
+        glm::vec4 cascadeTexelSizes;
+        // Direction of the light in xyz, and number of cascades in w. No shadows if it is 0
+        glm::vec4 lightDirection;
+    };
+    static_assert(sizeof(ShadowUniforms) == MaxCascades * 64 + 48, "ShadowUniforms must follow the std140 layout");
+
+    // Binding point of the ShadowUniforms block. Binding 1 is used by the light clusters and 2 by the light array
+    static const GLuint ShadowUniformsBinding = 3;
+
+    // Work done by the last frame
+    struct Stats
+    {
+        unsigned int updatedCascades = 0;
+        // Cascades that rendered the static casters again, after the cache was invalidated or the region moved
+        unsigned int staticCascades = 0;
+        unsigned int staticDrawcalls = 0;
+        unsigned int dynamicDrawcalls = 0;
+    };
+
+public:
+    ShadowMapRenderPass(std::shared_ptr<const DirectionalLight> light, int cascadeResolution = 1024, unsigned int cascadeCount = MaxCascades);
+    ~ShadowMapRenderPass();
+
+    void Render() override;
+
+    const char* GetName() const override { return "ShadowMap"; }
+
+    // While disabled, nothing is rendered and the shaders skip the shadows
+    bool IsEnabled() const { return m_enabled; }
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    // Views beyond this distance from the camera have no shadows
+    float GetMaxDistance() const { return m_maxDistance; }
+    void SetMaxDistance(float maxDistance) { m_maxDistance = maxDistance; }
+
+    // Casters between the light and the regions are included up to this distance
+    float GetCasterDistance() const { return m_casterDistance; }
+    void SetCasterDistance(float casterDistance) { m_casterDistance = casterDistance; }
+
+    // Frames between the updates of the dynamic casters of a cascade. Farther cascades have bigger texels, so the delay shows less
+    unsigned int GetUpdateInterval(unsigned int cascadeIndex) const { return m_cascades[cascadeIndex].updateInterval; }
+    void SetUpdateInterval(unsigned int cascadeIndex, unsigned int interval);
+
+    // Without the cache, the static casters are drawn again on every update. Useful to compare the cost
+    bool IsStaticCacheEnabled() const { return m_staticCacheEnabled; }
+    void SetStaticCacheEnabled(bool enabled) { m_staticCacheEnabled = enabled; }
+
+    // Render all the cascades again in the next frame
+    void Invalidate();
+
+    unsigned int GetCascadeCount() const { return m_cascadeCount; }
+
+    // Depth atlas with all the cascades, set to compare the depth, for sampler2DShadow
+    std::shared_ptr<const Texture2DObject> GetShadowMapTexture() const { return m_shadowMapTexture; }
+
+    const Stats& GetStats() const { return m_stats; }
+
+    // Assign the ShadowUniforms block of the shader program to its binding point
+    // Block bindings are stored in the program, so this is only needed once per program
+    static void SetupShaderProgram(const ShaderProgram& shaderProgram);
+
+private:
+    struct Cascade
+    {
+        // Region around the slice of the view frustum, in light space, and the view projection matrix that covers it
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+        glm::mat4 viewProjMatrix = glm::mat4(1.0f);
+
+        unsigned int updateInterval = 1;
+        // The static casters of the region are in the cache
+        bool staticValid = false;
+        // The tile in the atlas has dynamic casters, that must be removed even if there are none now
+        bool hasDynamicCasters = false;
+    };
+
+    void InitializeShaderProgram();
+
+    // Move the region of the cascade if the sphere around its slice is not inside anymore. Returns true if it moved
+    bool UpdateCascadeRegion(Cascade& cascade, const glm::vec3& sliceCenter, float sliceRadius);
+
+    // Light space projection of the region. The caster projection also includes the casters in front of it, for culling
+    glm::mat4 ComputeProjectionMatrix(const Cascade& cascade, float casterDistance) const;
+
+    void SetTileViewport(unsigned int cascadeIndex, bool clear);
+    void DrawCasters(std::span<const Renderer::DrawcallInfo> drawcallInfos, const glm::mat4& viewProjMatrix);
+
+    void UploadUniforms(unsigned int cascadeCount);
+
+private:
+    std::shared_ptr<const DirectionalLight> m_light;
+    int m_cascadeResolution;
+    unsigned int m_cascadeCount;
+    // Tiles of the atlas in x and y
+    int m_tileCountX;
+    int m_tileCountY;
+
+    bool m_enabled;
+    bool m_staticCacheEnabled;
+    float m_maxDistance;
+    float m_casterDistance;
+    // Extra size of the regions, relative to the slices. Bigger regions move less often but have bigger texels
+    float m_regionMargin;
+
+    std::array<Cascade, MaxCascades> m_cascades;
+    std::array<float, MaxCascades> m_cascadeSplits;
+
+    // Light and static models that the cache was rendered with
+    glm::vec3 m_lightDirection;
+    glm::mat4 m_lightViewMatrix;
+    uint64_t m_staticModelsVersion;
+    unsigned int m_frameIndex;
+
+    // Depth of the static casters, copied to the atlas before drawing the dynamic ones
+    std::shared_ptr<Texture2DObject> m_staticCacheTexture;
+    std::shared_ptr<FramebufferObject> m_staticCacheFramebuffer;
+    std::shared_ptr<Texture2DObject> m_shadowMapTexture;
+    std::shared_ptr<FramebufferObject> m_shadowMapFramebuffer;
+
+    ShadowUniforms m_uniforms;
+    UniformBufferObject m_uniformBuffer;
+
+    // Position only program, drawing the casters as instances
+    std::shared_ptr<ShaderProgram> m_shaderProgram;
+    ShaderProgram::Location m_viewProjMatrixLocation;
+
+    // Casters of the cascade being updated, and the instances they are grouped in. Kept between frames to reuse the memory
+    std::vector<Renderer::DrawcallInfo> m_staticCasters;
+    std::vector<Renderer::DrawcallInfo> m_dynamicCasters;
+    struct InstanceGroup
+    {
+        const VertexArrayObject* vao;
+        const Drawcall* drawcall;
+        std::vector<glm::mat4> worldMatrices;
+    };
+    std::vector<InstanceGroup> m_instanceGroups;
+    std::unordered_map<const Drawcall*, unsigned int> m_instanceGroupIndices;
+
+    Stats m_stats;
+};
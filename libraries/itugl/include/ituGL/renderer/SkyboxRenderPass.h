@@ -10,13 +10,15 @@ class TextureCubemapObject;
 class SkyboxRenderPass : public RenderPass
 {
 public:
-    SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture);
+    SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture, std::shared_ptr<const FramebufferObject> targetFramebuffer = nullptr);
 
     std::shared_ptr<TextureCubemapObject> GetTexture() const;
     void SetTexture(std::shared_ptr<TextureCubemapObject> texture);
 
     void Render() override;
 
+    const char* GetName() const override { return "Skybox"; }
+
 private:
     std::shared_ptr<TextureCubemapObject> m_texture;
 
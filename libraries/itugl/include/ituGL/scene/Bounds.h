@@ -1,7 +1,11 @@
 #pragma once
 
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 #include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <array>
+#include <cassert>
 
 class Bounds
 {
@@ -91,6 +95,8 @@ class BoxBounds : public RotatedBounds
 public:
     BoxBounds(const glm::vec3& center, const glm::mat3& rotationMatrix, const glm::vec3& size) : RotatedBounds(center, rotationMatrix), m_size(size) {}
     BoxBounds(const Bounds& bounds);
+    // Box containing the AABB after being transformed by the matrix. Used to get world space bounds from local space
+    BoxBounds(const AabbBounds& bounds, const glm::mat4& transformMatrix);
 
     inline Type GetType() const override { return Type::Box; }
 
@@ -103,21 +109,34 @@ private:
     glm::vec3 m_size;
 };
 
-class FrustumBounds : public RotatedBounds
+class FrustumBounds : public Bounds
 {
 public:
-    FrustumBounds(const glm::vec3& center, const glm::vec3& size);
+    // Extract the 6 planes of the frustum from a (view) projection matrix
+    FrustumBounds(const glm::mat4& viewProjMatrix);
 
     inline Type GetType() const override { return Type::Frustum; }
 
+    // Planes as (normal, distance), normalized and with the normal pointing inside the frustum
+    // Order is left, right, bottom, top, near, far
+    inline const std::array<glm::vec4, 6>& GetPlanes() const { return m_planes; }
+
+    // Signed distance from a point to a plane, positive inside
+    inline float GetDistance(int planeIndex, const glm::vec3& point) const
+    {
+        const glm::vec4& plane = m_planes[planeIndex];
+        return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+    }
+
 private:
+    std::array<glm::vec4, 6> m_planes;
 };
 
 
 template<typename T>
 bool Bounds::Intersects(const T& other) const
 {
-    Bounds::Intersects(this, other);
+    return Bounds::Intersects(*this, other);
 }
 
 template<typename TA, typename TB>
@@ -144,6 +163,8 @@ bool Bounds::Intersects(const Bounds& boundsA, const TB& boundsB)
         return Bounds::Intersects(static_cast<const AabbBounds&>(boundsA), boundsB);
     case Type::Box:
         return Bounds::Intersects(static_cast<const BoxBounds&>(boundsA), boundsB);
+    case Type::Frustum:
+        return Bounds::Intersects(static_cast<const FrustumBounds&>(boundsA), boundsB);
     default:
         assert(false);
         return false;
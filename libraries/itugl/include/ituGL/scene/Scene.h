@@ -1,11 +1,13 @@
 #pragma once
 
+#include <ituGL/scene/SceneBvh.h>
 #include <unordered_map>
 #include <string>
 #include <memory>
 
 class SceneNode;
 class SceneVisitor;
+class Bounds;
 
 class Scene
 {
@@ -23,6 +25,22 @@ public:
     void AcceptVisitor(SceneVisitor& visitor);
     void AcceptVisitor(SceneVisitor& visitor) const;
 
+    // Visit only the nodes whose bounds intersect the query bounds, using the spatial index
+    // The non-const version refits the index first. The const one uses the bounds of the last refit
+    void AcceptVisitor(SceneVisitor& visitor, const Bounds& bounds);
+    void AcceptVisitor(SceneVisitor& visitor, const Bounds& bounds) const;
+
+    // Update the spatial index with the nodes that moved since the last call
+    void UpdateSpatialIndex();
+
+    // Recompute the bounds of the node in the next update, for changes that don't come from the transform
+    void InvalidateSceneNodeBounds(const SceneNode& node);
+
+    inline const SceneBvh& GetSpatialIndex() const { return m_bvh; }
+
 private:
     std::unordered_map<std::string, std::shared_ptr<SceneNode>> m_nodes;
+
+    // Spatial index with the bounds of all the nodes
+    SceneBvh m_bvh;
 };
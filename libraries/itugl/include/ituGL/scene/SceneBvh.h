@@ -0,0 +1,115 @@
+#pragma once
+
+#include <ituGL/scene/Bounds.h>
+#include <glm/vec3.hpp>
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <memory>
+
+class SceneNode;
+class Transform;
+
+// Bounding volume hierarchy over the world AABB of the scene nodes
+// It is a dynamic tree: nodes are inserted and removed incrementally, and leaves store an enlarged AABB
+// so that small movements don't require changing the tree
+// The transforms of the nodes report their changes, so refitting only visits the nodes that moved
+class SceneBvh
+{
+public:
+    using QueryFunction = std::function<void(SceneNode& sceneNode)>;
+    using RayQueryFunction = std::function<void(SceneNode& sceneNode, float distance)>;
+
+public:
+    SceneBvh();
+    ~SceneBvh();
+
+    // The transforms keep functions that reference this object, so it can't be copied
+    SceneBvh(const SceneBvh&) = delete;
+    SceneBvh& operator=(const SceneBvh&) = delete;
+
+    // Add or remove a scene node. Nodes are referenced, not owned
+    void AddSceneNode(SceneNode& sceneNode);
+    void RemoveSceneNode(const SceneNode& sceneNode);
+    bool ContainsSceneNode(const SceneNode& sceneNode) const;
+
+    // Force the bounds of a node to be recomputed in the next refit, for changes not coming from the transform
+    void InvalidateSceneNode(const SceneNode& sceneNode);
+
+    // Update the leaves that changed since the last refit. Returns how many leaves were moved in the tree
+    unsigned int Refit();
+
+    // Call the function for every node whose bounds intersect the query bounds (sphere, AABB, box or frustum)
+    void Query(const Bounds& bounds, const QueryFunction& function) const;
+
+    // Call the function for every node whose bounds are crossed by the ray, with the distance to the entry point
+    void QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayQueryFunction& function) const;
+
+    // Find the closest node crossed by the ray. Returns nullptr if nothing is found
+    SceneNode* Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const;
+
+    // Extra size added to each side of the leaf bounds, relative to the size of the bounds (at least one unit)
+    inline float GetMargin() const { return m_margin; }
+    inline void SetMargin(float margin) { m_margin = margin; }
+
+    inline unsigned int GetSceneNodeCount() const { return static_cast<unsigned int>(m_leaves.size()); }
+
+    // Height of the tree, for debugging the balance
+    unsigned int GetHeight() const;
+
+private:
+    using NodeIndex = int;
+    static const NodeIndex NullIndex = -1;
+
+    struct Node
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+        NodeIndex parent;
+        NodeIndex left;
+        NodeIndex right;
+        // Only for leaves
+        SceneNode* sceneNode;
+        glm::vec3 tightMin;
+        glm::vec3 tightMax;
+
+        inline bool IsLeaf() const { return left == NullIndex; }
+    };
+
+    struct LeafInfo
+    {
+        NodeIndex nodeIndex;
+        // Transform that reports the changes of the node. Kept alive until the function is removed from it
+        std::shared_ptr<const Transform> transform;
+        // Already in the list of dirty nodes
+        bool dirty;
+    };
+
+    void SetLeafTransform(const SceneNode& sceneNode, LeafInfo& info, std::shared_ptr<const Transform> transform);
+    void MarkDirty(const SceneNode& sceneNode, LeafInfo& info);
+
+    NodeIndex AllocateNode();
+    void FreeNode(NodeIndex index);
+
+    // Returns true if the leaf had to be moved in the tree
+    bool UpdateLeafBounds(NodeIndex leafIndex, const AabbBounds& bounds);
+    void InsertLeaf(NodeIndex leafIndex);
+    void RemoveLeaf(NodeIndex leafIndex);
+    void RefitAncestors(NodeIndex index);
+
+    unsigned int GetHeight(NodeIndex index) const;
+
+    static float GetSurfaceArea(const glm::vec3& min, const glm::vec3& max);
+    static bool IntersectsRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance);
+
+private:
+    std::vector<Node> m_nodes;
+    NodeIndex m_root;
+    NodeIndex m_freeList;
+
+    std::unordered_map<const SceneNode*, LeafInfo> m_leaves;
+    // Nodes to update in the next refit
+    std::vector<const SceneNode*> m_dirtyNodes;
+
+    float m_margin;
+};
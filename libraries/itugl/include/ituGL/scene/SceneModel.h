@@ -4,6 +4,7 @@
 //#include <ituGL/renderer/Renderable.h>
 
 class Model;
+class OccluderMesh;
 
 class SceneModel : public SceneNode//, public Renderable
 {
@@ -14,6 +15,10 @@ public:
     std::shared_ptr<Model> GetModel() const;
     void SetModel(std::shared_ptr<Model> model);
 
+    // Optional simplified mesh, in the same space as the model, that hides what is behind it
+    std::shared_ptr<const OccluderMesh> GetOccluder() const;
+    void SetOccluder(std::shared_ptr<const OccluderMesh> occluder);
+
     //glm::mat4 GetWorldMatrix() const override;
     //int GetDrawcallCount() const override;
     //const Drawcall& GetDrawcall(int index, const VertexArrayObject*& vao, const Material*& material) const override;
@@ -27,4 +32,5 @@ public:
 
 private:
     std::shared_ptr<Model> m_model;
+    std::shared_ptr<const OccluderMesh> m_occluder;
 };
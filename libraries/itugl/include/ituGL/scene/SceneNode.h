@@ -38,6 +38,10 @@ private:
 
     Scene* m_scene;
 
+protected:
+    // Notify the owner scene that the bounds changed without changing the transform
+    void InvalidateBounds();
+
 protected:
     std::string m_name;
     std::shared_ptr<Transform> m_transform;
@@ -3,23 +3,36 @@
 #include <glm/vec3.hpp>
 #include <glm/mat4x4.hpp>
 #include <memory>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <cstdint>
 
 class Transform
 {
+public:
+    // Function called when this transform or any of its parents is modified
+    using ChangedFunction = std::function<void()>;
+
 public:
     Transform();
+    ~Transform();
+
+    // Parents keep track of their children, so transforms can't be copied
+    Transform(const Transform&) = delete;
+    Transform& operator=(const Transform&) = delete;
 
     inline glm::vec3 GetTranslation() const { return m_translation; }
-    inline void SetTranslation(const glm::vec3& translation) { m_translation = translation; m_dirty = true; }
+    inline void SetTranslation(const glm::vec3& translation) { m_translation = translation; SetDirty(); }
 
     inline glm::vec3 GetRotation() const { return m_rotation; }
-    inline void SetRotation(const glm::vec3& rotation) { m_rotation = rotation; m_dirty = true; }
+    inline void SetRotation(const glm::vec3& rotation) { m_rotation = rotation; SetDirty(); }
 
     inline glm::vec3 GetScale() const { return m_scale; }
-    inline void SetScale(const glm::vec3& scale) { m_scale = scale; m_dirty = true; }
+    inline void SetScale(const glm::vec3& scale) { m_scale = scale; SetDirty(); }
 
     inline std::shared_ptr<Transform> GetParent() const { return m_parent; }
-    inline void SetParent(std::shared_ptr<Transform> parent) { m_parent = parent; m_dirty = true; }
+    void SetParent(std::shared_ptr<Transform> parent);
 
     glm::mat4 GetTranslationMatrix() const;
     glm::mat4 GetRotationMatrix() const;
@@ -29,14 +42,35 @@ public:
 
     bool IsDirty() const;
 
+    // Version that changes every time this transform or any of its parents is modified
+    // Unlike IsDirty, it is not reset when the matrix is computed, so several systems can track changes
+    uint64_t GetVersion() const;
+
+    // Let other systems track the changes without polling every transform, like the spatial index of the scene
+    // The key identifies the function, to remove it later
+    void AddChangedFunction(const void* key, ChangedFunction function) const;
+    void RemoveChangedFunction(const void* key) const;
+
+private:
+    void SetDirty();
+    void NotifyChanged() const;
+
 private:
     glm::vec3 m_translation;
     glm::vec3 m_rotation;
     glm::vec3 m_scale;
 
     std::shared_ptr<Transform> m_parent;
+    // Transforms with this one as parent, to notify them. They keep this one alive, and remove themselves when destroyed
+    std::vector<Transform*> m_children;
+
+    mutable std::vector<std::pair<const void*, ChangedFunction>> m_changedFunctions;
 
     // Cached matrix
     mutable glm::mat4 m_matrix;
     mutable bool m_dirty;
+
+    // Last modification, taken from a global counter so it only grows, even when the parent changes
+    uint64_t m_version;
+    static uint64_t s_versionCounter;
 };
@@ -126,6 +126,9 @@ public:
     // You can skip depth, stencil or blending using the override flags
     void Use(OverrideFlags overrideFlags = OverrideFlags::NoOverride) const;
 
+    // Set only depth properties, stencil properties, and blending. Shader program and uniforms are not changed
+    void UseRenderStates(OverrideFlags overrideFlags = OverrideFlags::NoOverride) const;
+
 private:
     // Set all the properties relative to depth
     void UseDepthTest() const;
@@ -41,6 +41,10 @@ public:
     // Implements the Bind required by Object. Shaders and shader programs don't use Bind()
     void Bind() const override;
 
+    // Small index that identifies this shader program object, unlike GL handles they are consecutive
+    // Used to keep per-program data in flat arrays instead of maps
+    inline unsigned int GetId() const { return m_id; }
+
     // Build (Attach and link) a shader program with a compute shader
     bool Build(const Shader& computeShader);
 
@@ -84,6 +88,12 @@ public:
     // Find a uniform location by name
     Location GetUniformLocation(const char *name) const;
 
+    // Find a uniform block index by name. Returns GL_INVALID_INDEX if the block is not used
+    GLuint GetUniformBlockIndex(const char* name) const;
+
+    // Set the binding point where the uniform block reads its uniform buffer from
+    void SetUniformBlockBinding(GLuint blockIndex, GLuint bindingPoint) const;
+
     // Get how many uniforms exist in this shader program
     unsigned int GetUniformCount() const;
 
@@ -139,6 +149,9 @@ private:
     void SetUniforms(Location location, const T* values, GLsizei count) const;
 
 private:
+    unsigned int m_id;
+    static unsigned int s_idCounter;
+
 #ifndef NDEBUG
     inline bool IsUsed() const { return s_usedHandle == GetHandle(); }
     static Handle s_usedHandle;
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+
+// Shader Storage Buffer Object (SSBO) is a BufferObject that shaders can read and write, with arrays of any size
+// Requires OpenGL 4.3, mostly used by compute shaders
+class ShaderStorageBufferObject : public BufferObjectBase<BufferObject::ShaderStorageBuffer>
+{
+public:
+    ShaderStorageBufferObject();
+
+    // Use the same AllocateData and UpdateData methods from the base class
+    using BufferObject::AllocateData;
+    using BufferObject::UpdateData;
+    using BufferObject::BindBase;
+
+    // Bind the buffer to an indexed binding point, where the storage blocks access it
+    void BindBase(GLuint bindingPoint) const;
+};
@@ -24,6 +24,8 @@ public:
     // Get the shader program
     std::shared_ptr<ShaderProgram> GetShaderProgram();
     std::shared_ptr<const ShaderProgram> GetShaderProgram() const;
+    // Access without copying the shared pointer. The collection must have a shader program
+    inline const ShaderProgram& GetShaderProgramRef() const { return *m_shaderProgram; }
 
     // Reset the material with a different shader
     void ChangeShader(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms = NameSet());
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+#include <ituGL/core/Data.h>
+
+// Uniform Buffer Object (UBO) is a BufferObject that stores the values of a uniform block, shared by many shader programs
+class UniformBufferObject : public BufferObjectBase<BufferObject::UniformBuffer>
+{
+public:
+    UniformBufferObject();
+
+    // Use the same AllocateData and UpdateData methods from the base class
+    using BufferObject::AllocateData;
+    using BufferObject::UpdateData;
+
+    // Allocate the buffer with the contents of a struct. The struct must follow the std140 layout of the block
+    template<typename T>
+    void AllocateData(const T& data, Usage usage = Usage::DynamicDraw);
+
+    // Update the buffer with the contents of a struct
+    template<typename T>
+    void UpdateData(const T& data, size_t offsetBytes = 0);
+
+    // Bind the buffer to an indexed binding point, where the uniform blocks read their values from
+    void BindBase(GLuint bindingPoint) const;
+};
+
+
+// Call the base implementation with the data converted to bytes
+template<typename T>
+void UniformBufferObject::AllocateData(const T& data, Usage usage)
+{
+    AllocateData(Data::GetBytes(data), usage);
+}
+
+// Call the base implementation with the data converted to bytes
+template<typename T>
+void UniformBufferObject::UpdateData(const T& data, size_t offsetBytes)
+{
+    UpdateData(Data::GetBytes(data), offsetBytes);
+}
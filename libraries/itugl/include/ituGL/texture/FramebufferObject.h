@@ -31,11 +31,17 @@ public:
 
     void SetDrawBuffers(std::span<const Attachment> attachments);
 
+    // Framebuffer used when no other is bound. It is the one of the window, unless it is replaced
     static std::shared_ptr<const FramebufferObject> GetDefault();
+    // Replace the default framebuffer, for example to render offscreen. Unbind binds it instead of the window framebuffer
+    // Set to null to restore the window framebuffer. Renderers keep the default they had when they were created
+    static void SetDefault(std::shared_ptr<const FramebufferObject> framebuffer);
 
 private:
     FramebufferObject(Handle handle);
 
+    static std::shared_ptr<const FramebufferObject> GetWindowFramebuffer();
+
 private:
     static std::shared_ptr<const FramebufferObject> s_defaultFramebuffer;
 };
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+#include <ituGL/core/BufferObject.h>
+
+// Buffer with the texels of a TextureBufferObject
+using TextureBufferDataObject = BufferObjectBase<BufferObject::TextureBuffer>;
+
+// Texture object that reads its texels directly from a buffer, without filtering or mipmaps
+// Shaders read it with texelFetch on a samplerBuffer. Useful for big arrays that don't fit in a uniform buffer
+class TextureBufferObject : public TextureObjectBase<TextureObject::TextureBuffer>
+{
+public:
+    TextureBufferObject();
+
+    // Read the texels from the buffer, interpreted with the internal format
+    // The buffer must have been bound at least once, so that it exists. Reallocating its data keeps it attached
+    void SetBuffer(InternalFormat internalFormat, const TextureBufferDataObject& buffer);
+};
@@ -12,7 +12,7 @@ public:
         operator bool() const;
     private:
         friend DearImGui;
-        Window(const char* name);
+        Window(const char* name, int flags = 0);
     private:
         bool m_open;
     };
@@ -28,4 +28,6 @@ public:
     void EndFrame();
 
     Window UseWindow(const char* name);
+    // Small window without decorations and with a translucent background, pinned to the top right corner
+    Window UseOverlay(const char* name);
 };
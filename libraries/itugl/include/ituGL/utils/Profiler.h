@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class DearImGui;
+
+// Records the time spent in named zones of the code, in all the threads that use it
+// Each thread writes to its own ring buffer without locks. When a buffer is full, the oldest zones are overwritten
+// Zones can be exported as a Chrome trace (chrome://tracing or ui.perfetto.dev), or drawn as a flame graph with ImGui
+class Profiler
+{
+public:
+    // A completed zone
+    struct Zone
+    {
+        // Must be a string with static lifetime, usually a literal
+        const char* name;
+        // Nanoseconds since the profiler was created
+        int64_t startTime;
+        int64_t endTime;
+        // Number of zones that were open in the thread when it started
+        unsigned int depth;
+    };
+
+    // Zones kept for each thread
+    static const unsigned int ZonesPerThread = 1 << 14;
+
+public:
+    static Profiler& GetInstance();
+
+    // Zones are not recorded while disabled
+    bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    // Name of the calling thread in the trace and the flame graph
+    void SetThreadName(const char* name);
+
+    // Mark the start of a new frame, to find the zones of the last complete frame. Called from the main thread
+    void BeginFrame();
+
+    // Nanoseconds since the profiler was created
+    int64_t GetTime() const;
+
+    // Open a zone in the calling thread, and return its start time and depth
+    int64_t BeginZone(unsigned int& depth);
+    // Close the last zone opened in the calling thread
+    void EndZone(const char* name, int64_t startTime, unsigned int depth);
+
+    // Write all the zones kept in the buffers in the Chrome trace event format
+    bool WriteChromeTrace(const char* path) const;
+
+    // Draw the zones of the last complete frame as a flame graph, one per thread
+    void DrawGUI(DearImGui& imGui);
+
+private:
+    Profiler();
+
+    struct ThreadBuffer
+    {
+        std::string name;
+        unsigned int threadIndex = 0;
+        // Zones open at the moment. Only used by the owner thread
+        unsigned int depth = 0;
+        std::unique_ptr<Zone[]> zones;
+        // Total number of zones written. The last ZonesPerThread are in the buffer
+        std::atomic<uint64_t> zoneCount = 0;
+    };
+    ThreadBuffer& GetThreadBuffer();
+
+    // Copy the zones of a thread that overlap the time range, skipping the ones overwritten while copying
+    void CollectZones(const ThreadBuffer& buffer, int64_t beginTime, int64_t endTime, std::vector<Zone>& zones) const;
+
+private:
+    std::atomic<bool> m_enabled;
+
+    // Buffers of all the threads that recorded zones. They are kept when the threads finish
+    mutable std::mutex m_threadsMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threadBuffers;
+
+    // Start of the current and the previous frame
+    int64_t m_frameStartTime;
+    int64_t m_lastFrameStartTime;
+
+    // Result of the last export, shown in the GUI
+    std::string m_exportMessage;
+};
+
+// Records a zone from its construction to its destruction
+class ProfileScope
+{
+public:
+    ProfileScope(const char* name);
+    ~ProfileScope();
+
+private:
+    const char* m_name;
+    // Negative if the profiler was disabled when the scope started
+    int64_t m_startTime;
+    unsigned int m_depth;
+};
+
+// Profile the rest of the current scope. Define ITUGL_PROFILER_DISABLED to remove all the zones from the build
+#ifndef ITUGL_PROFILER_DISABLED
+#define ITUGL_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ITUGL_PROFILE_CONCAT(a, b) ITUGL_PROFILE_CONCAT_IMPL(a, b)
+#define ITUGL_PROFILE_SCOPE(name) ProfileScope ITUGL_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define ITUGL_PROFILE_SCOPE(name)
+#endif
@@ -6,10 +6,74 @@
 #include <chrono>
 // For error messages
 #include <iostream>
+// For reading the headless settings and writing the output image
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+// For the zones of the main loop
+#include <ituGL/utils/Profiler.h>
+// For the offscreen framebuffer of the headless mode
+#include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/Texture2DObject.h>
+
+Application::HeadlessSettings Application::HeadlessSettings::FromEnvironment()
+{
+    HeadlessSettings settings;
+
+    const char* frames = std::getenv("ITUGL_HEADLESS_FRAMES");
+    if (!frames)
+    {
+        return settings;
+    }
+    settings.enabled = true;
+    settings.frameCount = static_cast<unsigned int>(std::strtoul(frames, nullptr, 10));
+
+    if (const char* size = std::getenv("ITUGL_HEADLESS_SIZE"))
+    {
+        if (std::sscanf(size, "%dx%d", &settings.width, &settings.height) != 2)
+        {
+            settings.width = settings.height = 0;
+        }
+    }
+
+    if (const char* deltaTime = std::getenv("ITUGL_HEADLESS_DELTA_TIME"))
+    {
+        settings.fixedDeltaTime = std::strtof(deltaTime, nullptr);
+    }
+
+    if (const char* outputPath = std::getenv("ITUGL_HEADLESS_OUTPUT"))
+    {
+        settings.outputPath = outputPath;
+    }
+
+    return settings;
+}
+
+std::unique_ptr<Application::HeadlessSettings> Application::s_defaultHeadlessSettings;
+
+Application::HeadlessSettings Application::GetDefaultHeadlessSettings()
+{
+    return s_defaultHeadlessSettings ? *s_defaultHeadlessSettings : HeadlessSettings::FromEnvironment();
+}
+
+void Application::SetDefaultHeadlessSettings(const HeadlessSettings& headlessSettings)
+{
+    s_defaultHeadlessSettings = std::make_unique<HeadlessSettings>(headlessSettings);
+}
 
-// DeviceGL and main Window are constructed in the correct order because they were declared like that!
 Application::Application(int width, int height, const char* title)
-    : m_mainWindow(width, height, title), m_currentTime(0), m_deltaTime(0), m_exitCode(0)
+    : Application(width, height, title, GetDefaultHeadlessSettings())
+{
+}
+
+// DeviceGL and main Window are constructed in the correct order because they were declared like that!
+Application::Application(int width, int height, const char* title, const HeadlessSettings& headlessSettings)
+    : m_mainWindow(headlessSettings.enabled && headlessSettings.width > 0 ? headlessSettings.width : width,
+        headlessSettings.enabled && headlessSettings.height > 0 ? headlessSettings.height : height,
+        title, !headlessSettings.enabled)
+    , m_headlessSettings(headlessSettings), m_frameCount(0)
+    , m_currentTime(0), m_deltaTime(0), m_exitCode(0)
 {
     // If the main window is not valid, exit with error
     if (!m_mainWindow.IsValid())
@@ -26,10 +90,22 @@ Application::Application(int width, int height, const char* title)
         Terminate(-2, "Failed to initialize OpenGL with GLAD");
         return;
     }
+
+    if (m_headlessSettings.enabled)
+    {
+        m_mainWindow.GetDimensions(m_headlessSettings.width, m_headlessSettings.height);
+        InitializeOffscreenFramebuffer();
+    }
 }
 
 Application::~Application()
 {
+    // Other framebuffers can't be the default after the context is destroyed
+    if (m_offscreenFramebuffer)
+    {
+        FramebufferObject::SetDefault(nullptr);
+    }
+
     // If something didn't go as expected, display an error message
     if (m_exitCode)
     {
@@ -42,7 +118,13 @@ int Application::Run()
     // If the application is not in error state, run
     if (!m_exitCode)
     {
-        Initialize();
+        Profiler& profiler = Profiler::GetInstance();
+        profiler.SetThreadName("Main");
+
+        {
+            ITUGL_PROFILE_SCOPE("Initialize");
+            Initialize();
+        }
 
         // current time when the application started
         auto startTime = std::chrono::steady_clock::now();
@@ -50,17 +132,61 @@ int Application::Run()
         // Main loop
         while (IsRunning())
         {
-            // set current time relative to start time
-            std::chrono::duration<float> duration = std::chrono::steady_clock::now() - startTime;
-            UpdateTime(duration.count());
+            profiler.BeginFrame();
+            ITUGL_PROFILE_SCOPE("Frame");
+
+            // set current time relative to start time, or advance a fixed time when running headless
+            if (m_headlessSettings.fixedDeltaTime > 0.0f)
+            {
+                UpdateTime((m_frameCount + 1) * m_headlessSettings.fixedDeltaTime);
+            }
+            else
+            {
+                std::chrono::duration<float> duration = std::chrono::steady_clock::now() - startTime;
+                UpdateTime(duration.count());
+            }
 
-            Update();
+            {
+                ITUGL_PROFILE_SCOPE("Update");
+                Update();
+            }
 
-            Render();
+            {
+                ITUGL_PROFILE_SCOPE("Render");
+                Render();
+            }
 
             // Swap buffers and poll events at the end of the frame
-            m_mainWindow.SwapBuffers();
-            m_device.PollEvents();
+            if (m_headlessSettings.enabled)
+            {
+                // Nothing to present. Wait for the GPU instead, so frames don't queue up and frame times stay comparable
+                ITUGL_PROFILE_SCOPE("Finish");
+                glFinish();
+            }
+            else
+            {
+                ITUGL_PROFILE_SCOPE("SwapBuffers");
+                m_mainWindow.SwapBuffers();
+            }
+            {
+                ITUGL_PROFILE_SCOPE("PollEvents");
+                m_device.PollEvents();
+            }
+
+            ++m_frameCount;
+            if (m_headlessSettings.enabled && m_headlessSettings.frameCount > 0 && m_frameCount >= m_headlessSettings.frameCount)
+            {
+                Close();
+            }
+        }
+
+        // The offscreen framebuffer keeps the last frame
+        if (m_headlessSettings.enabled && !m_headlessSettings.outputPath.empty() && !m_exitCode)
+        {
+            if (!SaveOffscreenImage(m_headlessSettings.outputPath.c_str()))
+            {
+                Terminate(-3, "Failed to write the headless output image");
+            }
         }
 
         Cleanup();
@@ -116,6 +242,60 @@ void Application::UpdateTime(float newCurrentTime)
     m_currentTime = newCurrentTime;
 }
 
+void Application::InitializeOffscreenFramebuffer()
+{
+    int width = m_headlessSettings.width;
+    int height = m_headlessSettings.height;
+
+    // sRGB color, like the window framebuffer, so the output looks the same as on screen
+    m_offscreenColorTexture = std::make_shared<Texture2DObject>();
+    m_offscreenColorTexture->Bind();
+    m_offscreenColorTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatSRGBA8);
+    m_offscreenColorTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+    m_offscreenColorTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+
+    m_offscreenDepthTexture = std::make_shared<Texture2DObject>();
+    m_offscreenDepthTexture->Bind();
+    m_offscreenDepthTexture->SetImage(0, width, height, TextureObject::FormatDepth, TextureObject::InternalFormatDepth24);
+    m_offscreenDepthTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+    m_offscreenDepthTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    Texture2DObject::Unbind();
+
+    m_offscreenFramebuffer = std::make_shared<FramebufferObject>();
+    m_offscreenFramebuffer->Bind();
+    m_offscreenFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_offscreenColorTexture);
+    m_offscreenFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Depth, *m_offscreenDepthTexture);
+    assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+    // Everything that renders to the default framebuffer renders here instead, including the renderers created after this
+    FramebufferObject::SetDefault(m_offscreenFramebuffer);
+    m_device.SetViewport(0, 0, width, height);
+}
+
+bool Application::SaveOffscreenImage(const char* path) const
+{
+    int width = m_headlessSettings.width;
+    int height = m_headlessSettings.height;
+
+    // Rows are tightly packed, bottom to top
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 3);
+    m_offscreenFramebuffer->Bind(FramebufferObject::Target::Read);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (int y = height - 1; y >= 0; --y)
+    {
+        file.write(reinterpret_cast<const char*>(&pixels[static_cast<size_t>(y) * width * 3]), static_cast<std::streamsize>(width) * 3);
+    }
+    return static_cast<bool>(file);
+}
+
 bool Application::IsRunning() const
 {
     // Run while the window is valid and it has not been requested to close
@@ -1,17 +1,21 @@
 #include <ituGL/asset/ModelLoader.h>
 
 #include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/geometry/MeshSimplifier.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/utils/Profiler.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <glm/common.hpp>
 #include <iostream>
 #include <bit>
 
 ModelLoader::ModelLoader(std::shared_ptr<Material> referenceMaterial)
     : m_referenceMaterial(referenceMaterial)
     , m_createMaterials(false)
+    , m_lodCount(1)
 {
     m_textureLoader.SetGenerateMipmap(true);
 }
@@ -39,6 +43,17 @@ void ModelLoader::SetCreateMaterials(bool createMaterials)
     m_createMaterials = createMaterials;
 }
 
+unsigned int ModelLoader::GetLodCount() const
+{
+    return m_lodCount;
+}
+
+void ModelLoader::SetLodCount(unsigned int lodCount)
+{
+    assert(lodCount > 0);
+    m_lodCount = lodCount;
+}
+
 Texture2DLoader& ModelLoader::GetTexture2DLoader()
 {
     return m_textureLoader;
@@ -75,6 +90,8 @@ bool ModelLoader::SetMaterialProperty(MaterialProperty materialProperty, const c
 
 Model ModelLoader::Load(const char* path)
 {
+    ITUGL_PROFILE_SCOPE("ModelLoader::Load");
+
     Model model;
 
     // Read the file using Assimp importer
@@ -103,6 +120,14 @@ Model ModelLoader::Load(const char* path)
             }
             model.AddMaterial(material);
         }
+
+        // Each level of detail starts when the model takes half the screen size of the previous one
+        std::vector<float> lodThresholds;
+        for (unsigned int lod = 1; lod < m_lodCount; ++lod)
+        {
+            lodThresholds.push_back(0.5f / (1 << lod));
+        }
+        model.SetLodThresholds(lodThresholds);
     }
 
     return model;
@@ -121,8 +146,26 @@ void ModelLoader::GenerateSubmesh(Mesh& mesh, const aiMesh& meshData)
     std::vector<Drawcall::Primitive> primitives;
     std::vector<int> elementCounts;
     std::vector<GLubyte> elementData = CollectElementData(meshData, elementType, primitives, elementCounts);
+    int elementSize = Data::GetTypeSize(elementType);
+
+    // Levels of detail are appended to the same elements, so they are drawn with the same VAO
+    std::vector<std::vector<Drawcall>> lodDrawcalls;
+    if (m_lodCount > 1)
+    {
+        lodDrawcalls = GenerateLods(meshData, elementData, elementType, primitives, elementCounts);
+    }
     int eboIndex = mesh.AddElementData<GLubyte>(elementData);
 
+    // Compute the bounds once, to be used for culling
+    glm::vec3 minPosition(0.0f), maxPosition(0.0f);
+    for (unsigned int i = 0; i < meshData.mNumVertices; ++i)
+    {
+        glm::vec3 position(meshData.mVertices[i].x, meshData.mVertices[i].y, meshData.mVertices[i].z);
+        minPosition = i == 0 ? position : glm::min(minPosition, position);
+        maxPosition = i == 0 ? position : glm::max(maxPosition, position);
+    }
+    AabbBounds bounds(0.5f * (minPosition + maxPosition), 0.5f * (maxPosition - minPosition));
+
     // Add submeshes
     int start = 0;
     assert(primitives.size() == elementCounts.size());
@@ -130,7 +173,16 @@ void ModelLoader::GenerateSubmesh(Mesh& mesh, const aiMesh& meshData)
     {
         Drawcall::Primitive primitive = primitives[i];
         int end = elementCounts[i];
-        mesh.AddSubmesh(primitive, start, end - start, elementType, eboIndex, vboIndex, vertexFormat.LayoutBegin(static_cast<int>(vertexData.size()), interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        // The range is in bytes: the first element is a byte offset, but the count is in elements
+        unsigned int submeshIndex = mesh.AddSubmesh(primitive, start, (end - start) / elementSize, elementType, eboIndex, vboIndex, vertexFormat.LayoutBegin(static_cast<int>(vertexData.size()), interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        mesh.SetSubmeshBounds(submeshIndex, bounds);
+        if (i < lodDrawcalls.size())
+        {
+            for (const Drawcall& lodDrawcall : lodDrawcalls[i])
+            {
+                mesh.AddSubmeshLod(submeshIndex, lodDrawcall);
+            }
+        }
         start = end;
     }
 }
@@ -300,6 +352,82 @@ std::vector<GLubyte> ModelLoader::CollectElementData(const aiMesh& meshData, Dat
     return elementData;
 }
 
+std::vector<std::vector<Drawcall>> ModelLoader::GenerateLods(const aiMesh& meshData, std::vector<GLubyte>& elementData, Data::Type elementType,
+    std::span<const Drawcall::Primitive> primitives, std::span<const int> elementEnds) const
+{
+    ITUGL_PROFILE_SCOPE("ModelLoader::GenerateLods");
+
+    std::vector<std::vector<Drawcall>> lodDrawcalls(primitives.size());
+
+    std::vector<glm::vec3> positions(meshData.mNumVertices);
+    for (unsigned int i = 0; i < meshData.mNumVertices; ++i)
+    {
+        positions[i] = glm::vec3(meshData.mVertices[i].x, meshData.mVertices[i].y, meshData.mVertices[i].z);
+    }
+
+    // Elements are stored with the native type, after CollectElementData
+    int elementSize = Data::GetTypeSize(elementType);
+    auto readElement = [&](size_t offset) -> unsigned int
+    {
+        switch (elementSize)
+        {
+        case 1: return elementData[offset];
+        case 2: return *reinterpret_cast<const GLushort*>(&elementData[offset]);
+        default: return *reinterpret_cast<const GLuint*>(&elementData[offset]);
+        }
+    };
+    auto writeElement = [&](size_t offset, unsigned int element)
+    {
+        switch (elementSize)
+        {
+        case 1: elementData[offset] = static_cast<GLubyte>(element); break;
+        case 2: *reinterpret_cast<GLushort*>(&elementData[offset]) = static_cast<GLushort>(element); break;
+        default: *reinterpret_cast<GLuint*>(&elementData[offset]) = element; break;
+        }
+    };
+
+    int start = 0;
+    for (size_t i = 0; i < primitives.size(); ++i)
+    {
+        int end = elementEnds[i];
+        if (primitives[i] == Drawcall::Primitive::Triangles)
+        {
+            std::vector<unsigned int> indices;
+            indices.reserve((end - start) / elementSize);
+            for (int offset = start; offset < end; offset += elementSize)
+            {
+                indices.push_back(readElement(offset));
+            }
+
+            MeshSimplifier simplifier(positions, indices);
+            unsigned int triangleCount = simplifier.GetTriangleCount();
+            for (unsigned int lod = 1; lod < m_lodCount; ++lod)
+            {
+                simplifier.Simplify(triangleCount / 2);
+
+                // Stop when the mesh can't get much simpler, the level would cost memory for nothing
+                if (simplifier.GetTriangleCount() == 0 || simplifier.GetTriangleCount() * 4 > triangleCount * 3)
+                {
+                    break;
+                }
+                triangleCount = simplifier.GetTriangleCount();
+
+                std::span<const unsigned int> lodIndices = simplifier.GetIndices();
+                size_t lodStart = elementData.size();
+                elementData.resize(lodStart + lodIndices.size() * elementSize);
+                for (size_t index = 0; index < lodIndices.size(); ++index)
+                {
+                    writeElement(lodStart + index * elementSize, lodIndices[index]);
+                }
+                lodDrawcalls[i].emplace_back(Drawcall::Primitive::Triangles, static_cast<GLsizei>(lodIndices.size()), elementType, static_cast<GLint>(lodStart));
+            }
+        }
+        start = end;
+    }
+
+    return lodDrawcalls;
+}
+
 const void* ModelLoader::GetVertexDataPointer(const aiMesh& meshData, VertexAttribute::Semantic semantic, int& stride)
 {
     const void* data = nullptr;
@@ -1,5 +1,6 @@
 #include <ituGL/asset/ShaderLoader.h>
 
+#include <ituGL/utils/Profiler.h>
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -24,6 +25,7 @@ bool ShaderLoader::IsValid(std::span<const char*> paths)
 
 Shader ShaderLoader::Load(const char* path)
 {
+    ITUGL_PROFILE_SCOPE("ShaderLoader::Load");
     Shader shader(m_type);
     std::ifstream file(path);
     assert(file.is_open());
@@ -36,6 +38,7 @@ Shader ShaderLoader::Load(const char* path)
 
 Shader ShaderLoader::Load(std::span<const char*> paths)
 {
+    ITUGL_PROFILE_SCOPE("ShaderLoader::Load");
     Shader shader(m_type);
     std::vector<std::stringstream> stringStreams(paths.size());
     std::vector<std::string> sourceCodeStrings(paths.size());
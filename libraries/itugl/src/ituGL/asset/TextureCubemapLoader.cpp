@@ -1,6 +1,9 @@
 #include <ituGL/asset/TextureCubemapLoader.h>
 
+#include <ituGL/utils/Profiler.h>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <stb_image.h>
 
 TextureCubemapLoader::TextureCubemapLoader()
@@ -14,6 +17,8 @@ TextureCubemapLoader::TextureCubemapLoader(TextureObject::Format format, Texture
 
 TextureCubemapObject TextureCubemapLoader::Load(const char* path)
 {
+    ITUGL_PROFILE_SCOPE("TextureCubemapLoader::Load");
+
     TextureCubemapObject textureCubemap;
 
     int width, height;
@@ -52,7 +57,7 @@ TextureCubemapObject TextureCubemapLoader::Load(const char* path)
 
             // Adjust mip levels
             textureCubemap.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
-            float maxLod = 1.0f + std::floorf(std::log2f(static_cast<float>(std::max(width, height))));
+            float maxLod = 1.0f + std::floor(std::log2(static_cast<float>(std::max(width, height))));
             textureCubemap.SetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
         }
 
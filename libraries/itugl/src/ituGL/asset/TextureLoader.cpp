@@ -1,10 +1,14 @@
 #include <ituGL/asset/TextureLoader.h>
 
+#include <ituGL/utils/Profiler.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 std::span<const std::byte> TextureLoaderUtils::LoadTexture2DData(const char* path, int& width, int& height, Data::Type& dataType, TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool flipVertical)
 {
+    ITUGL_PROFILE_SCOPE("LoadTexture2DData");
+
     std::span<const std::byte> dataSpan;
 
     int componentCount = TextureObject::GetComponentCount(format);
@@ -0,0 +1,107 @@
+#include <ituGL/camera/CameraPath.h>
+
+#include <ituGL/camera/Camera.h>
+#include <glm/gtx/spline.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+CameraPath::CameraPath(bool loop) : m_loop(loop)
+{
+}
+
+void CameraPath::AddKeyframe(float time, const glm::vec3& position, const glm::vec3& target)
+{
+    assert(m_keyframes.empty() || time > m_keyframes.back().time);
+    m_keyframes.push_back(Keyframe{ time, position, target });
+}
+
+float CameraPath::GetDuration() const
+{
+    if (m_keyframes.size() < 2)
+    {
+        return 0.0f;
+    }
+
+    float duration = m_keyframes.back().time - m_keyframes.front().time;
+    if (m_loop)
+    {
+        duration += m_keyframes[1].time - m_keyframes[0].time;
+    }
+    return duration;
+}
+
+void CameraPath::Evaluate(float time, glm::vec3& position, glm::vec3& target) const
+{
+    assert(!m_keyframes.empty());
+
+    int keyframeCount = static_cast<int>(m_keyframes.size());
+    if (keyframeCount == 1)
+    {
+        position = m_keyframes[0].position;
+        target = m_keyframes[0].target;
+        return;
+    }
+
+    // Time relative to the first keyframe, wrapped or clamped to the path
+    float duration = GetDuration();
+    time -= m_keyframes.front().time;
+    time = m_loop ? time - std::floor(time / duration) * duration : std::clamp(time, 0.0f, duration);
+    time += m_keyframes.front().time;
+
+    // Segment that contains the time. When looping, the last segment goes from the last keyframe to the first one
+    int segment = 0;
+    while (segment + 1 < keyframeCount && m_keyframes[segment + 1].time <= time)
+    {
+        ++segment;
+    }
+    if (!m_loop && segment == keyframeCount - 1)
+    {
+        position = m_keyframes.back().position;
+        target = m_keyframes.back().target;
+        return;
+    }
+
+    float startTime = m_keyframes[segment].time;
+    float endTime = segment + 1 < keyframeCount ? m_keyframes[segment + 1].time : startTime + (m_keyframes[1].time - m_keyframes[0].time);
+    float t = (time - startTime) / (endTime - startTime);
+
+    const Keyframe& k0 = GetKeyframe(segment - 1);
+    const Keyframe& k1 = GetKeyframe(segment);
+    const Keyframe& k2 = GetKeyframe(segment + 1);
+    const Keyframe& k3 = GetKeyframe(segment + 2);
+    position = glm::catmullRom(k0.position, k1.position, k2.position, k3.position, t);
+    target = glm::catmullRom(k0.target, k1.target, k2.target, k3.target, t);
+}
+
+void CameraPath::Apply(float time, Camera& camera) const
+{
+    glm::vec3 position, target;
+    Evaluate(time, position, target);
+    camera.SetViewMatrix(position, target);
+}
+
+CameraPath CameraPath::CreateOrbit(const glm::vec3& center, float radius, float height, float duration, unsigned int keyframeCount)
+{
+    assert(keyframeCount >= 3);
+
+    CameraPath path(true);
+    for (unsigned int i = 0; i < keyframeCount; ++i)
+    {
+        float angle = 2.0f * std::numbers::pi_v<float> * i / keyframeCount;
+        glm::vec3 position = center + glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle));
+        path.AddKeyframe(duration * i / keyframeCount, position, center);
+    }
+    return path;
+}
+
+const CameraPath::Keyframe& CameraPath::GetKeyframe(int index) const
+{
+    int keyframeCount = static_cast<int>(m_keyframes.size());
+    if (m_loop)
+    {
+        return m_keyframes[(index % keyframeCount + keyframeCount) % keyframeCount];
+    }
+    return m_keyframes[std::clamp(index, 0, keyframeCount - 1)];
+}
@@ -1,7 +1,17 @@
 #include <ituGL/core/BufferObject.h>
 
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
+// Count the bytes copied in the device stats
+static void CountUpload(size_t bytes)
+{
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        device->AddBufferUploadStats(bytes);
+    }
+}
+
 // Create the object initially null, get object handle and generate 1 buffer
 BufferObject::BufferObject() : Object(NullHandle)
 {
@@ -33,6 +43,12 @@ void BufferObject::Bind(Target target) const
     glBindBuffer(target, handle);
 }
 
+void BufferObject::BindBase(Target target, GLuint bindingPoint) const
+{
+    Handle handle = GetHandle();
+    glBindBufferBase(target, bindingPoint, handle);
+}
+
 // Bind the null handle to the specific target
 void BufferObject::Unbind(Target target)
 {
@@ -53,6 +69,7 @@ void BufferObject::AllocateData(std::span<const std::byte> data, Usage usage)
 {
     assert(IsBound());
     Target target = GetTarget();
+    CountUpload(data.size_bytes());
     glBufferData(target, data.size_bytes(), data.data(), usage);
 }
 
@@ -61,5 +78,6 @@ void BufferObject::UpdateData(std::span<const std::byte> data, size_t offset)
 {
     assert(IsBound());
     Target target = GetTarget();
+    CountUpload(data.size_bytes());
     glBufferSubData(target, offset, data.size_bytes(), data.data());
 }
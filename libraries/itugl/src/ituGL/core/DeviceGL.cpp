@@ -41,7 +41,7 @@ void DeviceGL::SetCurrentWindow(Window& window)
 // Set the dimensions of the viewport
 void DeviceGL::SetViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
-    glViewport(0, 0, width, height);
+    glViewport(x, y, width, height);
 }
 
 // Poll the events in the window event queue
@@ -85,12 +85,27 @@ void DeviceGL::Clear(bool clearColor, const Color& color, bool clearDepth, GLdou
 // Get if a feature is enabled
 bool DeviceGL::IsFeatureEnabled(GLenum feature) const
 {
+    // Avoid querying OpenGL if we already know the value
+    const auto& itFind = m_stateCache.features.find(feature);
+    if (itFind != m_stateCache.features.end())
+    {
+        return itFind->second;
+    }
     return glIsEnabled(feature);
 }
 
 // enable / disable a feature
 void DeviceGL::SetFeatureEnabled(GLenum feature, bool enabled)
 {
+    auto itFind = m_stateCache.features.find(feature);
+    if (itFind != m_stateCache.features.end() && itFind->second == enabled)
+    {
+        ++m_stateStats.skippedCalls;
+        return;
+    }
+    m_stateCache.features[feature] = enabled;
+    ++m_stateStats.issuedCalls;
+
     if (enabled)
     {
         glEnable(feature);
@@ -101,6 +116,12 @@ void DeviceGL::SetFeatureEnabled(GLenum feature, bool enabled)
     }
 }
 
+// enable / disable writing to the color attachments. Not cached
+void DeviceGL::SetColorWrite(bool enabled)
+{
+    glColorMask(enabled, enabled, enabled, enabled);
+}
+
 // enable / disable wireframe mode
 void DeviceGL::SetWireframeEnabled(bool enabled)
 {
@@ -112,3 +133,232 @@ void DeviceGL::SetVSyncEnabled(bool enabled)
 {
     glfwSwapInterval(enabled ? 1 : 0);
 }
+
+
+// Count a drawcall in the stats. Instanced draws are the ones issued with DrawInstanced, even with one instance
+void DeviceGL::AddDrawcallStats(bool instanced, unsigned int instanceCount, unsigned int vertexCount, unsigned int triangleCount)
+{
+    ++m_stateStats.drawcalls;
+    if (instanced)
+    {
+        ++m_stateStats.instancedDrawcalls;
+    }
+    m_stateStats.instances += instanceCount;
+    m_stateStats.vertices += static_cast<uint64_t>(vertexCount) * instanceCount;
+    m_stateStats.triangles += static_cast<uint64_t>(triangleCount) * instanceCount;
+}
+
+// Reset the state cache counters, usually once per frame
+void DeviceGL::ResetStateStats()
+{
+    m_stateStats = StateStats();
+}
+
+// Forget all the cached state. Needed if OpenGL state was changed without going through DeviceGL
+void DeviceGL::InvalidateState()
+{
+    m_stateCache = StateCache();
+}
+
+// Compare the cached state with the new value. Returns true if the GL call needs to be issued
+template<typename T>
+bool DeviceGL::UpdateState(std::optional<T>& state, const T& value)
+{
+    if (state && *state == value)
+    {
+        ++m_stateStats.skippedCalls;
+        return false;
+    }
+    state = value;
+    ++m_stateStats.issuedCalls;
+    return true;
+}
+
+// Set the shader program in use, skipped if it is already in use
+void DeviceGL::UseShaderProgram(GLuint handle)
+{
+    if (UpdateState(m_stateCache.shaderProgram, handle))
+    {
+        ++m_stateStats.programBinds;
+        glUseProgram(handle);
+    }
+}
+
+// Bind the vertex array object, skipped if it is already bound
+void DeviceGL::BindVertexArray(GLuint handle)
+{
+    if (UpdateState(m_stateCache.vertexArray, handle))
+    {
+        glBindVertexArray(handle);
+    }
+}
+
+// Set the active texture unit, skipped if it is already active
+void DeviceGL::SetActiveTextureUnit(GLint textureUnit)
+{
+    if (UpdateState(m_stateCache.activeTextureUnit, textureUnit))
+    {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+    }
+}
+
+// Bind the texture to the active texture unit, skipped if it is already bound
+void DeviceGL::BindTexture(GLenum target, GLuint handle)
+{
+    // A unit can have one texture bound per target. We only remember the last one, so switching targets in the same unit is always issued
+    if (m_stateCache.activeTextureUnit && *m_stateCache.activeTextureUnit >= 0 && *m_stateCache.activeTextureUnit < MaxCachedTextureUnits)
+    {
+        if (!UpdateState(m_stateCache.textures[*m_stateCache.activeTextureUnit], std::make_pair(target, handle)))
+        {
+            return;
+        }
+    }
+    else
+    {
+        ++m_stateStats.issuedCalls;
+    }
+    ++m_stateStats.textureBinds;
+    glBindTexture(target, handle);
+}
+
+// Remove deleted objects from the cache, as their handles can be reused
+void DeviceGL::InvalidateShaderProgram(GLuint handle)
+{
+    if (m_stateCache.shaderProgram == handle)
+    {
+        m_stateCache.shaderProgram.reset();
+    }
+}
+
+void DeviceGL::InvalidateVertexArray(GLuint handle)
+{
+    if (m_stateCache.vertexArray == handle)
+    {
+        m_stateCache.vertexArray.reset();
+    }
+}
+
+void DeviceGL::InvalidateTexture(GLuint handle)
+{
+    for (auto& texture : m_stateCache.textures)
+    {
+        if (texture && texture->second == handle)
+        {
+            texture.reset();
+        }
+    }
+}
+
+// Set the depth test function
+void DeviceGL::SetDepthFunction(GLenum function)
+{
+    if (UpdateState(m_stateCache.depthFunction, function))
+    {
+        glDepthFunc(function);
+    }
+}
+
+// Set the depth write
+void DeviceGL::SetDepthWrite(bool enabled)
+{
+    if (UpdateState(m_stateCache.depthWrite, enabled))
+    {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+// Set the faces culled, front, back or both
+void DeviceGL::SetCullFace(GLenum face)
+{
+    if (UpdateState(m_stateCache.cullFace, face))
+    {
+        glCullFace(face);
+    }
+}
+
+// Set the stencil test function. Face can be GL_FRONT, GL_BACK or GL_FRONT_AND_BACK
+void DeviceGL::SetStencilFunction(GLenum face, GLenum function, GLint refValue, GLuint mask)
+{
+    std::array<GLuint, 3> value = { function, static_cast<GLuint>(refValue), mask };
+    if (face == GL_FRONT_AND_BACK)
+    {
+        auto& front = m_stateCache.stencilFunctions[0];
+        auto& back = m_stateCache.stencilFunctions[1];
+        if (front == value && back == value)
+        {
+            ++m_stateStats.skippedCalls;
+            return;
+        }
+        front = back = value;
+        ++m_stateStats.issuedCalls;
+        glStencilFunc(function, refValue, mask);
+    }
+    else if (UpdateState(m_stateCache.stencilFunctions[face == GL_FRONT ? 0 : 1], value))
+    {
+        glStencilFuncSeparate(face, function, refValue, mask);
+    }
+}
+
+// Set the stencil operations. Face can be GL_FRONT, GL_BACK or GL_FRONT_AND_BACK
+void DeviceGL::SetStencilOperations(GLenum face, GLenum stencilFail, GLenum depthFail, GLenum depthPass)
+{
+    std::array<GLenum, 3> value = { stencilFail, depthFail, depthPass };
+    if (face == GL_FRONT_AND_BACK)
+    {
+        auto& front = m_stateCache.stencilOperations[0];
+        auto& back = m_stateCache.stencilOperations[1];
+        if (front == value && back == value)
+        {
+            ++m_stateStats.skippedCalls;
+            return;
+        }
+        front = back = value;
+        ++m_stateStats.issuedCalls;
+        glStencilOp(stencilFail, depthFail, depthPass);
+    }
+    else if (UpdateState(m_stateCache.stencilOperations[face == GL_FRONT ? 0 : 1], value))
+    {
+        glStencilOpSeparate(face, stencilFail, depthFail, depthPass);
+    }
+}
+
+// Set the blend equations for color and alpha
+void DeviceGL::SetBlendEquation(GLenum colorEquation, GLenum alphaEquation)
+{
+    if (UpdateState(m_stateCache.blendEquation, std::array<GLenum, 2>{ colorEquation, alphaEquation }))
+    {
+        if (colorEquation == alphaEquation)
+        {
+            glBlendEquation(colorEquation);
+        }
+        else
+        {
+            glBlendEquationSeparate(colorEquation, alphaEquation);
+        }
+    }
+}
+
+// Set the blend params for color and alpha
+void DeviceGL::SetBlendFunction(GLenum sourceColor, GLenum destinationColor, GLenum sourceAlpha, GLenum destinationAlpha)
+{
+    if (UpdateState(m_stateCache.blendFunction, std::array<GLenum, 4>{ sourceColor, destinationColor, sourceAlpha, destinationAlpha }))
+    {
+        if (sourceColor == sourceAlpha && destinationColor == destinationAlpha)
+        {
+            glBlendFunc(sourceColor, destinationColor);
+        }
+        else
+        {
+            glBlendFuncSeparate(sourceColor, destinationColor, sourceAlpha, destinationAlpha);
+        }
+    }
+}
+
+// Set the constant blend color
+void DeviceGL::SetBlendColor(const Color& color)
+{
+    if (UpdateState(m_stateCache.blendColor, std::array<float, 4>{ color.GetRed(), color.GetGreen(), color.GetBlue(), color.GetAlpha() }))
+    {
+        glBlendColor(color.GetRed(), color.GetGreen(), color.GetBlue(), color.GetAlpha());
+    }
+}
@@ -0,0 +1,66 @@
+#include <ituGL/core/QueryObject.h>
+
+#include <cassert>
+#include <utility>
+
+QueryObject::QueryObject() : Object(NullHandle)
+{
+    Handle& handle = GetHandle();
+    glGenQueries(1, &handle);
+}
+
+QueryObject::~QueryObject()
+{
+    if (IsValid())
+    {
+        Handle& handle = GetHandle();
+        glDeleteQueries(1, &handle);
+        handle = NullHandle;
+    }
+}
+
+QueryObject::QueryObject(QueryObject&& queryObject) noexcept : Object(std::move(queryObject))
+{
+}
+
+QueryObject& QueryObject::operator = (QueryObject&& queryObject) noexcept
+{
+    Object::operator=(std::move(queryObject));
+    return *this;
+}
+
+// Bind should not be called for QueryObject
+void QueryObject::Bind() const
+{
+    // Assert if it gets called
+    assert(false);
+}
+
+void QueryObject::Begin(Target target) const
+{
+    glBeginQuery(target, GetHandle());
+}
+
+void QueryObject::End(Target target)
+{
+    glEndQuery(target);
+}
+
+void QueryObject::QueryTimestamp() const
+{
+    glQueryCounter(GetHandle(), GL_TIMESTAMP);
+}
+
+bool QueryObject::IsResultAvailable() const
+{
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(GetHandle(), GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != GL_FALSE;
+}
+
+GLuint64 QueryObject::GetResult() const
+{
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(GetHandle(), GL_QUERY_RESULT, &result);
+    return result;
+}
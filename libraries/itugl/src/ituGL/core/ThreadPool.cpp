@@ -0,0 +1,122 @@
+#include <ituGL/core/ThreadPool.h>
+
+#include <ituGL/utils/Profiler.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cassert>
+#include <string>
+
+ThreadPool::ThreadPool() : ThreadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1)
+{
+}
+
+ThreadPool::ThreadPool(unsigned int workerCount) : m_stopping(false)
+{
+    m_workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::GetTaskCount(unsigned int count, unsigned int minTaskSize) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    unsigned int maxTaskCount = count / std::max(minTaskSize, 1u);
+    return std::clamp(maxTaskCount, 1u, GetWorkerCount() + 1);
+}
+
+void ThreadPool::ParallelFor(unsigned int count, unsigned int minTaskSize, const TaskFunction& function)
+{
+    unsigned int taskCount = GetTaskCount(count, minTaskSize);
+    if (taskCount <= 1)
+    {
+        // Not worth waking up the workers
+        if (taskCount == 1)
+        {
+            function(0, count, 0);
+        }
+        return;
+    }
+
+    // Tasks are taken in order by whoever is free, including the calling thread
+    std::atomic<unsigned int> nextTask = 0;
+    auto runTasks = [&]()
+    {
+        for (unsigned int taskIndex = nextTask++; taskIndex < taskCount; taskIndex = nextTask++)
+        {
+            unsigned int begin = static_cast<unsigned int>(static_cast<uint64_t>(count) * taskIndex / taskCount);
+            unsigned int end = static_cast<unsigned int>(static_cast<uint64_t>(count) * (taskIndex + 1) / taskCount);
+            ITUGL_PROFILE_SCOPE("ParallelFor task");
+            function(begin, end, taskIndex);
+        }
+    };
+
+    // Wait for the jobs, not only the tasks, because the jobs reference local variables
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    unsigned int pendingJobs = std::min(GetWorkerCount(), taskCount - 1);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (unsigned int i = 0, jobCount = pendingJobs; i < jobCount; ++i)
+        {
+            m_jobs.push_back([&]()
+                {
+                    runTasks();
+                    std::lock_guard<std::mutex> doneLock(doneMutex);
+                    if (--pendingJobs == 0)
+                    {
+                        doneCondition.notify_one();
+                    }
+                });
+        }
+    }
+    m_condition.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> doneLock(doneMutex);
+    doneCondition.wait(doneLock, [&]() { return pendingJobs == 0; });
+}
+
+void ThreadPool::WorkerLoop(unsigned int workerIndex)
+{
+    std::string threadName = "Worker " + std::to_string(workerIndex);
+    Profiler::GetInstance().SetThreadName(threadName.c_str());
+
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty())
+            {
+                assert(m_stopping);
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
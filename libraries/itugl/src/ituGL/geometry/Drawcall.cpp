@@ -2,6 +2,7 @@
 
 #include <ituGL/geometry/VertexArrayObject.h>
 #include <ituGL/geometry/ElementBufferObject.h>
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
 Drawcall::Drawcall()
@@ -22,12 +23,37 @@ Drawcall::Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint
     assert(count > 0);
 }
 
+// Number of triangles assembled from the vertices, 0 for points, lines and patches
+unsigned int Drawcall::GetTriangleCount() const
+{
+    unsigned int count = static_cast<unsigned int>(m_count);
+    switch (m_primitive)
+    {
+    case Primitive::Triangles:
+        return count / 3;
+    case Primitive::TriangleStrip:
+    case Primitive::TriangleFan:
+        return count > 2 ? count - 2 : 0;
+    case Primitive::TrianglesAdjacency:
+        return count / 6;
+    case Primitive::TriangleStripAdjacency:
+        return count > 5 ? (count - 4) / 2 : 0;
+    default:
+        return 0;
+    }
+}
+
 // Execute the drawcall
 void Drawcall::Draw() const
 {
     assert(IsValid());
     assert(VertexArrayObject::IsAnyBound());
 
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        device->AddDrawcallStats(false, 1, m_count, GetTriangleCount());
+    }
+
     GLenum primitive = static_cast<GLenum>(m_primitive);
     if (m_eboType == Data::Type::None)
     {
@@ -42,3 +68,30 @@ void Drawcall::Draw() const
         glDrawElements(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first);
     }
 }
+
+// Execute the drawcall several times, with per-instance vertex attributes advancing for each instance
+void Drawcall::DrawInstanced(GLsizei instanceCount) const
+{
+    assert(IsValid());
+    assert(VertexArrayObject::IsAnyBound());
+    assert(instanceCount > 0);
+
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        device->AddDrawcallStats(true, instanceCount, m_count, GetTriangleCount());
+    }
+
+    GLenum primitive = static_cast<GLenum>(m_primitive);
+    if (m_eboType == Data::Type::None)
+    {
+        // If no EBO is present, use glDrawArraysInstanced
+        glDrawArraysInstanced(primitive, m_first, m_count, instanceCount);
+    }
+    else
+    {
+        // If there is an EBO, use glDrawElementsInstanced
+        assert(ElementBufferObject::IsSupportedType(m_eboType));
+        const char* basePointer = nullptr; // Actual element pointer is in VAO
+        glDrawElementsInstanced(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first, instanceCount);
+    }
+}
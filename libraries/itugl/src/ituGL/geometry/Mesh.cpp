@@ -1,6 +1,10 @@
 #include <ituGL/geometry/Mesh.h>
 
-Mesh::Mesh()
+#include <glm/common.hpp>
+#include <cassert>
+#include <limits>
+
+Mesh::Mesh() : m_boundedSubmeshCount(0)
 {
 }
 
@@ -35,6 +39,43 @@ unsigned int Mesh::AddSubmesh(unsigned int vaoIndex,
     return AddSubmesh(vaoIndex, Drawcall(primitive, count, eboType, first));
 }
 
+unsigned int Mesh::AddSubmeshLod(unsigned int submeshIndex, const Drawcall& drawcall)
+{
+    Submesh& submesh = GetSubmesh(submeshIndex);
+    submesh.lodDrawcalls.push_back(drawcall);
+    return static_cast<unsigned int>(submesh.lodDrawcalls.size());
+}
+
+const Drawcall& Mesh::GetSubmeshDrawcall(unsigned int submeshIndex, unsigned int lod) const
+{
+    const Submesh& submesh = GetSubmesh(submeshIndex);
+    assert(lod <= submesh.lodDrawcalls.size());
+    return lod == 0 ? submesh.drawcall : submesh.lodDrawcalls[lod - 1];
+}
+
+void Mesh::SetSubmeshBounds(unsigned int submeshIndex, const AabbBounds& bounds)
+{
+    Submesh& submesh = GetSubmesh(submeshIndex);
+    if (!submesh.bounds)
+    {
+        m_boundedSubmeshCount++;
+    }
+    submesh.bounds = bounds;
+
+    // Recompute the union, in case the previous bounds of this submesh were the largest
+    glm::vec3 minPoint(std::numeric_limits<float>::max());
+    glm::vec3 maxPoint(std::numeric_limits<float>::lowest());
+    for (const Submesh& other : m_submeshes)
+    {
+        if (other.bounds)
+        {
+            minPoint = glm::min(minPoint, other.bounds->GetMin());
+            maxPoint = glm::max(maxPoint, other.bounds->GetMax());
+        }
+    }
+    m_bounds = AabbBounds(0.5f * (minPoint + maxPoint), 0.5f * (maxPoint - minPoint));
+}
+
 // Bind the VAO and render the drawcall of the submesh
 void Mesh::DrawSubmesh(int submeshIndex) const
 {
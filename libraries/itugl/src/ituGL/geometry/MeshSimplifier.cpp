@@ -0,0 +1,300 @@
+#include <ituGL/geometry/MeshSimplifier.h>
+
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+
+void MeshSimplifier::Quadric::AddPlane(const glm::vec3& normal, float distance, float weight)
+{
+    double a = normal.x, b = normal.y, c = normal.z, d = distance, w = weight;
+    a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+    a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+    a22 += w * c * c; a23 += w * c * d;
+    a33 += w * d * d;
+}
+
+void MeshSimplifier::Quadric::Add(const Quadric& other)
+{
+    a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+    a11 += other.a11; a12 += other.a12; a13 += other.a13;
+    a22 += other.a22; a23 += other.a23;
+    a33 += other.a33;
+}
+
+double MeshSimplifier::Quadric::Evaluate(const glm::vec3& position) const
+{
+    // v^T Q v, with v = (x, y, z, 1)
+    double x = position.x, y = position.y, z = position.z;
+    return x * x * a00 + y * y * a11 + z * z * a22 + a33
+        + 2.0 * (x * y * a01 + x * z * a02 + y * z * a12 + x * a03 + y * a13 + z * a23);
+}
+
+MeshSimplifier::MeshSimplifier(std::span<const glm::vec3> positions, std::span<const unsigned int> indices)
+    : m_positions(positions.begin(), positions.end()), m_indices(indices.begin(), indices.end())
+{
+    assert(m_indices.size() % 3 == 0);
+
+    WeldVertices();
+    InitializeQuadrics();
+    LockBorders();
+}
+
+void MeshSimplifier::WeldVertices()
+{
+    unsigned int vertexCount = static_cast<unsigned int>(m_positions.size());
+    m_welded.resize(vertexCount);
+    m_locked.assign(vertexCount, false);
+
+    // Sorting by position puts the copies of a vertex next to each other
+    std::vector<unsigned int> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+        {
+            const glm::vec3& pa = m_positions[a];
+            const glm::vec3& pb = m_positions[b];
+            return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+        });
+
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        unsigned int vertex = order[i];
+        if (i > 0 && m_positions[vertex] == m_positions[order[i - 1]])
+        {
+            m_welded[vertex] = m_welded[order[i - 1]];
+            // Copies only differ in the other attributes: moving one of them would tear the seam
+            m_locked[m_welded[vertex]] = true;
+        }
+        else
+        {
+            m_welded[vertex] = vertex;
+        }
+    }
+}
+
+void MeshSimplifier::InitializeQuadrics()
+{
+    m_quadrics.assign(m_positions.size(), Quadric{});
+
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        const glm::vec3& p0 = m_positions[m_indices[i]];
+        const glm::vec3& p1 = m_positions[m_indices[i + 1]];
+        const glm::vec3& p2 = m_positions[m_indices[i + 2]];
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length == 0.0f)
+        {
+            continue;
+        }
+        normal /= length;
+
+        // Weighted by area, so large triangles are harder to change
+        float area = 0.5f * length;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            m_quadrics[m_welded[m_indices[i + corner]]].AddPlane(normal, -glm::dot(normal, p0), area);
+        }
+    }
+}
+
+void MeshSimplifier::LockBorders()
+{
+    // Edges between welded vertices. Closed surfaces have every edge twice
+    std::vector<uint64_t> edges;
+    edges.reserve(m_indices.size());
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            uint64_t a = m_welded[m_indices[i + corner]];
+            uint64_t b = m_welded[m_indices[i + (corner + 1) % 3]];
+            edges.push_back(a < b ? (a << 32) | b : (b << 32) | a);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    for (size_t i = 0; i < edges.size(); )
+    {
+        size_t count = 1;
+        while (i + count < edges.size() && edges[i + count] == edges[i])
+        {
+            ++count;
+        }
+        if (count != 2)
+        {
+            m_locked[static_cast<unsigned int>(edges[i] >> 32)] = true;
+            m_locked[static_cast<unsigned int>(edges[i] & 0xFFFFFFFF)] = true;
+        }
+        i += count;
+    }
+}
+
+void MeshSimplifier::BuildAdjacency()
+{
+    m_adjacencyOffsets.assign(m_positions.size() + 1, 0);
+    for (unsigned int index : m_indices)
+    {
+        m_adjacencyOffsets[index + 1]++;
+    }
+    std::partial_sum(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end(), m_adjacencyOffsets.begin());
+
+    m_adjacency.resize(m_indices.size());
+    std::vector<unsigned int> next(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < m_indices.size(); ++i)
+    {
+        m_adjacency[next[m_indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+}
+
+void MeshSimplifier::Simplify(unsigned int targetTriangleCount)
+{
+    while (GetTriangleCount() > targetTriangleCount && SimplifyPass(targetTriangleCount))
+    {
+    }
+}
+
+bool MeshSimplifier::SimplifyPass(unsigned int targetTriangleCount)
+{
+    BuildAdjacency();
+
+    // One candidate per edge, in its cheapest direction
+    m_collapses.clear();
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int a = m_indices[i + corner];
+            unsigned int b = m_indices[i + (corner + 1) % 3];
+            // Inner edges are found from both triangles
+            if (a > b)
+            {
+                continue;
+            }
+
+            Quadric quadric = m_quadrics[m_welded[a]];
+            quadric.Add(m_quadrics[m_welded[b]]);
+            bool lockedA = m_locked[m_welded[a]];
+            bool lockedB = m_locked[m_welded[b]];
+            double costA = lockedA ? -1.0 : quadric.Evaluate(m_positions[b]);
+            double costB = lockedB ? -1.0 : quadric.Evaluate(m_positions[a]);
+            if (!lockedA && (lockedB || costA <= costB))
+            {
+                m_collapses.push_back(Collapse{ costA, a, b });
+            }
+            else if (!lockedB)
+            {
+                m_collapses.push_back(Collapse{ costB, b, a });
+            }
+        }
+    }
+    std::sort(m_collapses.begin(), m_collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+    m_remap.resize(m_positions.size());
+    std::iota(m_remap.begin(), m_remap.end(), 0u);
+    m_touched.assign(m_positions.size(), false);
+
+    // Only the cheaper half in each pass, if any of them can collapse. The rest is evaluated again after the mesh changed around it
+    size_t collapseLimit = (m_collapses.size() + 1) / 2;
+    unsigned int triangleCount = GetTriangleCount();
+    unsigned int removedTriangles = 0;
+    unsigned int collapseCount = 0;
+    for (size_t i = 0; i < m_collapses.size() && triangleCount - removedTriangles > targetTriangleCount; ++i)
+    {
+        if (i >= collapseLimit && collapseCount > 0)
+        {
+            break;
+        }
+
+        const Collapse& collapse = m_collapses[i];
+
+        // Triangles around both ends are skipped for the rest of the pass, so the adjacency stays valid
+        if (m_touched[collapse.from] || m_touched[collapse.to] || FlipsTriangles(collapse.from, collapse.to))
+        {
+            continue;
+        }
+
+        m_remap[collapse.from] = collapse.to;
+        m_quadrics[m_welded[collapse.to]].Add(m_quadrics[m_welded[collapse.from]]);
+        for (unsigned int adjacencyIndex = m_adjacencyOffsets[collapse.from]; adjacencyIndex < m_adjacencyOffsets[collapse.from + 1]; ++adjacencyIndex)
+        {
+            const unsigned int* triangle = &m_indices[m_adjacency[adjacencyIndex] * 3];
+            bool removed = false;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                m_touched[triangle[corner]] = true;
+                removed |= m_welded[triangle[corner]] == m_welded[collapse.to];
+            }
+            removedTriangles += removed ? 1 : 0;
+        }
+        ++collapseCount;
+    }
+
+    if (collapseCount == 0)
+    {
+        return false;
+    }
+
+    // Remove the triangles that lost their area
+    size_t writeIndex = 0;
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        unsigned int a = m_remap[m_indices[i]];
+        unsigned int b = m_remap[m_indices[i + 1]];
+        unsigned int c = m_remap[m_indices[i + 2]];
+        if (m_welded[a] != m_welded[b] && m_welded[b] != m_welded[c] && m_welded[a] != m_welded[c])
+        {
+            m_indices[writeIndex++] = a;
+            m_indices[writeIndex++] = b;
+            m_indices[writeIndex++] = c;
+        }
+    }
+    m_indices.resize(writeIndex);
+
+    return true;
+}
+
+bool MeshSimplifier::FlipsTriangles(unsigned int from, unsigned int to) const
+{
+    const glm::vec3& newPosition = m_positions[to];
+    for (unsigned int adjacencyIndex = m_adjacencyOffsets[from]; adjacencyIndex < m_adjacencyOffsets[from + 1]; ++adjacencyIndex)
+    {
+        const unsigned int* triangle = &m_indices[m_adjacency[adjacencyIndex] * 3];
+
+        // Triangles on the edge disappear
+        glm::vec3 positions[3];
+        bool removed = false;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            removed |= m_welded[triangle[corner]] == m_welded[to];
+            positions[corner] = m_positions[triangle[corner]];
+        }
+        if (removed)
+        {
+            continue;
+        }
+
+        glm::vec3 oldNormal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+        if (oldNormal == glm::vec3(0.0f))
+        {
+            continue;
+        }
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            if (triangle[corner] == from)
+            {
+                positions[corner] = newPosition;
+            }
+        }
+        glm::vec3 newNormal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+
+        // Turning more than about 75 degrees, or collapsing to a line
+        if (glm::dot(oldNormal, newNormal) <= 0.25f * glm::length(oldNormal) * glm::length(newNormal))
+        {
+            return true;
+        }
+    }
+    return false;
+}
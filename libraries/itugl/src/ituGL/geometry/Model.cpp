@@ -56,6 +56,32 @@ void Model::ClearMaterials()
     m_materials.clear();
 }
 
+std::span<const float> Model::GetLodThresholds() const
+{
+    return m_lodThresholds;
+}
+
+void Model::SetLodThresholds(std::span<const float> lodThresholds)
+{
+    m_lodThresholds.assign(lodThresholds.begin(), lodThresholds.end());
+}
+
+unsigned int Model::SelectLod(float screenSize, unsigned int lodCount, unsigned int previousLod, float hysteresis) const
+{
+    unsigned int lod = 0;
+    while (lod + 1 < lodCount && lod < m_lodThresholds.size())
+    {
+        // Thresholds the previous level already passed are easier to stay below, the next ones are harder to reach
+        float threshold = m_lodThresholds[lod] * (lod < previousLod ? 1.0f + hysteresis : 1.0f - hysteresis);
+        if (screenSize >= threshold)
+        {
+            break;
+        }
+        ++lod;
+    }
+    return lod;
+}
+
 void Model::Draw()
 {
     if (m_mesh)
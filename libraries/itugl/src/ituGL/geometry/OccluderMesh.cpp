@@ -0,0 +1,40 @@
+#include <ituGL/geometry/OccluderMesh.h>
+
+#include <ituGL/scene/Bounds.h>
+#include <cassert>
+
+OccluderMesh::OccluderMesh()
+{
+}
+
+OccluderMesh::OccluderMesh(std::span<const glm::vec3> vertices, std::span<const unsigned int> indices)
+    : m_vertices(vertices.begin(), vertices.end()), m_indices(indices.begin(), indices.end())
+{
+    assert(m_indices.size() % 3 == 0);
+}
+
+OccluderMesh OccluderMesh::CreateBox(const AabbBounds& bounds)
+{
+    glm::vec3 min = bounds.GetMin();
+    glm::vec3 max = bounds.GetMax();
+
+    // Corner i takes the max in the axes of its bits: x = 1, y = 2, z = 4
+    glm::vec3 vertices[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        vertices[i] = glm::vec3(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+    }
+
+    // Two triangles per face. The rasterizer draws both sides, so the winding doesn't matter
+    const unsigned int indices[36] =
+    {
+        0, 2, 3,  0, 3, 1, // -Z
+        4, 5, 7,  4, 7, 6, // +Z
+        0, 4, 6,  0, 6, 2, // -X
+        1, 3, 7,  1, 7, 5, // +X
+        0, 1, 5,  0, 5, 4, // -Y
+        2, 6, 7,  2, 7, 3, // +Y
+    };
+
+    return OccluderMesh(vertices, indices);
+}
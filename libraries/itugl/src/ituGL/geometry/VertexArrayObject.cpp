@@ -1,6 +1,7 @@
 #include <ituGL/geometry/VertexArrayObject.h>
 
 #include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
 #ifndef NDEBUG
@@ -20,6 +21,10 @@ VertexArrayObject::VertexArrayObject() : Object(NullHandle)
 VertexArrayObject::~VertexArrayObject()
 {
     Handle& handle = GetHandle();
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        device->InvalidateVertexArray(handle);
+    }
     glDeleteVertexArrays(1, &handle);
 }
 
@@ -37,7 +42,7 @@ VertexArrayObject& VertexArrayObject::operator = (VertexArrayObject&& vao) noexc
 void VertexArrayObject::Bind() const
 {
     Handle handle = GetHandle();
-    glBindVertexArray(handle);
+    DeviceGL::GetInstance().BindVertexArray(handle);
 #ifndef NDEBUG
     s_boundHandle = handle;
 #endif
@@ -47,7 +52,7 @@ void VertexArrayObject::Bind() const
 void VertexArrayObject::Unbind()
 {
     Handle handle = NullHandle;
-    glBindVertexArray(handle);
+    DeviceGL::GetInstance().BindVertexArray(handle);
 #ifndef NDEBUG
     s_boundHandle = handle;
 #endif
@@ -81,3 +86,10 @@ void VertexArrayObject::SetAttribute(GLuint location, const VertexAttribute& att
     // Finally, we enable the VertexAttribute in this location
     glEnableVertexAttribArray(location);
 }
+
+// Sets how often the attribute in that location advances: 0 for every vertex, N for every N instances
+void VertexArrayObject::SetAttributeDivisor(GLuint location, GLuint divisor)
+{
+    assert(IsBound());
+    glVertexAttribDivisor(location, divisor);
+}
@@ -0,0 +1,235 @@
+#include <ituGL/renderer/BloomRenderPass.h>
+
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <algorithm>
+#include <cassert>
+
+static const char* s_vertexShaderSource = R"(#version 330 core
+layout (location = 0) in vec3 VertexPosition;
+
+out vec2 TexCoord;
+
+void main()
+{
+	TexCoord = VertexPosition.xy * 0.5 + 0.5;
+	gl_Position = vec4(VertexPosition, 1.0);
+}
+)";
+
+// 13 bilinear taps covering 6x6 texels of the bigger level: a box of 4x4 in the center, and 4 overlapping boxes of 2x2 around it
+// The overlap avoids the blocks that a plain 2x2 box leaves when the bright pixels move
+// The first level also keeps the bright pixels, like the bloom post effect
+static const char* s_downsampleFragmentShaderSource = R"(#version 330 core
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D SourceTexture;
+uniform int Prefilter;
+uniform vec2 Range;
+uniform float Intensity;
+
+vec3 Sample(vec2 offset, vec2 texelSize)
+{
+	return texture(SourceTexture, TexCoord + offset * texelSize).rgb;
+}
+
+void main()
+{
+	// The base level of the texture is the bigger level, so lod 0 reads it
+	vec2 texelSize = 1.0 / vec2(textureSize(SourceTexture, 0));
+
+	vec3 color = (Sample(vec2(-1, 1), texelSize) + Sample(vec2(1, 1), texelSize) + Sample(vec2(-1, -1), texelSize) + Sample(vec2(1, -1), texelSize)) * 0.125;
+	color += Sample(vec2(0, 0), texelSize) * 0.125;
+	color += (Sample(vec2(0, 2), texelSize) + Sample(vec2(-2, 0), texelSize) + Sample(vec2(2, 0), texelSize) + Sample(vec2(0, -2), texelSize)) * 0.0625;
+	color += (Sample(vec2(-2, 2), texelSize) + Sample(vec2(2, 2), texelSize) + Sample(vec2(-2, -2), texelSize) + Sample(vec2(2, -2), texelSize)) * 0.03125;
+
+	if (Prefilter != 0)
+	{
+		// Remap the luminance to the range, and clamp it between 0 and 1
+		float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+		float result = clamp((luminance - Range.x) / max(Range.y - Range.x, 0.0001), 0.0, 1.0);
+		color *= result * Intensity;
+	}
+
+	FragColor = vec4(color, 1.0);
+}
+)";
+
+// 3x3 tent filter on the smaller level, added to the bigger level by blending
+static const char* s_upsampleFragmentShaderSource = R"(#version 330 core
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D SourceTexture;
+
+vec3 Sample(vec2 offset, vec2 texelSize)
+{
+	return texture(SourceTexture, TexCoord + offset * texelSize).rgb;
+}
+
+void main()
+{
+	vec2 texelSize = 1.0 / vec2(textureSize(SourceTexture, 0));
+
+	vec3 color = Sample(vec2(0, 0), texelSize) * 4.0;
+	color += (Sample(vec2(-1, 0), texelSize) + Sample(vec2(1, 0), texelSize) + Sample(vec2(0, -1), texelSize) + Sample(vec2(0, 1), texelSize)) * 2.0;
+	color += Sample(vec2(-1, -1), texelSize) + Sample(vec2(1, -1), texelSize) + Sample(vec2(-1, 1), texelSize) + Sample(vec2(1, 1), texelSize);
+
+	// Alpha is not added, so the target keeps the alpha of its first level
+	FragColor = vec4(color / 16.0, 0.0);
+}
+)";
+
+BloomRenderPass::BloomRenderPass(std::shared_ptr<const Texture2DObject> sourceTexture, std::shared_ptr<const Texture2DObject> targetTexture,
+    std::shared_ptr<const FramebufferObject> targetFramebuffer, int width, int height, int maxLevelCount)
+    : RenderPass(targetFramebuffer), m_sourceTexture(sourceTexture), m_targetTexture(targetTexture)
+    , m_width(width), m_height(height), m_levelCount(1), m_range(2.0f, 3.0f), m_intensity(1.0f)
+{
+    assert(sourceTexture);
+    assert(targetTexture);
+    assert(targetFramebuffer);
+
+    // The smallest level keeps at least 2 texels, so the filters still have neighbours
+    while (m_levelCount < maxLevelCount && (std::min(width, height) >> m_levelCount) >= 2)
+    {
+        ++m_levelCount;
+    }
+
+    if (m_levelCount < 2)
+    {
+        return;
+    }
+
+    m_chainTexture = std::make_shared<Texture2DObject>();
+    m_chainTexture->Bind();
+    for (int level = 1; level < m_levelCount; ++level)
+    {
+        m_chainTexture->SetImage(level - 1, width >> level, height >> level, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F);
+    }
+    // Only the base level is read, so linear filtering without mipmaps is enough
+    m_chainTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    m_chainTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    m_chainTexture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+    m_chainTexture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+    m_chainTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, m_levelCount - 2);
+    Texture2DObject::Unbind();
+
+    for (int level = 1; level < m_levelCount; ++level)
+    {
+        std::shared_ptr<FramebufferObject> framebuffer = std::make_shared<FramebufferObject>();
+        framebuffer->Bind();
+        framebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_chainTexture, level - 1);
+        m_levelFramebuffers.push_back(framebuffer);
+    }
+    FramebufferObject::Unbind();
+}
+
+BloomRenderPass::~BloomRenderPass()
+{
+}
+
+void BloomRenderPass::InitializeShaderPrograms()
+{
+    Shader vertexShader(Shader::VertexShader);
+    vertexShader.SetSource(s_vertexShaderSource);
+    bool compiled = vertexShader.Compile();
+    assert(compiled);
+
+    Shader downsampleFragmentShader(Shader::FragmentShader);
+    downsampleFragmentShader.SetSource(s_downsampleFragmentShaderSource);
+    compiled = downsampleFragmentShader.Compile();
+    assert(compiled);
+
+    Shader upsampleFragmentShader(Shader::FragmentShader);
+    upsampleFragmentShader.SetSource(s_upsampleFragmentShaderSource);
+    compiled = upsampleFragmentShader.Compile();
+    assert(compiled);
+
+    m_downsampleShaderProgram = std::make_shared<ShaderProgram>();
+    bool built = m_downsampleShaderProgram->Build(vertexShader, downsampleFragmentShader);
+    assert(built);
+
+    m_upsampleShaderProgram = std::make_shared<ShaderProgram>();
+    built = m_upsampleShaderProgram->Build(vertexShader, upsampleFragmentShader);
+    assert(built);
+}
+
+void BloomRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    if (!m_downsampleShaderProgram)
+    {
+        InitializeShaderPrograms();
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    bool wasDepthTest = device.IsFeatureEnabled(GL_DEPTH_TEST);
+    device.SetFeatureEnabled(GL_DEPTH_TEST, false);
+    device.SetFeatureEnabled(GL_BLEND, false);
+
+    const Mesh& fullscreenMesh = renderer.GetFullscreenMesh();
+    TextureObject::SetActiveTexture(0);
+
+    // The target ends with the sum of all the levels, each with the energy of the bright pixels. Dividing by the count
+    // keeps the same brightness as a single blur
+    m_downsampleShaderProgram->Use();
+    m_downsampleShaderProgram->SetUniform(m_downsampleShaderProgram->GetUniformLocation("SourceTexture"), 0);
+    m_downsampleShaderProgram->SetUniform(m_downsampleShaderProgram->GetUniformLocation("Prefilter"), 1);
+    m_downsampleShaderProgram->SetUniform(m_downsampleShaderProgram->GetUniformLocation("Range"), m_range);
+    m_downsampleShaderProgram->SetUniform(m_downsampleShaderProgram->GetUniformLocation("Intensity"), m_intensity / m_levelCount);
+    m_sourceTexture->Bind();
+    renderer.SetCurrentFramebuffer(m_targetFramebuffer);
+    device.SetViewport(0, 0, m_width, m_height);
+    fullscreenMesh.DrawSubmesh(0);
+
+    if (m_chainTexture)
+    {
+        // Each level reads the previous one. Limiting the levels of the texture to it avoids a feedback loop with the written level
+        m_downsampleShaderProgram->SetUniform(m_downsampleShaderProgram->GetUniformLocation("Prefilter"), 0);
+        m_targetTexture->Bind();
+        for (int level = 1; level < m_levelCount; ++level)
+        {
+            if (level > 1)
+            {
+                m_chainTexture->Bind();
+                m_chainTexture->SetParameter(TextureObject::ParameterInt::BaseLevel, level - 2);
+                m_chainTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, level - 2);
+            }
+            renderer.SetCurrentFramebuffer(m_levelFramebuffers[level - 1]);
+            device.SetViewport(0, 0, m_width >> level, m_height >> level);
+            fullscreenMesh.DrawSubmesh(0);
+        }
+
+        // From the smallest level up, each level is blurred and added to the next bigger one, that already has its own downsample
+        m_upsampleShaderProgram->Use();
+        m_upsampleShaderProgram->SetUniform(m_upsampleShaderProgram->GetUniformLocation("SourceTexture"), 0);
+        device.SetFeatureEnabled(GL_BLEND, true);
+        device.SetBlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+        device.SetBlendFunction(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+        m_chainTexture->Bind();
+        for (int level = m_levelCount - 2; level >= 0; --level)
+        {
+            m_chainTexture->SetParameter(TextureObject::ParameterInt::BaseLevel, level);
+            m_chainTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, level);
+            renderer.SetCurrentFramebuffer(level > 0 ? m_levelFramebuffers[level - 1] : m_targetFramebuffer);
+            device.SetViewport(0, 0, m_width >> level, m_height >> level);
+            fullscreenMesh.DrawSubmesh(0);
+        }
+        m_chainTexture->SetParameter(TextureObject::ParameterInt::BaseLevel, 0);
+        m_chainTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, m_levelCount - 2);
+        device.SetFeatureEnabled(GL_BLEND, false);
+    }
+
+    device.SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    device.SetFeatureEnabled(GL_DEPTH_TEST, wasDepthTest);
+}
@@ -0,0 +1,87 @@
+#include <ituGL/renderer/ClusteredForwardRenderPass.h>
+
+#include <ituGL/camera/Camera.h>
+#include <ituGL/shader/Material.h>
+#include <ituGL/renderer/Renderer.h>
+
+ClusteredForwardRenderPass::ClusteredForwardRenderPass()
+    : ClusteredForwardRenderPass(0)
+{
+}
+
+ClusteredForwardRenderPass::ClusteredForwardRenderPass(int drawcallCollectionIndex)
+    : m_drawcallCollectionIndex(drawcallCollectionIndex)
+{
+}
+
+void ClusteredForwardRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+
+    const Camera& camera = renderer.GetCurrentCamera();
+    const auto& lights = renderer.GetLights();
+    const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
+    bool depthPrePass = renderer.IsDepthPrePassEnabled(m_drawcallCollectionIndex);
+
+    // Assign the lights to the clusters, and leave the data bound for all the drawcalls
+    m_lightClusters.Build(lights, camera, renderer.GetThreadPool());
+    m_lightClusters.Upload();
+
+    // Opaque drawcalls culled on the GPU go first. They are not in the depth pre-pass, so they use their own depth test
+    for (unsigned int gpuDrawcallIndex = 0; gpuDrawcallIndex < renderer.GetGpuDrawcallCount(m_drawcallCollectionIndex); ++gpuDrawcallIndex)
+    {
+        const Renderer::DrawcallInfo& drawcallInfo = renderer.PrepareGpuDrawcall(m_drawcallCollectionIndex, gpuDrawcallIndex);
+        const ShaderProgram& shaderProgram = drawcallInfo.GetMaterial().GetShaderProgramRef();
+        SetupShaderProgram(shaderProgram);
+
+        unsigned int lightIndex = 0;
+        renderer.UpdateLights(shaderProgram, {}, lightIndex);
+        renderer.SetLightingRenderStates(true);
+
+        renderer.DrawGpuDrawcall(m_drawcallCollectionIndex, gpuDrawcallIndex);
+    }
+
+    for (unsigned int drawcallIndex = 0; drawcallIndex < drawcallCollection.size(); )
+    {
+        const Renderer::DrawcallInfo& drawcallInfo = drawcallCollection[drawcallIndex];
+
+        // Drawcalls in the depth pre-pass keep its depth, and only shade the visible fragments
+        bool inDepthPrePass = depthPrePass && Renderer::IsInDepthPrePass(drawcallInfo);
+
+        // Prepare drawcall states, merging the following drawcalls as instances if possible
+        unsigned int instanceCount = renderer.PrepareInstancedDrawcall(drawcallCollection.subspan(drawcallIndex),
+            inDepthPrePass ? Material::OverrideDepthTest : Material::NoOverride);
+        drawcallIndex += instanceCount;
+        if (inDepthPrePass)
+        {
+            renderer.SetDepthPrePassRenderStates();
+        }
+
+        const ShaderProgram& shaderProgram = drawcallInfo.GetMaterial().GetShaderProgramRef();
+        SetupShaderProgram(shaderProgram);
+
+        // Only the first call is needed, to set the ambient light. The other lights come from the clusters
+        unsigned int lightIndex = 0;
+        renderer.UpdateLights(shaderProgram, {}, lightIndex);
+
+        // All the lights are drawn in a single pass
+        renderer.SetLightingRenderStates(true);
+
+        drawcallInfo.GetDrawcall().DrawInstanced(instanceCount);
+    }
+}
+
+void ClusteredForwardRenderPass::SetupShaderProgram(const ShaderProgram& shaderProgram)
+{
+    unsigned int id = shaderProgram.GetId();
+    if (id >= m_setupShaderPrograms.size())
+    {
+        m_setupShaderPrograms.resize(id + 1, false);
+    }
+
+    if (!m_setupShaderPrograms[id])
+    {
+        LightClusters::SetupShaderProgram(shaderProgram);
+        m_setupShaderPrograms[id] = true;
+    }
+}
@@ -3,13 +3,21 @@
 #include <ituGL/renderer/Renderer.h>
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/lighting/Light.h>
+#include <ituGL/lighting/PointLight.h>
+#include <ituGL/lighting/SpotLight.h>
 #include <ituGL/camera/Camera.h>
+#include <ituGL/scene/Bounds.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/texture/Texture2DObject.h>
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/constants.hpp>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 DeferredRenderPass::DeferredRenderPass(std::shared_ptr<Material> material, std::shared_ptr<const FramebufferObject> framebuffer)
-    : RenderPass(framebuffer), m_material(material)
+    : RenderPass(framebuffer), m_material(material), m_lightVolumeDepthTest(false)
 {
     InitializeMeshes();
 }
@@ -17,19 +25,28 @@ DeferredRenderPass::DeferredRenderPass(std::shared_ptr<Material> material, std::
 void DeferredRenderPass::Render()
 {
     Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
 
-    renderer.GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), false, 1.0f);
+    device.Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), false, 1.0f);
 
     const Camera& camera = renderer.GetCurrentCamera();
 
     assert(m_material);
     m_material->Use();
-    std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
+    const ShaderProgram& shaderProgram = m_material->GetShaderProgramRef();
 
     // Our fullscreen triangle is directly in clip coordinates.
     // Use the inverse view proj matrix to cancel view projection from the camera
     glm::mat4 fullscreenMatrix = glm::inverse(camera.GetViewProjectionMatrix());
 
+    // Lights outside of the view don't need to be drawn
+    FrustumBounds frustum(camera.GetViewProjectionMatrix());
+
+    // Lighting only reads the g-buffer depth, it must not be modified
+    device.SetDepthWrite(false);
+    // Volumes crossing the far plane are clamped instead of clipped, so their pixels are still shaded
+    device.EnableFeature(GL_DEPTH_CLAMP);
+
     bool first = true;
     unsigned int lightIndex = 0;
     const auto& lights = renderer.GetLights();
@@ -38,24 +55,204 @@ void DeferredRenderPass::Render()
         const Light* light = lightIndex <= lights.size() ? lights[lightIndex - 1] : nullptr;
         assert(first || light);
 
+        // The first pass also adds the indirect light, so it always covers the whole screen
         const Mesh* mesh = &renderer.GetFullscreenMesh();
         glm::mat4 worldMatrix = fullscreenMatrix;
-
-        // TODO: select different meshes depending on the type
+        if (!first)
+        {
+            if (const Mesh* volumeMesh = GetLightVolume(*light, worldMatrix))
+            {
+                // The range of the light is a sphere around its position, for point and spot lights
+                SphereBounds lightBounds(light->GetPosition(), light->GetAttenuation().y);
+                if (!lightBounds.Intersects(frustum))
+                {
+                    continue;
+                }
+                mesh = volumeMesh;
+            }
+        }
 
         // Set the render states for the first and additional lights
         renderer.SetLightingRenderStates(first);
 
-        renderer.UpdateTransforms(shaderProgram, fullscreenMatrix, first);
+        if (mesh == &renderer.GetFullscreenMesh())
+        {
+            device.DisableFeature(GL_DEPTH_TEST);
+            device.SetCullFace(GL_BACK);
+        }
+        else
+        {
+            // Drawing the back faces covers the pixels inside the volume, even with the camera inside of it
+            // With the g-buffer depth, pixels where the surface is behind the volume are rejected as well
+            device.SetFeatureEnabled(GL_DEPTH_TEST, m_lightVolumeDepthTest);
+            device.SetDepthFunction(GL_GEQUAL);
+            device.SetCullFace(GL_FRONT);
+        }
+
+        renderer.UpdateTransforms(shaderProgram, worldMatrix, first);
         mesh->DrawSubmesh(0);
         first = false;
     }
 
-    //TODO: temp hack
-    renderer.GetDevice().EnableFeature(GL_DEPTH_TEST);
+    // Restore the states expected by the other passes
+    device.EnableFeature(GL_DEPTH_TEST);
+    device.DisableFeature(GL_DEPTH_CLAMP);
+    device.SetCullFace(GL_BACK);
+}
+
+const Mesh* DeferredRenderPass::GetLightVolume(const Light& light, glm::mat4& worldMatrix) const
+{
+    switch (light.GetType())
+    {
+    case Light::Type::Point:
+    {
+        const PointLight& pointLight = static_cast<const PointLight&>(light);
+        float range = pointLight.GetDistanceAttenuation().y;
+        if (range <= 0.0f)
+        {
+            return nullptr;
+        }
+        worldMatrix = glm::translate(pointLight.GetPosition()) * glm::scale(glm::vec3(range));
+        return &m_sphereMesh;
+    }
+    case Light::Type::Spot:
+    {
+        const SpotLight& spotLight = static_cast<const SpotLight&>(light);
+        float range = spotLight.GetDistanceAttenuation().y;
+        if (range <= 0.0f)
+        {
+            return nullptr;
+        }
+
+        // Wide cones are larger than the sphere of the same range: volume ratio is tan^2(angle) / 4
+        float angle = spotLight.GetAngleAttenuation().y;
+        float radiusScale = std::tan(angle);
+        if (angle <= 0.0f || angle >= glm::half_pi<float>() || radiusScale >= 2.0f)
+        {
+            worldMatrix = glm::translate(spotLight.GetPosition()) * glm::scale(glm::vec3(range));
+            return &m_sphereMesh;
+        }
+
+        worldMatrix = GetSpotLightConeMatrix(spotLight.GetPosition(), spotLight.GetDirection(), range, angle);
+        return &m_coneMesh;
+    }
+    default:
+        // Directional lights affect the whole screen
+        return nullptr;
+    }
+}
+
+glm::mat4 DeferredRenderPass::GetSpotLightConeMatrix(const glm::vec3& position, const glm::vec3& direction, float range, float angle)
+{
+    // The shaders light the points at -direction from the light, so the -Z axis of the cone is rotated there
+    // lookAt moves its target to -Z, and the inverse moves -Z back to the target
+    glm::vec3 litDirection = -glm::normalize(direction);
+    glm::vec3 up = std::abs(litDirection.y) < 0.99f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+    glm::mat4 rotationMatrix = glm::inverse(glm::lookAt(glm::vec3(0.0f), litDirection, up));
+
+    float radius = range * std::tan(angle);
+    return glm::translate(position) * rotationMatrix * glm::scale(glm::vec3(radius, radius, range));
 }
 
 void DeferredRenderPass::InitializeMeshes()
 {
-    //TODO: Create meshes for spot and point lights
+    InitializeSphereMesh();
+    InitializeConeMesh();
+}
+
+void DeferredRenderPass::InitializeSphereMesh()
+{
+    // Icosahedron, with counter-clockwise faces seen from outside
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    std::vector<glm::vec3> vertices = {
+        glm::vec3(-1, t, 0), glm::vec3(1, t, 0), glm::vec3(-1, -t, 0), glm::vec3(1, -t, 0),
+        glm::vec3(0, -1, t), glm::vec3(0, 1, t), glm::vec3(0, -1, -t), glm::vec3(0, 1, -t),
+        glm::vec3(t, 0, -1), glm::vec3(t, 0, 1), glm::vec3(-t, 0, -1), glm::vec3(-t, 0, 1),
+    };
+    std::vector<unsigned short> indices = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1,
+    };
+    for (glm::vec3& vertex : vertices)
+    {
+        vertex = glm::normalize(vertex);
+    }
+
+    // Subdivide each triangle in 4, sharing the new vertex of each edge with the neighbour triangle
+    std::unordered_map<unsigned int, unsigned short> midpoints;
+    auto getMidpoint = [&](unsigned short a, unsigned short b)
+    {
+        unsigned int key = (std::min(a, b) << 16) | std::max(a, b);
+        auto itFind = midpoints.find(key);
+        if (itFind != midpoints.end())
+        {
+            return itFind->second;
+        }
+        unsigned short index = static_cast<unsigned short>(vertices.size());
+        vertices.push_back(glm::normalize(vertices[a] + vertices[b]));
+        midpoints[key] = index;
+        return index;
+    };
+
+    std::vector<unsigned short> subdividedIndices;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        unsigned short a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        unsigned short ab = getMidpoint(a, b), bc = getMidpoint(b, c), ca = getMidpoint(c, a);
+        subdividedIndices.insert(subdividedIndices.end(), { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca });
+    }
+
+    // Vertices are on the unit sphere, so the faces cut inside it. Scale up so that the closest face is at distance 1
+    float minDistance = 1.0f;
+    for (size_t i = 0; i < subdividedIndices.size(); i += 3)
+    {
+        const glm::vec3& a = vertices[subdividedIndices[i]];
+        const glm::vec3& b = vertices[subdividedIndices[i + 1]];
+        const glm::vec3& c = vertices[subdividedIndices[i + 2]];
+        glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+        minDistance = std::min(minDistance, glm::dot(normal, a));
+    }
+    for (glm::vec3& vertex : vertices)
+    {
+        vertex /= minDistance;
+    }
+
+    VertexFormat vertexFormat;
+    vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+    m_sphereMesh.AddSubmesh<glm::vec3, unsigned short, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, subdividedIndices,
+        vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), false), vertexFormat.LayoutEnd());
+}
+
+void DeferredRenderPass::InitializeConeMesh()
+{
+    // The base polygon must contain the unit circle, so its vertices are a bit further away
+    const unsigned short segmentCount = 16;
+    const float baseRadius = 1.0f / std::cos(glm::pi<float>() / segmentCount);
+
+    // Apex, center of the base, and the base ring
+    std::vector<glm::vec3> vertices;
+    vertices.emplace_back(0.0f, 0.0f, 0.0f);
+    vertices.emplace_back(0.0f, 0.0f, -1.0f);
+    for (unsigned short i = 0; i < segmentCount; ++i)
+    {
+        float angle = glm::two_pi<float>() * i / segmentCount;
+        vertices.emplace_back(baseRadius * std::cos(angle), baseRadius * std::sin(angle), -1.0f);
+    }
+
+    // Counter-clockwise faces seen from outside
+    std::vector<unsigned short> indices;
+    for (unsigned short i = 0; i < segmentCount; ++i)
+    {
+        unsigned short current = 2 + i;
+        unsigned short next = 2 + (i + 1) % segmentCount;
+        indices.insert(indices.end(), { 0, current, next });
+        indices.insert(indices.end(), { 1, next, current });
+    }
+
+    VertexFormat vertexFormat;
+    vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+    m_coneMesh.AddSubmesh<glm::vec3, unsigned short, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, indices,
+        vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), false), vertexFormat.LayoutEnd());
 }
@@ -0,0 +1,153 @@
+#include <ituGL/renderer/DepthPrePassRenderPass.h>
+
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <algorithm>
+#include <cassert>
+
+// Same position as the vertex shaders of the collection, so both produce the same depth
+static const char* s_vertexShaderSource = R"(#version 330 core
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 12) in mat4 InstanceWorldMatrix;
+
+layout(std140) uniform FrameUniforms
+{
+	mat4 ViewMatrix;
+	mat4 ProjMatrix;
+	mat4 ViewProjMatrix;
+	mat4 InvViewMatrix;
+	mat4 InvProjMatrix;
+	mat4 InvViewProjMatrix;
+	vec3 CameraPosition;
+	float Time;
+};
+
+invariant gl_Position;
+
+void main()
+{
+	mat4 WorldMatrix = InstanceWorldMatrix;
+	gl_Position = ViewProjMatrix * (WorldMatrix * vec4(VertexPosition, 1.0));
+}
+)";
+
+static const char* s_fragmentShaderSource = R"(#version 330 core
+void main()
+{
+}
+)";
+
+DepthPrePassRenderPass::DepthPrePassRenderPass(int drawcallCollectionIndex, std::shared_ptr<const FramebufferObject> targetFramebuffer, bool clearDepth)
+    : RenderPass(targetFramebuffer)
+    , m_drawcallCollectionIndex(drawcallCollectionIndex)
+    , m_clearDepth(clearDepth)
+    , m_instanceGroupCount(0)
+{
+}
+
+DepthPrePassRenderPass::~DepthPrePassRenderPass()
+{
+}
+
+void DepthPrePassRenderPass::InitializeShaderProgram()
+{
+    Shader vertexShader(Shader::VertexShader);
+    vertexShader.SetSource(s_vertexShaderSource);
+    bool compiled = vertexShader.Compile();
+    assert(compiled);
+
+    Shader fragmentShader(Shader::FragmentShader);
+    fragmentShader.SetSource(s_fragmentShaderSource);
+    compiled = fragmentShader.Compile();
+    assert(compiled);
+
+    m_shaderProgram = std::make_shared<ShaderProgram>();
+    bool built = m_shaderProgram->Build(vertexShader, fragmentShader);
+    assert(built);
+
+    // Registering binds the frame uniforms. The world matrices come from the instance buffer, so there are no hooks
+    GetRenderer().RegisterShaderProgram(m_shaderProgram, nullptr, nullptr);
+    assert(GetRenderer().IsInstancingSupported(*m_shaderProgram));
+}
+
+void DepthPrePassRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    if (!renderer.IsDepthPrePassEnabled(m_drawcallCollectionIndex))
+    {
+        return;
+    }
+
+    if (m_clearDepth)
+    {
+        device.Clear(false, Color(), true, 1.0f);
+    }
+
+    if (!m_shaderProgram)
+    {
+        InitializeShaderProgram();
+    }
+
+    const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
+
+    // Sort the drawcalls front to back, so the closest surfaces are drawn first and the rest fail the depth test early
+    m_sortedDrawcalls.clear();
+    for (unsigned int drawcallIndex = 0; drawcallIndex < drawcallCollection.size(); ++drawcallIndex)
+    {
+        const Renderer::DrawcallInfo& drawcallInfo = drawcallCollection[drawcallIndex];
+        if (Renderer::IsInDepthPrePass(drawcallInfo))
+        {
+            m_sortedDrawcalls.emplace_back(renderer.GetViewDepth(drawcallInfo), drawcallIndex);
+        }
+    }
+    std::sort(m_sortedDrawcalls.begin(), m_sortedDrawcalls.end());
+
+    // Group the drawcalls of the same mesh, in the order of their closest instance
+    for (unsigned int groupIndex = 0; groupIndex < m_instanceGroupCount; ++groupIndex)
+    {
+        m_instanceGroups[groupIndex].worldMatrices.clear();
+    }
+    m_instanceGroupCount = 0;
+    m_instanceGroupIndices.clear();
+    for (const auto& sortedDrawcall : m_sortedDrawcalls)
+    {
+        const Renderer::DrawcallInfo& drawcallInfo = drawcallCollection[sortedDrawcall.second];
+
+        // Drawcalls are owned by the meshes, together with their VAO. The same drawcall always has the same VAO
+        auto itGroup = m_instanceGroupIndices.try_emplace(&drawcallInfo.GetDrawcall(), m_instanceGroupCount).first;
+        if (itGroup->second == m_instanceGroupCount)
+        {
+            if (m_instanceGroupCount == m_instanceGroups.size())
+            {
+                m_instanceGroups.emplace_back();
+            }
+            InstanceGroup& instanceGroup = m_instanceGroups[m_instanceGroupCount++];
+            instanceGroup.vao = &drawcallInfo.GetVAO();
+            instanceGroup.drawcall = &drawcallInfo.GetDrawcall();
+        }
+        assert(m_instanceGroups[itGroup->second].vao == &drawcallInfo.GetVAO());
+        m_instanceGroups[itGroup->second].worldMatrices.push_back(renderer.GetWorldMatrix(drawcallInfo));
+    }
+
+    // Only depth is written. Color attachments keep their contents
+    device.SetFeatureEnabled(GL_BLEND, false);
+    device.SetDepthFunction(GL_LESS);
+    device.SetDepthWrite(true);
+    device.SetColorWrite(false);
+
+    m_shaderProgram->Use();
+    for (unsigned int groupIndex = 0; groupIndex < m_instanceGroupCount; ++groupIndex)
+    {
+        const InstanceGroup& instanceGroup = m_instanceGroups[groupIndex];
+        instanceGroup.vao->Bind();
+        renderer.SetInstanceWorldMatrices(*instanceGroup.vao, instanceGroup.worldMatrices);
+        instanceGroup.drawcall->DrawInstanced(static_cast<GLsizei>(instanceGroup.worldMatrices.size()));
+    }
+
+    device.SetColorWrite(true);
+}
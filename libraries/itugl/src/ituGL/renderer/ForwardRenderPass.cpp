@@ -22,14 +22,42 @@ void ForwardRenderPass::Render()
     const Camera& camera = renderer.GetCurrentCamera();
     const auto& lights = renderer.GetLights();
     const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
+    bool depthPrePass = renderer.IsDepthPrePassEnabled(m_drawcallCollectionIndex);
+
+    // Opaque drawcalls culled on the GPU go first. They are not in the depth pre-pass, so they use their own depth test
+    for (unsigned int gpuDrawcallIndex = 0; gpuDrawcallIndex < renderer.GetGpuDrawcallCount(m_drawcallCollectionIndex); ++gpuDrawcallIndex)
+    {
+        const Renderer::DrawcallInfo& drawcallInfo = renderer.PrepareGpuDrawcall(m_drawcallCollectionIndex, gpuDrawcallIndex);
+        const ShaderProgram& shaderProgram = drawcallInfo.GetMaterial().GetShaderProgramRef();
+
+        bool first = true;
+        unsigned int lightIndex = 0;
+        while (renderer.UpdateLights(shaderProgram, lights, lightIndex))
+        {
+            renderer.SetLightingRenderStates(first);
+            renderer.DrawGpuDrawcall(m_drawcallCollectionIndex, gpuDrawcallIndex);
+            first = false;
+        }
+    }
 
     // for all drawcalls
-    for (const Renderer::DrawcallInfo& drawcallInfo : drawcallCollection)
+    for (unsigned int drawcallIndex = 0; drawcallIndex < drawcallCollection.size(); )
     {
-        // Prepare drawcall states
-        renderer.PrepareDrawcall(drawcallInfo);
+        const Renderer::DrawcallInfo& drawcallInfo = drawcallCollection[drawcallIndex];
+
+        // Drawcalls in the depth pre-pass keep its depth, and only shade the visible fragments
+        bool inDepthPrePass = depthPrePass && Renderer::IsInDepthPrePass(drawcallInfo);
+
+        // Prepare drawcall states, merging the following drawcalls as instances if possible
+        unsigned int instanceCount = renderer.PrepareInstancedDrawcall(drawcallCollection.subspan(drawcallIndex),
+            inDepthPrePass ? Material::OverrideDepthTest : Material::NoOverride);
+        drawcallIndex += instanceCount;
+        if (inDepthPrePass)
+        {
+            renderer.SetDepthPrePassRenderStates();
+        }
 
-        std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.GetMaterial().GetShaderProgram();
+        const ShaderProgram& shaderProgram = drawcallInfo.GetMaterial().GetShaderProgramRef();
 
         //for all lights
         bool first = true;
@@ -40,7 +68,7 @@ void ForwardRenderPass::Render()
             renderer.SetLightingRenderStates(first);
 
             // Draw
-            drawcallInfo.GetDrawcall().Draw();
+            drawcallInfo.GetDrawcall().DrawInstanced(instanceCount);
 
             first = false;
         }
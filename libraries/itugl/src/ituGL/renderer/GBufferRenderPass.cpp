@@ -85,24 +85,40 @@ void GBufferRenderPass::Render()
     const auto& lights = renderer.GetLights();
     const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
 
-    renderer.GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), true, 1.0f);
+    // With the depth pre-pass, the depth is already drawn and the g-buffer only shades the visible fragments
+    bool depthPrePass = renderer.IsDepthPrePassEnabled(m_drawcallCollectionIndex);
+    renderer.GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), !depthPrePass, 1.0f);
 
     bool wasSRGB = renderer.GetDevice().IsFeatureEnabled(GL_FRAMEBUFFER_SRGB);
     renderer.GetDevice().EnableFeature(GL_FRAMEBUFFER_SRGB);
 
+    // Drawcalls culled on the GPU are not in the depth pre-pass, so they use their own depth test
+    for (unsigned int gpuDrawcallIndex = 0; gpuDrawcallIndex < renderer.GetGpuDrawcallCount(m_drawcallCollectionIndex); ++gpuDrawcallIndex)
+    {
+        renderer.PrepareGpuDrawcall(m_drawcallCollectionIndex, gpuDrawcallIndex);
+        renderer.DrawGpuDrawcall(m_drawcallCollectionIndex, gpuDrawcallIndex);
+    }
+
     // for all drawcalls
-    for (const Renderer::DrawcallInfo& drawcallInfo : drawcallCollection)
+    for (unsigned int drawcallIndex = 0; drawcallIndex < drawcallCollection.size(); )
     {
+        const Renderer::DrawcallInfo& drawcallInfo = drawcallCollection[drawcallIndex];
         const Material& material = drawcallInfo.GetMaterial();
         assert(material.GetBlendEquationColor() == Material::BlendEquation::None);
         assert(material.GetBlendEquationAlpha() == Material::BlendEquation::None);
         assert(material.GetDepthWrite());
 
-        // Prepare drawcall (similar to forward)
-        renderer.PrepareDrawcall(drawcallInfo);
+        // Prepare drawcall (similar to forward), merging the following drawcalls as instances if possible
+        unsigned int instanceCount = renderer.PrepareInstancedDrawcall(drawcallCollection.subspan(drawcallIndex),
+            depthPrePass ? Material::OverrideDepthTest : Material::NoOverride);
+        drawcallIndex += instanceCount;
+        if (depthPrePass)
+        {
+            renderer.SetDepthPrePassRenderStates();
+        }
 
         // Render drawcall
-        drawcallInfo.GetDrawcall().Draw();
+        drawcallInfo.GetDrawcall().DrawInstanced(instanceCount);
     }
 
     renderer.GetDevice().SetFeatureEnabled(GL_FRAMEBUFFER_SRGB, wasSRGB);
@@ -0,0 +1,243 @@
+#include <ituGL/renderer/GpuCuller.h>
+
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <cassert>
+
+// One thread per instance. Visible instances take the next slot of their command, so the order inside a command can change
+static const char* s_computeShaderSource = R"(#version 430 core
+layout (local_size_x = 64) in;
+
+struct Instance
+{
+	mat4 WorldMatrix;
+	vec4 BoundsCenter;
+	vec4 BoundsSize;
+};
+
+struct DrawCommand
+{
+	uint Count;
+	uint InstanceCount;
+	uint FirstIndex;
+	int BaseVertex;
+	uint BaseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Instances
+{
+	Instance instances[];
+};
+
+layout (std430, binding = 1) buffer DrawCommands
+{
+	DrawCommand commands[];
+};
+
+layout (std430, binding = 2) writeonly buffer WorldMatrices
+{
+	mat4 worldMatrices[];
+};
+
+uniform uint InstanceCount;
+uniform mat4 ViewProjMatrix;
+
+uniform int HiZEnabled;
+uniform mat4 HiZViewProjMatrix;
+uniform int HiZLevelCount;
+uniform sampler2D HiZTexture;
+
+// Outside if all the corners are on the outer side of the same clip plane
+bool IsInFrustum(vec3 corners[8])
+{
+	vec3 belowCount = vec3(0);
+	vec3 aboveCount = vec3(0);
+	for (int i = 0; i < 8; ++i)
+	{
+		vec4 clipPosition = ViewProjMatrix * vec4(corners[i], 1);
+		belowCount += vec3(lessThan(clipPosition.xyz, -clipPosition.www));
+		aboveCount += vec3(greaterThan(clipPosition.xyz, clipPosition.www));
+	}
+	return !any(equal(belowCount, vec3(8))) && !any(equal(aboveCount, vec3(8)));
+}
+
+// Hidden if the nearest corner is farther than all the depth under the screen rectangle
+// The level is chosen so the rectangle covers at most 2x2 texels, read at its corners
+bool IsOccluded(vec3 corners[8])
+{
+	vec3 minPosition = vec3(1e30);
+	vec3 maxPosition = vec3(-1e30);
+	for (int i = 0; i < 8; ++i)
+	{
+		vec4 clipPosition = HiZViewProjMatrix * vec4(corners[i], 1);
+
+		// Crossing the near plane, too close to be hidden
+		if (clipPosition.z < -clipPosition.w)
+		{
+			return false;
+		}
+
+		vec3 position = clipPosition.xyz / clipPosition.w * 0.5 + 0.5;
+		minPosition = min(minPosition, position);
+		maxPosition = max(maxPosition, position);
+	}
+
+	vec2 minCoords = clamp(minPosition.xy, 0.0, 1.0);
+	vec2 maxCoords = clamp(maxPosition.xy, 0.0, 1.0);
+	vec2 size = (maxCoords - minCoords) * vec2(textureSize(HiZTexture, 0));
+	float level = clamp(ceil(log2(max(max(size.x, size.y), 1.0))), 0.0, float(HiZLevelCount - 1));
+
+	float depth = max(max(textureLod(HiZTexture, minCoords, level).r, textureLod(HiZTexture, vec2(maxCoords.x, minCoords.y), level).r),
+		max(textureLod(HiZTexture, vec2(minCoords.x, maxCoords.y), level).r, textureLod(HiZTexture, maxCoords, level).r));
+	return minPosition.z > depth;
+}
+
+void main()
+{
+	uint instanceIndex = gl_GlobalInvocationID.x;
+	if (instanceIndex >= InstanceCount)
+	{
+		return;
+	}
+
+	Instance instance = instances[instanceIndex];
+	vec3 corners[8];
+	for (int i = 0; i < 8; ++i)
+	{
+		vec3 offset = vec3((i & 1) != 0 ? 1 : -1, (i & 2) != 0 ? 1 : -1, (i & 4) != 0 ? 1 : -1);
+		corners[i] = (instance.WorldMatrix * vec4(instance.BoundsCenter.xyz + offset * instance.BoundsSize.xyz, 1)).xyz;
+	}
+
+	if (!IsInFrustum(corners) || (HiZEnabled != 0 && IsOccluded(corners)))
+	{
+		return;
+	}
+
+	uint commandIndex = uint(instance.BoundsCenter.w);
+	uint slot = atomicAdd(commands[commandIndex].InstanceCount, 1u);
+	worldMatrices[commands[commandIndex].BaseInstance + slot] = instance.WorldMatrix;
+}
+)";
+
+GpuCuller::GpuCuller()
+    : m_instanceCount(0), m_hiZLevelCount(0), m_hiZViewProjMatrix(1.0f)
+{
+}
+
+GpuCuller::~GpuCuller()
+{
+}
+
+bool GpuCuller::IsSupported()
+{
+    // The window asks for 4.1, but most drivers create the newest compatible context
+    return GLAD_GL_VERSION_4_3 != 0;
+}
+
+void GpuCuller::InitializeShaderProgram()
+{
+    Shader computeShader(Shader::ComputeShader);
+    computeShader.SetSource(s_computeShaderSource);
+    bool compiled = computeShader.Compile();
+    assert(compiled);
+
+    m_shaderProgram = std::make_shared<ShaderProgram>();
+    bool built = m_shaderProgram->Build(computeShader);
+    assert(built);
+}
+
+void GpuCuller::SetInstances(std::span<const Instance> instances, std::span<const DrawCommand> drawCommands)
+{
+    m_instanceCount = static_cast<unsigned int>(instances.size());
+    m_drawCommands.assign(drawCommands.begin(), drawCommands.end());
+    for (DrawCommand& drawCommand : m_drawCommands)
+    {
+        drawCommand.instanceCount = 0;
+    }
+
+    if (instances.empty())
+    {
+        return;
+    }
+
+    m_instanceBuffer.Bind();
+    m_instanceBuffer.AllocateData(Data::GetBytes(instances), BufferObject::StaticDraw);
+
+    // Room for all the instances visible
+    m_worldMatrixBuffer.Bind();
+    m_worldMatrixBuffer.AllocateData(instances.size() * sizeof(glm::mat4), BufferObject::DynamicCopy);
+    VertexBufferObject::Unbind();
+}
+
+void GpuCuller::SetHiZ(std::shared_ptr<const Texture2DObject> hiZTexture, int levelCount, const glm::mat4& viewProjMatrix)
+{
+    m_hiZTexture = hiZTexture;
+    m_hiZLevelCount = levelCount;
+    m_hiZViewProjMatrix = viewProjMatrix;
+}
+
+void GpuCuller::InvalidateHiZ()
+{
+    m_hiZTexture = nullptr;
+}
+
+void GpuCuller::Cull(const glm::mat4& viewProjMatrix)
+{
+    if (m_instanceCount == 0)
+    {
+        return;
+    }
+
+    if (!m_shaderProgram)
+    {
+        InitializeShaderProgram();
+    }
+
+    // Commands start empty every frame. Allocating again orphans the buffer read by the previous frame
+    m_drawCommandBuffer.Bind();
+    m_drawCommandBuffer.AllocateData(Data::GetBytes(std::span<const DrawCommand>(m_drawCommands)), BufferObject::StreamDraw);
+
+    m_instanceBuffer.BindBase(0);
+    m_drawCommandBuffer.BindBase(BufferObject::ShaderStorageBuffer, 1);
+    m_worldMatrixBuffer.BindBase(BufferObject::ShaderStorageBuffer, 2);
+
+    const ShaderProgram& shaderProgram = *m_shaderProgram;
+    shaderProgram.Use();
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("InstanceCount"), static_cast<GLuint>(m_instanceCount));
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("ViewProjMatrix"), viewProjMatrix);
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("HiZEnabled"), m_hiZTexture ? 1 : 0);
+    if (m_hiZTexture)
+    {
+        shaderProgram.SetUniform(shaderProgram.GetUniformLocation("HiZViewProjMatrix"), m_hiZViewProjMatrix);
+        shaderProgram.SetUniform(shaderProgram.GetUniformLocation("HiZLevelCount"), m_hiZLevelCount);
+        shaderProgram.SetUniform(shaderProgram.GetUniformLocation("HiZTexture"), 0);
+        TextureObject::SetActiveTexture(0);
+        m_hiZTexture->Bind();
+    }
+
+    glDispatchCompute((m_instanceCount + 63) / 64, 1, 1);
+
+    // The drawcalls read the commands and the world matrices written by the shader
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+void GpuCuller::Draw(unsigned int firstCommand, unsigned int commandCount, Drawcall::Primitive primitive, Data::Type eboType) const
+{
+    assert(VertexArrayObject::IsAnyBound());
+    assert(eboType != Data::Type::None);
+    assert(firstCommand + commandCount <= m_drawCommands.size());
+
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        // Only the GPU knows how many instances are drawn
+        device->AddDrawcallStats(true, 0, 0, 0);
+    }
+
+    m_drawCommandBuffer.Bind();
+    const char* basePointer = nullptr; // Commands are read from the indirect buffer
+    glMultiDrawElementsIndirect(static_cast<GLenum>(primitive), static_cast<GLenum>(eboType),
+        basePointer + firstCommand * sizeof(DrawCommand), commandCount, 0);
+}
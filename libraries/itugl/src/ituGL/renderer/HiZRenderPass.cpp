@@ -0,0 +1,192 @@
+#include <ituGL/renderer/HiZRenderPass.h>
+
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <algorithm>
+#include <cassert>
+
+static const char* s_vertexShaderSource = R"(#version 330 core
+layout (location = 0) in vec3 VertexPosition;
+
+void main()
+{
+	gl_Position = vec4(VertexPosition, 1.0);
+}
+)";
+
+// First level: same size as the depth texture
+static const char* s_copyFragmentShaderSource = R"(#version 330 core
+uniform sampler2D SourceTexture;
+
+out float FragDepth;
+
+void main()
+{
+	FragDepth = texelFetch(SourceTexture, ivec2(gl_FragCoord.xy), 0).r;
+}
+)";
+
+// Next levels: the farthest of the 2x2 texels below. With odd sizes, the last texel also takes the extra row or column
+static const char* s_reduceFragmentShaderSource = R"(#version 330 core
+uniform sampler2D SourceTexture;
+
+out float FragDepth;
+
+float GetDepth(ivec2 coords, ivec2 maxCoords)
+{
+	return texelFetch(SourceTexture, min(coords, maxCoords), 0).r;
+}
+
+void main()
+{
+	// The base level of the texture is the previous level, so lod 0 reads it
+	ivec2 sourceSize = textureSize(SourceTexture, 0);
+	ivec2 maxCoords = sourceSize - 1;
+	ivec2 coords = ivec2(gl_FragCoord.xy) * 2;
+
+	float depth = max(max(GetDepth(coords, maxCoords), GetDepth(coords + ivec2(1, 0), maxCoords)),
+		max(GetDepth(coords + ivec2(0, 1), maxCoords), GetDepth(coords + ivec2(1, 1), maxCoords)));
+
+	bool extraColumn = (sourceSize.x & 1) != 0 && coords.x + 3 == sourceSize.x;
+	bool extraRow = (sourceSize.y & 1) != 0 && coords.y + 3 == sourceSize.y;
+	if (extraColumn)
+	{
+		depth = max(depth, max(GetDepth(coords + ivec2(2, 0), maxCoords), GetDepth(coords + ivec2(2, 1), maxCoords)));
+	}
+	if (extraRow)
+	{
+		depth = max(depth, max(GetDepth(coords + ivec2(0, 2), maxCoords), GetDepth(coords + ivec2(1, 2), maxCoords)));
+	}
+	if (extraColumn && extraRow)
+	{
+		depth = max(depth, GetDepth(coords + ivec2(2, 2), maxCoords));
+	}
+
+	FragDepth = depth;
+}
+)";
+
+HiZRenderPass::HiZRenderPass(std::shared_ptr<const Texture2DObject> depthTexture, int width, int height)
+    : m_depthTexture(depthTexture), m_width(width), m_height(height)
+{
+    assert(depthTexture);
+
+    // Every level down to 1x1, so any rectangle fits in 2x2 texels of some level
+    int levelCount = 1;
+    while ((std::max(width, height) >> levelCount) > 0)
+    {
+        ++levelCount;
+    }
+
+    m_hiZTexture = std::make_shared<Texture2DObject>();
+    m_hiZTexture->Bind();
+    for (int level = 0; level < levelCount; ++level)
+    {
+        m_hiZTexture->SetImage(level, std::max(width >> level, 1), std::max(height >> level, 1), TextureObject::FormatR, TextureObject::InternalFormatR32F);
+    }
+    m_hiZTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST_MIPMAP_NEAREST);
+    m_hiZTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    m_hiZTexture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+    m_hiZTexture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+    m_hiZTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, levelCount - 1);
+    Texture2DObject::Unbind();
+
+    for (int level = 0; level < levelCount; ++level)
+    {
+        std::shared_ptr<FramebufferObject> framebuffer = std::make_shared<FramebufferObject>();
+        framebuffer->Bind();
+        framebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_hiZTexture, level);
+        m_levelFramebuffers.push_back(framebuffer);
+    }
+    FramebufferObject::Unbind();
+}
+
+HiZRenderPass::~HiZRenderPass()
+{
+}
+
+void HiZRenderPass::InitializeShaderPrograms()
+{
+    Shader vertexShader(Shader::VertexShader);
+    vertexShader.SetSource(s_vertexShaderSource);
+    bool compiled = vertexShader.Compile();
+    assert(compiled);
+
+    Shader copyFragmentShader(Shader::FragmentShader);
+    copyFragmentShader.SetSource(s_copyFragmentShaderSource);
+    compiled = copyFragmentShader.Compile();
+    assert(compiled);
+
+    Shader reduceFragmentShader(Shader::FragmentShader);
+    reduceFragmentShader.SetSource(s_reduceFragmentShaderSource);
+    compiled = reduceFragmentShader.Compile();
+    assert(compiled);
+
+    m_copyShaderProgram = std::make_shared<ShaderProgram>();
+    bool built = m_copyShaderProgram->Build(vertexShader, copyFragmentShader);
+    assert(built);
+
+    m_reduceShaderProgram = std::make_shared<ShaderProgram>();
+    built = m_reduceShaderProgram->Build(vertexShader, reduceFragmentShader);
+    assert(built);
+}
+
+void HiZRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    // Nothing reads the depth pyramid without GPU culling
+    if (!renderer.IsGpuCullingActive())
+    {
+        return;
+    }
+
+    if (!m_copyShaderProgram)
+    {
+        InitializeShaderPrograms();
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    bool wasDepthTest = device.IsFeatureEnabled(GL_DEPTH_TEST);
+    device.SetFeatureEnabled(GL_DEPTH_TEST, false);
+    device.SetFeatureEnabled(GL_BLEND, false);
+
+    const Mesh& fullscreenMesh = renderer.GetFullscreenMesh();
+    TextureObject::SetActiveTexture(0);
+
+    // Sampling the depth as a value, not as a comparison
+    m_copyShaderProgram->Use();
+    m_copyShaderProgram->SetUniform(m_copyShaderProgram->GetUniformLocation("SourceTexture"), 0);
+    m_depthTexture->Bind();
+    renderer.SetCurrentFramebuffer(m_levelFramebuffers[0]);
+    device.SetViewport(0, 0, m_width, m_height);
+    fullscreenMesh.DrawSubmesh(0);
+
+    // Each level reads the previous one. Limiting the levels of the texture to it avoids a feedback loop with the written level
+    m_reduceShaderProgram->Use();
+    m_reduceShaderProgram->SetUniform(m_reduceShaderProgram->GetUniformLocation("SourceTexture"), 0);
+    m_hiZTexture->Bind();
+    int levelCount = GetLevelCount();
+    for (int level = 1; level < levelCount; ++level)
+    {
+        m_hiZTexture->SetParameter(TextureObject::ParameterInt::BaseLevel, level - 1);
+        m_hiZTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, level - 1);
+        renderer.SetCurrentFramebuffer(m_levelFramebuffers[level]);
+        device.SetViewport(0, 0, std::max(m_width >> level, 1), std::max(m_height >> level, 1));
+        fullscreenMesh.DrawSubmesh(0);
+    }
+    m_hiZTexture->SetParameter(TextureObject::ParameterInt::BaseLevel, 0);
+    m_hiZTexture->SetParameter(TextureObject::ParameterInt::MaxLevel, levelCount - 1);
+
+    device.SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    device.SetFeatureEnabled(GL_DEPTH_TEST, wasDepthTest);
+
+    // The culler tests the next frame against this depth, seen from this camera
+    renderer.GetGpuCuller().SetHiZ(m_hiZTexture, levelCount, renderer.GetFrameUniforms().viewProjMatrix);
+}
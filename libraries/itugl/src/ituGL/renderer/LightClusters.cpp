@@ -0,0 +1,261 @@
+#include <ituGL/renderer/LightClusters.h>
+
+#include <ituGL/camera/Camera.h>
+#include <ituGL/core/Data.h>
+#include <ituGL/core/ThreadPool.h>
+#include <ituGL/lighting/Light.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+LightClusters::LightClusters(unsigned int countX, unsigned int countY, unsigned int countZ)
+    : m_clusterCount(countX, countY, countZ)
+    , m_uniforms{ glm::uvec4(countX, countY, countZ, 0), glm::vec4(0.0f) }
+{
+    assert(countX > 0 && countY > 0 && countZ > 0);
+
+    m_uniformBuffer.Bind();
+    m_uniformBuffer.AllocateData(m_uniforms);
+
+    // Buffers are created when they are bound for the first time, and they must exist to be attached to the textures
+    m_lightDataBuffer.Bind();
+    m_lightDataBuffer.AllocateData(sizeof(glm::vec4) * TexelsPerLight, BufferObject::StreamDraw);
+    m_clusterRangesBuffer.Bind();
+    m_clusterRangesBuffer.AllocateData(sizeof(glm::uvec2), BufferObject::StreamDraw);
+    m_lightIndicesBuffer.Bind();
+    m_lightIndicesBuffer.AllocateData(sizeof(unsigned int), BufferObject::StreamDraw);
+
+    m_lightDataTexture.Bind();
+    m_lightDataTexture.SetBuffer(TextureObject::InternalFormatRGBA32F, m_lightDataBuffer);
+    m_clusterRangesTexture.Bind();
+    m_clusterRangesTexture.SetBuffer(TextureObject::InternalFormatRG32UI, m_clusterRangesBuffer);
+    m_lightIndicesTexture.Bind();
+    m_lightIndicesTexture.SetBuffer(TextureObject::InternalFormatR32UI, m_lightIndicesBuffer);
+
+    m_clusterRanges.resize(countX * countY * countZ);
+}
+
+void LightClusters::Build(std::span<const Light* const> lights, const Camera& camera, ThreadPool& threadPool)
+{
+    const glm::mat4& viewMatrix = camera.GetViewMatrix();
+    const glm::mat4& projMatrix = camera.GetProjectionMatrix();
+
+    // Near and far planes of the perspective projection
+    float nearPlane = projMatrix[3][2] / (projMatrix[2][2] - 1.0f);
+    float farPlane = projMatrix[3][2] / (projMatrix[2][2] + 1.0f);
+    assert(nearPlane > 0.0f && farPlane > nearPlane);
+
+    // slice = log(depth / near) / log(far / near) * countZ, written as log(depth) * scale + bias
+    float depthScale = m_clusterCount.z / std::log(farPlane / nearPlane);
+    float depthBias = -std::log(nearPlane) * depthScale;
+    m_uniforms.depthParams = glm::vec4(nearPlane, farPlane, depthScale, depthBias);
+
+    unsigned int lightCount = static_cast<unsigned int>(lights.size());
+    m_uniforms.clusterCount.w = lightCount;
+
+    // Cluster range and shader data of each light
+    m_lightRanges.resize(lightCount);
+    m_lightData.resize(lightCount * TexelsPerLight);
+    threadPool.ParallelFor(lightCount, 64, [&](unsigned int begin, unsigned int end, unsigned int taskIndex)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                const Light& light = *lights[i];
+                m_lightRanges[i] = ComputeLightRange(light, viewMatrix, projMatrix);
+
+                glm::vec4* lightData = &m_lightData[i * TexelsPerLight];
+                lightData[0] = glm::vec4(light.GetColor() * light.GetIntensity(), 0.0f);
+                lightData[1] = glm::vec4(light.GetPosition(), 1.0f);
+                lightData[2] = glm::vec4(light.GetDirection(), 0.0f);
+                lightData[3] = light.GetAttenuation();
+            }
+        });
+
+    // Fill the light indices of each group of depth slices in its own bucket, keeping the order of the lights
+    unsigned int taskCount = std::max(threadPool.GetTaskCount(m_clusterCount.z, 1), 1u);
+    if (m_sliceBuckets.size() < taskCount)
+    {
+        m_sliceBuckets.resize(taskCount);
+    }
+    threadPool.ParallelFor(m_clusterCount.z, 1, [&](unsigned int begin, unsigned int end, unsigned int taskIndex)
+        {
+            BuildSlices(begin, end, m_sliceBuckets[taskIndex]);
+        });
+
+    // Merge the buckets. Clusters are ordered by slice, so each bucket covers a contiguous group of clusters
+    m_lightIndices.clear();
+    for (unsigned int taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+    {
+        SliceBucket& bucket = m_sliceBuckets[taskIndex];
+        unsigned int offset = static_cast<unsigned int>(m_lightIndices.size());
+        if (offset > 0)
+        {
+            unsigned int beginCluster = GetClusterIndex(0, 0, bucket.beginSlice);
+            unsigned int endCluster = GetClusterIndex(0, 0, bucket.endSlice);
+            for (unsigned int clusterIndex = beginCluster; clusterIndex < endCluster; ++clusterIndex)
+            {
+                m_clusterRanges[clusterIndex].x += offset;
+            }
+        }
+        m_lightIndices.insert(m_lightIndices.end(), bucket.lightIndices.begin(), bucket.lightIndices.end());
+    }
+}
+
+void LightClusters::BuildSlices(unsigned int beginSlice, unsigned int endSlice, SliceBucket& bucket)
+{
+    bucket.beginSlice = beginSlice;
+    bucket.endSlice = endSlice;
+    bucket.lightIndices.clear();
+
+    unsigned int lightCount = static_cast<unsigned int>(m_lightRanges.size());
+    for (unsigned int z = beginSlice; z < endSlice; ++z)
+    {
+        // Lights in this slice, so the clusters only check their x and y ranges
+        bucket.sliceLights.clear();
+        for (unsigned int lightIndex = 0; lightIndex < lightCount; ++lightIndex)
+        {
+            const LightRange& range = m_lightRanges[lightIndex];
+            if (range.min.z <= z && z <= range.max.z)
+            {
+                bucket.sliceLights.push_back(lightIndex);
+            }
+        }
+
+        for (unsigned int y = 0; y < m_clusterCount.y; ++y)
+        {
+            for (unsigned int x = 0; x < m_clusterCount.x; ++x)
+            {
+                unsigned int offset = static_cast<unsigned int>(bucket.lightIndices.size());
+                for (unsigned int lightIndex : bucket.sliceLights)
+                {
+                    const LightRange& range = m_lightRanges[lightIndex];
+                    if (range.min.x <= x && x <= range.max.x && range.min.y <= y && y <= range.max.y)
+                    {
+                        bucket.lightIndices.push_back(lightIndex);
+                    }
+                }
+                unsigned int count = static_cast<unsigned int>(bucket.lightIndices.size()) - offset;
+                m_clusterRanges[GetClusterIndex(x, y, z)] = glm::uvec2(offset, count);
+            }
+        }
+    }
+}
+
+LightClusters::LightRange LightClusters::ComputeLightRange(const Light& light, const glm::mat4& viewMatrix, const glm::mat4& projMatrix) const
+{
+    LightRange fullRange = { glm::uvec3(0), m_clusterCount - 1u };
+    LightRange emptyRange = { glm::uvec3(1), glm::uvec3(0) };
+
+    // Lights without range, like directional lights, reach all the clusters
+    // Spot lights use the sphere of their range too, the angle is only checked by the shader
+    float radius = light.GetAttenuation().y;
+    if (radius <= 0.0f)
+    {
+        return fullRange;
+    }
+
+    glm::vec3 viewPosition = viewMatrix * glm::vec4(light.GetPosition(), 1.0f);
+    float depth = -viewPosition.z;
+
+    float nearPlane = m_uniforms.depthParams.x;
+    float farPlane = m_uniforms.depthParams.y;
+    if (depth + radius < nearPlane || depth - radius > farPlane)
+    {
+        return emptyRange;
+    }
+
+    LightRange range = fullRange;
+    range.min.z = GetDepthSlice(std::max(depth - radius, nearPlane));
+    range.max.z = GetDepthSlice(std::min(depth + radius, farPlane));
+
+    // If the sphere crosses the near plane, its projection can cover the whole screen
+    if (depth - radius > nearPlane)
+    {
+        // Bounding box of the sphere, projected. x / depth is extreme at the corners of the box
+        // ndc = P00 * x / depth - P20, and the same for y
+        float minDepth = depth - radius;
+        float maxDepth = depth + radius;
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            float minCoord = viewPosition[axis] - radius;
+            float maxCoord = viewPosition[axis] + radius;
+            float minRatio = std::min(minCoord / minDepth, minCoord / maxDepth);
+            float maxRatio = std::max(maxCoord / minDepth, maxCoord / maxDepth);
+
+            float scale = projMatrix[axis][axis];
+            float offset = projMatrix[2][axis];
+            float minNdc = scale * minRatio - offset;
+            float maxNdc = scale * maxRatio - offset;
+            if (minNdc > 1.0f || maxNdc < -1.0f)
+            {
+                return emptyRange;
+            }
+
+            float count = static_cast<float>(m_clusterCount[axis]);
+            range.min[axis] = static_cast<unsigned int>(std::clamp((minNdc * 0.5f + 0.5f) * count, 0.0f, count - 1.0f));
+            range.max[axis] = static_cast<unsigned int>(std::clamp((maxNdc * 0.5f + 0.5f) * count, 0.0f, count - 1.0f));
+        }
+    }
+
+    return range;
+}
+
+unsigned int LightClusters::GetDepthSlice(float depth) const
+{
+    float slice = std::log(depth) * m_uniforms.depthParams.z + m_uniforms.depthParams.w;
+    return static_cast<unsigned int>(std::clamp(slice, 0.0f, m_clusterCount.z - 1.0f));
+}
+
+void LightClusters::Upload()
+{
+    m_uniformBuffer.Bind();
+    m_uniformBuffer.UpdateData(m_uniforms);
+    m_uniformBuffer.BindBase(ClusterUniformsBinding);
+
+    // Keep at least one element, an empty buffer can't be read by the textures
+    m_lightDataBuffer.Bind();
+    if (m_lightData.empty())
+    {
+        m_lightDataBuffer.AllocateData(sizeof(glm::vec4) * TexelsPerLight, BufferObject::StreamDraw);
+    }
+    else
+    {
+        m_lightDataBuffer.AllocateData(Data::GetBytes(std::span<const glm::vec4>(m_lightData)), BufferObject::StreamDraw);
+    }
+
+    m_clusterRangesBuffer.Bind();
+    m_clusterRangesBuffer.AllocateData(Data::GetBytes(std::span<const glm::uvec2>(m_clusterRanges)), BufferObject::StreamDraw);
+
+    m_lightIndicesBuffer.Bind();
+    if (m_lightIndices.empty())
+    {
+        m_lightIndicesBuffer.AllocateData(sizeof(unsigned int), BufferObject::StreamDraw);
+    }
+    else
+    {
+        m_lightIndicesBuffer.AllocateData(Data::GetBytes(std::span<const unsigned int>(m_lightIndices)), BufferObject::StreamDraw);
+    }
+
+    // Materials assign their textures from unit 0, so these units stay bound while the scene is drawn
+    TextureObject::SetActiveTexture(LightDataTextureUnit);
+    m_lightDataTexture.Bind();
+    TextureObject::SetActiveTexture(ClusterRangesTextureUnit);
+    m_clusterRangesTexture.Bind();
+    TextureObject::SetActiveTexture(LightIndicesTextureUnit);
+    m_lightIndicesTexture.Bind();
+}
+
+void LightClusters::SetupShaderProgram(const ShaderProgram& shaderProgram)
+{
+    GLuint blockIndex = shaderProgram.GetUniformBlockIndex("LightClusterUniforms");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        shaderProgram.SetUniformBlockBinding(blockIndex, ClusterUniformsBinding);
+    }
+
+    // Samplers can't have a layout binding in GLSL 3.30, so they are assigned to the units here
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("LightDataTexture"), LightDataTextureUnit);
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("ClusterRangesTexture"), ClusterRangesTextureUnit);
+    shaderProgram.SetUniform(shaderProgram.GetUniformLocation("LightIndicesTexture"), LightIndicesTextureUnit);
+}
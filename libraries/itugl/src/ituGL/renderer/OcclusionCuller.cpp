@@ -0,0 +1,379 @@
+#include <ituGL/renderer/OcclusionCuller.h>
+
+#include <ituGL/core/ThreadPool.h>
+#include <ituGL/geometry/OccluderMesh.h>
+#include <ituGL/scene/Bounds.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+
+// ITUGL_OCCLUSION_NO_SSE2 forces the scalar path, to test it on machines with SSE2
+#if !defined(ITUGL_OCCLUSION_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ITUGL_OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+const int OcclusionCuller::TileSize;
+const int OcclusionCuller::BlockSize;
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+    : m_width(0), m_height(0), m_tileCountX(0), m_tileCountY(0)
+    , m_viewProjMatrix(1.0f), m_rasterized(false)
+{
+    SetResolution(width, height);
+}
+
+void OcclusionCuller::SetResolution(int width, int height)
+{
+    assert(width > 0 && width % BlockSize == 0);
+    assert(height > 0 && height % BlockSize == 0);
+
+    m_width = width;
+    m_height = height;
+    m_tileCountX = (width + TileSize - 1) / TileSize;
+    m_tileCountY = (height + TileSize - 1) / TileSize;
+
+    m_tileTriangles.resize(m_tileCountX * m_tileCountY);
+    m_depthBuffer.assign(width * height, 1.0f);
+    m_blockDepthBuffer.assign((width / BlockSize) * (height / BlockSize), 1.0f);
+    m_rasterized = false;
+}
+
+void OcclusionCuller::AddOccluder(const OccluderMesh& mesh, const glm::mat4& worldMatrix)
+{
+    m_occluders.emplace_back(&mesh, worldMatrix);
+}
+
+void OcclusionCuller::Clear()
+{
+    m_occluders.clear();
+    m_rasterized = false;
+}
+
+void OcclusionCuller::Rasterize(const glm::mat4& viewProjMatrix, ThreadPool& threadPool)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    m_viewProjMatrix = viewProjMatrix;
+    m_stats = Stats();
+    m_stats.occluders = static_cast<unsigned int>(m_occluders.size());
+
+    m_triangles.clear();
+    for (std::vector<unsigned int>& tileTriangles : m_tileTriangles)
+    {
+        tileTriangles.clear();
+    }
+
+    // Transform and set up the triangles in this thread. There are few of them, the pixels are the expensive part
+    for (const auto& [mesh, worldMatrix] : m_occluders)
+    {
+        glm::mat4 worldViewProjMatrix = viewProjMatrix * worldMatrix;
+
+        std::span<const glm::vec3> vertices = mesh->GetVertices();
+        m_clipPositions.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            m_clipPositions[i] = worldViewProjMatrix * glm::vec4(vertices[i], 1.0f);
+        }
+
+        std::span<const unsigned int> indices = mesh->GetIndices();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            AddTriangle(m_clipPositions[indices[i]], m_clipPositions[indices[i + 1]], m_clipPositions[indices[i + 2]]);
+        }
+        m_stats.triangles += mesh->GetTriangleCount();
+    }
+    m_stats.rasterizedTriangles = static_cast<unsigned int>(m_triangles.size());
+
+    // Bin the triangles in the tiles they overlap
+    for (unsigned int triangleIndex = 0; triangleIndex < m_triangles.size(); ++triangleIndex)
+    {
+        const Triangle& triangle = m_triangles[triangleIndex];
+        for (int tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; ++tileY)
+        {
+            for (int tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; ++tileX)
+            {
+                m_tileTriangles[tileY * m_tileCountX + tileX].push_back(triangleIndex);
+            }
+        }
+    }
+
+    // Tiles don't share pixels nor blocks, so they can be written without synchronization
+    threadPool.ParallelFor(static_cast<unsigned int>(m_tileTriangles.size()), 1, [this](unsigned int begin, unsigned int end, unsigned int)
+        {
+            for (unsigned int tileIndex = begin; tileIndex < end; ++tileIndex)
+            {
+                RasterizeTile(tileIndex);
+            }
+        });
+
+    m_rasterized = true;
+    m_stats.rasterTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void OcclusionCuller::AddTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2)
+{
+    // Signed distance to the near plane, positive in front. Clip coordinates are linear, so the crossing can be interpolated
+    const glm::vec4* clipPositions[3] = { &clip0, &clip1, &clip2 };
+    float distances[3];
+    int insideCount = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        distances[i] = clipPositions[i]->z + clipPositions[i]->w;
+        insideCount += distances[i] >= 0.0f;
+    }
+
+    if (insideCount == 3)
+    {
+        AddScreenTriangle(GetScreenPosition(clip0), GetScreenPosition(clip1), GetScreenPosition(clip2));
+        return;
+    }
+
+    // Walk the edges, keeping the vertices in front and adding the crossings. The result has 3 or 4 vertices
+    glm::vec3 polygon[4];
+    int polygonSize = 0;
+    for (int i = 0; i < 3 && insideCount > 0; ++i)
+    {
+        int next = (i + 1) % 3;
+        if (distances[i] >= 0.0f)
+        {
+            polygon[polygonSize++] = GetScreenPosition(*clipPositions[i]);
+        }
+        if ((distances[i] >= 0.0f) != (distances[next] >= 0.0f))
+        {
+            float t = distances[i] / (distances[i] - distances[next]);
+            polygon[polygonSize++] = GetScreenPosition(glm::mix(*clipPositions[i], *clipPositions[next], t));
+        }
+    }
+
+    for (int i = 2; i < polygonSize; ++i)
+    {
+        AddScreenTriangle(polygon[0], polygon[i - 1], polygon[i]);
+    }
+}
+
+glm::vec3 OcclusionCuller::GetScreenPosition(const glm::vec4& clipPosition) const
+{
+    // Pixels from the bottom left corner, and depth in [0, 1] like the default depth range
+    glm::vec3 ndcPosition = glm::vec3(clipPosition) / std::max(clipPosition.w, 1e-6f);
+    return glm::vec3((ndcPosition.x * 0.5f + 0.5f) * m_width, (ndcPosition.y * 0.5f + 0.5f) * m_height, ndcPosition.z * 0.5f + 0.5f);
+}
+
+void OcclusionCuller::AddScreenTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2)
+{
+    // Both sides are drawn: clockwise triangles are flipped, so the inside is always where the edge functions are positive
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (std::abs(area) < 1e-6f)
+    {
+        return;
+    }
+    const glm::vec3& p0 = v0;
+    const glm::vec3& p1 = area > 0.0f ? v1 : v2;
+    const glm::vec3& p2 = area > 0.0f ? v2 : v1;
+    area = std::abs(area);
+
+    // Pixels whose center can be inside. Triangles out of the screen are discarded here
+    Triangle triangle;
+    triangle.minX = std::max(static_cast<int>(std::floor(std::min({ p0.x, p1.x, p2.x }))), 0);
+    triangle.minY = std::max(static_cast<int>(std::floor(std::min({ p0.y, p1.y, p2.y }))), 0);
+    triangle.maxX = std::min(static_cast<int>(std::floor(std::max({ p0.x, p1.x, p2.x }))), m_width - 1);
+    triangle.maxY = std::min(static_cast<int>(std::floor(std::max({ p0.y, p1.y, p2.y }))), m_height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    {
+        return;
+    }
+
+    // Edge from a to b, positive on its left
+    auto setEdge = [&triangle](int edgeIndex, const glm::vec3& a, const glm::vec3& b)
+    {
+        triangle.edgeA[edgeIndex] = a.y - b.y;
+        triangle.edgeB[edgeIndex] = b.x - a.x;
+        triangle.edgeC[edgeIndex] = -(triangle.edgeA[edgeIndex] * a.x + triangle.edgeB[edgeIndex] * a.y);
+    };
+    setEdge(0, p0, p1);
+    setEdge(1, p1, p2);
+    setEdge(2, p2, p0);
+
+    // Depth after the perspective divide is linear in screen space
+    float depthX = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+    float depthY = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+    triangle.depthPlane = glm::vec3(depthX, depthY, p0.z - depthX * p0.x - depthY * p0.y);
+
+    m_triangles.push_back(triangle);
+}
+
+void OcclusionCuller::RasterizeTile(unsigned int tileIndex)
+{
+    int tileMinX = (tileIndex % m_tileCountX) * TileSize;
+    int tileMinY = (tileIndex / m_tileCountX) * TileSize;
+    int tileMaxX = std::min(tileMinX + TileSize, m_width) - 1;
+    int tileMaxY = std::min(tileMinY + TileSize, m_height) - 1;
+
+    for (int y = tileMinY; y <= tileMaxY; ++y)
+    {
+        std::fill_n(&m_depthBuffer[y * m_width + tileMinX], tileMaxX - tileMinX + 1, 1.0f);
+    }
+
+    for (unsigned int triangleIndex : m_tileTriangles[tileIndex])
+    {
+        const Triangle& triangle = m_triangles[triangleIndex];
+        RasterizeTriangle(triangle,
+            std::max(triangle.minX, tileMinX), std::max(triangle.minY, tileMinY),
+            std::min(triangle.maxX, tileMaxX), std::min(triangle.maxY, tileMaxY));
+    }
+
+    // Tiles are made of whole blocks, because the sizes are multiples of the block size
+    int blockCountX = m_width / BlockSize;
+    for (int blockY = tileMinY / BlockSize; blockY <= tileMaxY / BlockSize; ++blockY)
+    {
+        for (int blockX = tileMinX / BlockSize; blockX <= tileMaxX / BlockSize; ++blockX)
+        {
+            float maxDepth = 0.0f;
+            for (int y = blockY * BlockSize; y < (blockY + 1) * BlockSize; ++y)
+            {
+                const float* row = &m_depthBuffer[y * m_width + blockX * BlockSize];
+                maxDepth = std::max(maxDepth, *std::max_element(row, row + BlockSize));
+            }
+            m_blockDepthBuffer[blockY * blockCountX + blockX] = maxDepth;
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTriangle(const Triangle& triangle, int minX, int minY, int maxX, int maxY)
+{
+    // Groups of 4 pixels start aligned to 4. The tiles and the width are multiples of 4, so groups never leave the tile
+    minX &= ~3;
+
+#ifdef ITUGL_OCCLUSION_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]);
+    const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA[1]);
+    const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+    const __m128 depthX = _mm_set1_ps(triangle.depthPlane.x);
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        // Terms that only depend on the row
+        float pixelY = y + 0.5f;
+        __m128 edgeRow0 = _mm_set1_ps(triangle.edgeB[0] * pixelY + triangle.edgeC[0]);
+        __m128 edgeRow1 = _mm_set1_ps(triangle.edgeB[1] * pixelY + triangle.edgeC[1]);
+        __m128 edgeRow2 = _mm_set1_ps(triangle.edgeB[2] * pixelY + triangle.edgeC[2]);
+        __m128 depthRow = _mm_set1_ps(triangle.depthPlane.y * pixelY + triangle.depthPlane.z);
+
+        float* row = &m_depthBuffer[y * m_width];
+        for (int x = minX; x <= maxX; x += 4)
+        {
+            __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixelOffsets);
+            __m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), edgeRow0);
+            __m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), edgeRow1);
+            __m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), edgeRow2);
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+            if (_mm_movemask_ps(inside) == 0)
+            {
+                continue;
+            }
+
+            // Keep the nearest depth in the covered pixels
+            __m128 depth = _mm_add_ps(_mm_mul_ps(depthX, pixelX), depthRow);
+            __m128 oldDepth = _mm_loadu_ps(row + x);
+            __m128 newDepth = _mm_min_ps(oldDepth, depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, newDepth), _mm_andnot_ps(inside, oldDepth)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float pixelY = y + 0.5f;
+        float* row = &m_depthBuffer[y * m_width];
+        for (int x = minX; x <= maxX; x += 4)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                float pixelX = x + lane + 0.5f;
+                bool inside = true;
+                for (int edgeIndex = 0; edgeIndex < 3; ++edgeIndex)
+                {
+                    inside &= triangle.edgeA[edgeIndex] * pixelX + triangle.edgeB[edgeIndex] * pixelY + triangle.edgeC[edgeIndex] >= 0.0f;
+                }
+                if (inside)
+                {
+                    float depth = triangle.depthPlane.x * pixelX + triangle.depthPlane.y * pixelY + triangle.depthPlane.z;
+                    row[x + lane] = std::min(row[x + lane], depth);
+                }
+            }
+        }
+    }
+#endif
+}
+
+bool OcclusionCuller::IsVisible(const BoxBounds& box) const
+{
+    if (!m_rasterized)
+    {
+        return true;
+    }
+
+    // Screen rectangle and nearest depth of the corners
+    glm::mat3 scaledMatrix = box.GetScaledMatrix();
+    glm::vec2 screenMin(INFINITY);
+    glm::vec2 screenMax(-INFINITY);
+    float minDepth = INFINITY;
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner = box.GetCenter()
+            + scaledMatrix[0] * (i & 1 ? 1.0f : -1.0f)
+            + scaledMatrix[1] * (i & 2 ? 1.0f : -1.0f)
+            + scaledMatrix[2] * (i & 4 ? 1.0f : -1.0f);
+        glm::vec4 clipPosition = m_viewProjMatrix * glm::vec4(corner, 1.0f);
+
+        // Boxes crossing the near plane are too close to be hidden
+        if (clipPosition.z + clipPosition.w < 0.0f)
+        {
+            return true;
+        }
+
+        glm::vec3 screenPosition = GetScreenPosition(clipPosition);
+        screenMin = glm::min(screenMin, glm::vec2(screenPosition));
+        screenMax = glm::max(screenMax, glm::vec2(screenPosition));
+        minDepth = std::min(minDepth, screenPosition.z);
+    }
+
+    // Every pixel touched by the rectangle, not only the ones with the center inside
+    int minX = std::max(static_cast<int>(std::floor(screenMin.x)), 0);
+    int minY = std::max(static_cast<int>(std::floor(screenMin.y)), 0);
+    int maxX = std::min(static_cast<int>(std::floor(screenMax.x)), m_width - 1);
+    int maxY = std::min(static_cast<int>(std::floor(screenMax.y)), m_height - 1);
+    if (minX > maxX || minY > maxY)
+    {
+        return true;
+    }
+
+    // Blocks entirely in front of the box hide their part of it. Only the other ones need to check the pixels
+    int blockCountX = m_width / BlockSize;
+    for (int blockY = minY / BlockSize; blockY <= maxY / BlockSize; ++blockY)
+    {
+        for (int blockX = minX / BlockSize; blockX <= maxX / BlockSize; ++blockX)
+        {
+            if (m_blockDepthBuffer[blockY * blockCountX + blockX] < minDepth)
+            {
+                continue;
+            }
+
+            int blockMaxY = std::min((blockY + 1) * BlockSize - 1, maxY);
+            int blockMaxX = std::min((blockX + 1) * BlockSize - 1, maxX);
+            for (int y = std::max(blockY * BlockSize, minY); y <= blockMaxY; ++y)
+            {
+                for (int x = std::max(blockX * BlockSize, minX); x <= blockMaxX; ++x)
+                {
+                    if (m_depthBuffer[y * m_width + x] >= minDepth)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,114 @@
+#include <ituGL/renderer/PostFXComposer.h>
+
+#include <ituGL/shader/Shader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+static const char* s_headerSource = R"(#version 330 core
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D SourceTexture;
+)";
+
+PostFXComposer::PostFXComposer()
+{
+}
+
+void PostFXComposer::AddSharedSource(std::string_view source)
+{
+    m_sharedSources.emplace_back(source);
+}
+
+void PostFXComposer::AddSharedSourceFile(const char* path)
+{
+    m_sharedSources.push_back(ReadFile(path));
+}
+
+void PostFXComposer::AddStage(std::string_view name, std::string_view source)
+{
+    assert(!name.empty());
+    assert(std::none_of(m_stages.begin(), m_stages.end(), [name](const Stage& stage) { return stage.name == name; }));
+
+    // Replace every @ with the prefix of the stage
+    std::string prefix = std::string(name) + '_';
+    Stage stage{ std::string(name) };
+    stage.source.reserve(source.size());
+    for (char c : source)
+    {
+        if (c == '@')
+        {
+            stage.source += prefix;
+        }
+        else
+        {
+            stage.source += c;
+        }
+    }
+    m_stages.push_back(std::move(stage));
+}
+
+void PostFXComposer::AddStageFile(std::string_view name, const char* path)
+{
+    AddStage(name, ReadFile(path));
+}
+
+std::string PostFXComposer::GenerateFragmentShaderSource() const
+{
+    std::string source = s_headerSource;
+    for (const std::string& sharedSource : m_sharedSources)
+    {
+        source += '\n';
+        source += sharedSource;
+    }
+    for (const Stage& stage : m_stages)
+    {
+        source += "\n// Stage " + stage.name + "\n";
+        source += stage.source;
+    }
+
+    source += "\nvoid main()\n{\n\tvec4 color = texture(SourceTexture, TexCoord);\n";
+    for (const Stage& stage : m_stages)
+    {
+        source += "\tcolor = " + GetUniformName(stage.name, "Apply") + "(color, TexCoord);\n";
+    }
+    source += "\tFragColor = color;\n}\n";
+
+    return source;
+}
+
+std::shared_ptr<ShaderProgram> PostFXComposer::Build(const Shader& vertexShader) const
+{
+    std::string source = GenerateFragmentShaderSource();
+    Shader fragmentShader(Shader::FragmentShader);
+    fragmentShader.SetSource(source.c_str());
+    bool compiled = fragmentShader.Compile();
+    assert(compiled);
+
+    std::shared_ptr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>();
+    bool built = shaderProgram->Build(vertexShader, fragmentShader);
+    assert(built);
+
+    return shaderProgram;
+}
+
+std::string PostFXComposer::GetUniformName(std::string_view stageName, std::string_view name)
+{
+    std::string uniformName(stageName);
+    uniformName += '_';
+    uniformName += name;
+    return uniformName;
+}
+
+std::string PostFXComposer::ReadFile(const char* path)
+{
+    std::ifstream file(path);
+    assert(file.is_open());
+    std::stringstream stringStream;
+    stringStream << file.rdbuf();
+    return stringStream.str();
+}
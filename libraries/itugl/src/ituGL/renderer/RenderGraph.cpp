@@ -0,0 +1,444 @@
+#include <ituGL/renderer/RenderGraph.h>
+
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/renderer/RenderPass.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <algorithm>
+#include <cassert>
+
+// Render pass that draws another pass with the viewport set to the size of its target
+class RenderGraph::ViewportRenderPass : public RenderPass
+{
+public:
+    ViewportRenderPass(std::unique_ptr<RenderPass> renderPass, int width, int height, int defaultWidth, int defaultHeight)
+        : RenderPass(renderPass->GetTargetFramebuffer())
+        , m_renderPass(std::move(renderPass))
+        , m_width(width), m_height(height)
+        , m_defaultWidth(defaultWidth), m_defaultHeight(defaultHeight)
+    {
+    }
+
+    void Render() override
+    {
+        DeviceGL& device = GetRenderer().GetDevice();
+        device.SetViewport(0, 0, m_width, m_height);
+        m_renderPass->Render();
+        device.SetViewport(0, 0, m_defaultWidth, m_defaultHeight);
+    }
+
+    const char* GetName() const override { return m_renderPass->GetName(); }
+
+private:
+    std::unique_ptr<RenderPass> m_renderPass;
+    int m_width, m_height;
+    int m_defaultWidth, m_defaultHeight;
+};
+
+RenderGraph::RenderGraph(int width, int height)
+    : m_width(width), m_height(height)
+    , m_planned(false)
+    , m_compiled(false)
+    , m_culledPassCount(0)
+    , m_transientTextureCount(0)
+    , m_allocatedTextureBytes(0)
+    , m_transientTextureBytes(0)
+{
+    // The backbuffer is imported without texture, passes writing it use the default framebuffer
+    m_backbuffer = ImportTexture("Backbuffer", nullptr, TextureDesc{ width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8 });
+    MarkOutput(m_backbuffer);
+}
+
+RenderGraph::~RenderGraph()
+{
+}
+
+RenderGraph::ResourceId RenderGraph::CreateTexture(const char* name, const TextureDesc& desc)
+{
+    assert(!m_planned);
+    assert(desc.width > 0 && desc.height > 0);
+
+    Resource& resource = m_resources.emplace_back();
+    resource.name = name;
+    resource.desc = desc;
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::ImportTexture(const char* name, std::shared_ptr<Texture2DObject> texture, const TextureDesc& desc)
+{
+    assert(!m_planned);
+
+    Resource& resource = m_resources.emplace_back();
+    resource.name = name;
+    resource.desc = desc;
+    resource.texture = texture;
+    resource.imported = true;
+    return static_cast<ResourceId>(m_resources.size() - 1);
+}
+
+const RenderGraph::TextureDesc& RenderGraph::GetTextureDesc(ResourceId resourceId) const
+{
+    assert(resourceId < m_resources.size());
+    return m_resources[resourceId].desc;
+}
+
+void RenderGraph::MarkOutput(ResourceId resourceId)
+{
+    assert(resourceId < m_resources.size());
+    m_resources[resourceId].output = true;
+}
+
+void RenderGraph::AddPass(const char* name, std::initializer_list<ResourceId> reads, std::initializer_list<ResourceId> writes, const CreatePassFunction& createPass)
+{
+    assert(!m_planned);
+    assert(createPass);
+
+    Pass& pass = m_passes.emplace_back();
+    pass.name = name;
+    pass.reads = reads;
+    pass.writes = writes;
+    pass.createPass = createPass;
+
+    for (ResourceId resourceId : pass.reads)
+    {
+        assert(resourceId < m_resources.size());
+    }
+    for (ResourceId resourceId : pass.writes)
+    {
+        assert(resourceId < m_resources.size());
+        // The default framebuffer can't be combined with other attachments
+        assert(resourceId != m_backbuffer || pass.writes.size() == 1);
+    }
+}
+
+std::shared_ptr<Texture2DObject> RenderGraph::GetTexture(ResourceId resourceId) const
+{
+    assert(resourceId < m_resources.size());
+    return m_resources[resourceId].texture;
+}
+
+unsigned int RenderGraph::GetTextureIndex(ResourceId resourceId) const
+{
+    assert(resourceId < m_resources.size());
+    return m_resources[resourceId].textureIndex;
+}
+
+void RenderGraph::Plan()
+{
+    assert(!m_planned);
+    m_planned = true;
+
+    CullPasses();
+    m_executionOrder = SortPasses();
+    AssignTextures();
+}
+
+void RenderGraph::Compile(Renderer& renderer)
+{
+    assert(!m_compiled);
+    m_compiled = true;
+
+    if (!m_planned)
+    {
+        Plan();
+    }
+    CreateTextures();
+
+    for (unsigned int passIndex : m_executionOrder)
+    {
+        const Pass& pass = m_passes[passIndex];
+        std::unique_ptr<RenderPass> renderPass = pass.createPass(*this, GetFramebuffer(pass));
+        assert(renderPass);
+
+        // Passes writing textures of a different size than the default framebuffer need their own viewport
+        const TextureDesc* targetDesc = !pass.writes.empty() ? &m_resources[pass.writes[0]].desc : nullptr;
+        if (targetDesc && (targetDesc->width != m_width || targetDesc->height != m_height))
+        {
+            renderPass->SetRenderer(&renderer);
+            renderPass = std::make_unique<ViewportRenderPass>(std::move(renderPass), targetDesc->width, targetDesc->height, m_width, m_height);
+        }
+
+        renderer.AddRenderPass(std::move(renderPass));
+    }
+}
+
+void RenderGraph::CullPasses()
+{
+    // Start from the outputs, and keep the passes that write needed resources. What they read is needed too
+    std::vector<bool> needed(m_resources.size(), false);
+    for (ResourceId resourceId = 0; resourceId < m_resources.size(); ++resourceId)
+    {
+        needed[resourceId] = m_resources[resourceId].output;
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (Pass& pass : m_passes)
+        {
+            if (pass.alive)
+            {
+                continue;
+            }
+
+            pass.alive = std::any_of(pass.writes.begin(), pass.writes.end(), [&](ResourceId resourceId) { return needed[resourceId]; });
+            if (pass.alive)
+            {
+                for (ResourceId resourceId : pass.reads)
+                {
+                    needed[resourceId] = true;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    m_culledPassCount = static_cast<unsigned int>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return !pass.alive; }));
+}
+
+std::vector<unsigned int> RenderGraph::SortPasses() const
+{
+    unsigned int passCount = static_cast<unsigned int>(m_passes.size());
+
+    auto writes = [&](unsigned int passIndex, ResourceId resourceId)
+    {
+        const std::vector<ResourceId>& passWrites = m_passes[passIndex].writes;
+        return std::find(passWrites.begin(), passWrites.end(), resourceId) != passWrites.end();
+    };
+
+    // A pass depends on the previous writers of the resources it writes, and on all the writers of the resources it only reads
+    std::vector<std::vector<unsigned int>> dependents(passCount);
+    std::vector<unsigned int> dependencyCount(passCount, 0);
+    for (unsigned int passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        const Pass& pass = m_passes[passIndex];
+        if (!pass.alive)
+        {
+            continue;
+        }
+
+        for (unsigned int otherIndex = 0; otherIndex < passCount; ++otherIndex)
+        {
+            if (otherIndex == passIndex || !m_passes[otherIndex].alive)
+            {
+                continue;
+            }
+
+            bool dependency = false;
+            for (ResourceId resourceId : pass.writes)
+            {
+                dependency |= otherIndex < passIndex && writes(otherIndex, resourceId);
+            }
+            for (ResourceId resourceId : pass.reads)
+            {
+                dependency |= !writes(passIndex, resourceId) && writes(otherIndex, resourceId);
+            }
+
+            if (dependency)
+            {
+                dependents[otherIndex].push_back(passIndex);
+                ++dependencyCount[passIndex];
+            }
+        }
+    }
+
+    // Take the ready pass that was added first, so the order only changes when the dependencies require it
+    std::vector<unsigned int> executionOrder;
+    std::vector<bool> scheduled(passCount, false);
+    while (true)
+    {
+        unsigned int nextIndex = passCount;
+        for (unsigned int passIndex = 0; passIndex < passCount; ++passIndex)
+        {
+            if (m_passes[passIndex].alive && !scheduled[passIndex] && dependencyCount[passIndex] == 0)
+            {
+                nextIndex = passIndex;
+                break;
+            }
+        }
+        if (nextIndex == passCount)
+        {
+            break;
+        }
+
+        scheduled[nextIndex] = true;
+        executionOrder.push_back(nextIndex);
+        for (unsigned int dependentIndex : dependents[nextIndex])
+        {
+            --dependencyCount[dependentIndex];
+        }
+    }
+
+    // Cycles leave passes unscheduled
+    assert(executionOrder.size() == passCount - m_culledPassCount);
+    return executionOrder;
+}
+
+void RenderGraph::AssignTextures()
+{
+    // Lifetime of each resource, in execution positions
+    for (unsigned int position = 0; position < m_executionOrder.size(); ++position)
+    {
+        const Pass& pass = m_passes[m_executionOrder[position]];
+        for (const std::vector<ResourceId>* resourceIds : { &pass.reads, &pass.writes })
+        {
+            for (ResourceId resourceId : *resourceIds)
+            {
+                Resource& resource = m_resources[resourceId];
+                resource.firstUse = std::min(resource.firstUse, position);
+                resource.lastUse = std::max(resource.lastUse, position);
+            }
+        }
+    }
+
+    std::vector<ResourceId> transientResources;
+    for (ResourceId resourceId = 0; resourceId < m_resources.size(); ++resourceId)
+    {
+        const Resource& resource = m_resources[resourceId];
+        if (!resource.imported && resource.firstUse <= resource.lastUse)
+        {
+            transientResources.push_back(resourceId);
+        }
+    }
+    std::sort(transientResources.begin(), transientResources.end(),
+        [&](ResourceId a, ResourceId b) { return m_resources[a].firstUse < m_resources[b].firstUse; });
+
+    // Reuse a texture of the same size and format whose last resource is no longer used, or add a new one
+    for (ResourceId resourceId : transientResources)
+    {
+        Resource& resource = m_resources[resourceId];
+        m_transientTextureBytes += GetTextureBytes(resource.desc);
+
+        auto itPooled = std::find_if(m_pooledTextures.begin(), m_pooledTextures.end(),
+            [&](const PooledTexture& pooled) { return pooled.desc == resource.desc && pooled.lastUse < resource.firstUse; });
+
+        if (itPooled == m_pooledTextures.end())
+        {
+            itPooled = m_pooledTextures.insert(m_pooledTextures.end(), PooledTexture{ nullptr, resource.desc, resource.lastUse });
+            m_allocatedTextureBytes += GetTextureBytes(resource.desc);
+        }
+
+        itPooled->lastUse = resource.lastUse;
+        resource.textureIndex = static_cast<unsigned int>(itPooled - m_pooledTextures.begin());
+        ++m_transientTextureCount;
+    }
+}
+
+void RenderGraph::CreateTextures()
+{
+    for (PooledTexture& pooled : m_pooledTextures)
+    {
+        std::shared_ptr<Texture2DObject> texture = std::make_shared<Texture2DObject>();
+        texture->Bind();
+        texture->SetImage(0, pooled.desc.width, pooled.desc.height, pooled.desc.format, pooled.desc.internalFormat);
+        GLint filter = IsDepthFormat(pooled.desc.format) ? GL_NEAREST : GL_LINEAR;
+        texture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+        texture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+        texture->SetParameter(TextureObject::ParameterEnum::MinFilter, filter);
+        texture->SetParameter(TextureObject::ParameterEnum::MagFilter, filter);
+        pooled.texture = texture;
+    }
+    Texture2DObject::Unbind();
+
+    for (Resource& resource : m_resources)
+    {
+        if (resource.textureIndex != InvalidResource)
+        {
+            resource.texture = m_pooledTextures[resource.textureIndex].texture;
+        }
+    }
+}
+
+std::shared_ptr<const FramebufferObject> RenderGraph::GetFramebuffer(const Pass& pass)
+{
+    if (pass.writes.empty())
+    {
+        // Keep the current framebuffer
+        return nullptr;
+    }
+    if (pass.writes[0] == m_backbuffer)
+    {
+        return FramebufferObject::GetDefault();
+    }
+
+    std::vector<const Texture2DObject*> textures;
+    for (ResourceId resourceId : pass.writes)
+    {
+        assert(m_resources[resourceId].texture);
+        textures.push_back(m_resources[resourceId].texture.get());
+    }
+
+    auto itCached = std::find_if(m_framebuffers.begin(), m_framebuffers.end(),
+        [&](const CachedFramebuffer& cached) { return cached.textures == textures; });
+    if (itCached != m_framebuffers.end())
+    {
+        return itCached->framebuffer;
+    }
+
+    std::shared_ptr<FramebufferObject> framebuffer = std::make_shared<FramebufferObject>();
+    framebuffer->Bind();
+
+    std::vector<FramebufferObject::Attachment> drawBuffers;
+    for (ResourceId resourceId : pass.writes)
+    {
+        const Resource& resource = m_resources[resourceId];
+        // All the attachments must have the same size
+        assert(resource.desc.width == m_resources[pass.writes[0]].desc.width && resource.desc.height == m_resources[pass.writes[0]].desc.height);
+
+        if (IsDepthFormat(resource.desc.format))
+        {
+            framebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Depth, *resource.texture);
+        }
+        else
+        {
+            FramebufferObject::Attachment attachment = static_cast<FramebufferObject::Attachment>(GL_COLOR_ATTACHMENT0 + drawBuffers.size());
+            framebuffer->SetTexture(FramebufferObject::Target::Draw, attachment, *resource.texture);
+            drawBuffers.push_back(attachment);
+        }
+    }
+    framebuffer->SetDrawBuffers(drawBuffers);
+    FramebufferObject::Unbind();
+
+    m_framebuffers.push_back(CachedFramebuffer{ textures, framebuffer });
+    return framebuffer;
+}
+
+bool RenderGraph::IsDepthFormat(TextureObject::Format format)
+{
+    return format == TextureObject::FormatDepth || format == TextureObject::FormatDepthStencil;
+}
+
+size_t RenderGraph::GetTextureBytes(const TextureDesc& desc)
+{
+    // Approximate size of a texel. Drivers can pad some formats
+    size_t texelBytes = 4;
+    switch (desc.internalFormat)
+    {
+    case TextureObject::InternalFormatR8:
+        texelBytes = 1;
+        break;
+    case TextureObject::InternalFormatRG8:
+    case TextureObject::InternalFormatR16F:
+    case TextureObject::InternalFormatDepth16:
+        texelBytes = 2;
+        break;
+    case TextureObject::InternalFormatRGBA16F:
+    case TextureObject::InternalFormatRG32F:
+    case TextureObject::InternalFormatDepth32FStencil8:
+        texelBytes = 8;
+        break;
+    case TextureObject::InternalFormatRGB16F:
+        texelBytes = 6;
+        break;
+    case TextureObject::InternalFormatRGB32F:
+        texelBytes = 12;
+        break;
+    case TextureObject::InternalFormatRGBA32F:
+        texelBytes = 16;
+        break;
+    default:
+        break;
+    }
+    return texelBytes * desc.width * desc.height;
+}
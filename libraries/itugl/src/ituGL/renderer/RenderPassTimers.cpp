@@ -0,0 +1,150 @@
+#include <ituGL/renderer/RenderPassTimers.h>
+
+#include <ituGL/utils/DearImGui.h>
+#include <imgui.h>
+#include <cassert>
+#include <cfloat>
+#include <string>
+
+RenderPassTimers::RenderPassTimers() : m_enabled(true), m_frameIndex(0), m_activePass(~0u)
+{
+}
+
+void RenderPassTimers::BeginFrame(unsigned int passCount)
+{
+    assert(m_activePass == ~0u);
+
+    // The oldest frame is reused. Its queries were issued FrameLatency frames ago, so they are usually ready
+    m_frameIndex = (m_frameIndex + 1) % FrameLatency;
+    FrameQueries& frame = m_frames[m_frameIndex];
+
+    for (unsigned int passIndex = 0; passIndex < frame.issued.size(); ++passIndex)
+    {
+        if (!frame.issued[passIndex])
+        {
+            continue;
+        }
+
+        // If the GPU is still behind, skip the sample instead of waiting for it
+        // Each query is checked, the driver doesn't guarantee that both become available together
+        if (passIndex < m_passTimings.size())
+        {
+            const QueryObject& query = frame.queries[passIndex];
+            if (query.IsResultAvailable())
+            {
+                AddSample(m_passTimings[passIndex], static_cast<float>(query.GetResult() * 1e-6));
+            }
+            const QueryObject& sampleQuery = frame.sampleQueries[passIndex];
+            if (sampleQuery.IsResultAvailable())
+            {
+                SetSamplesPassed(m_passTimings[passIndex], sampleQuery.GetResult(), frame.pixelCount);
+            }
+        }
+        frame.issued[passIndex] = false;
+    }
+
+    if (m_passTimings.size() != passCount)
+    {
+        m_passTimings.resize(passCount);
+    }
+    while (frame.queries.size() < passCount)
+    {
+        frame.queries.emplace_back();
+        frame.sampleQueries.emplace_back();
+    }
+    frame.issued.resize(frame.queries.size(), false);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    frame.pixelCount = static_cast<unsigned int>(viewport[2] * viewport[3]);
+}
+
+void RenderPassTimers::BeginPass(unsigned int passIndex, const char* name)
+{
+    assert(m_activePass == ~0u);
+    assert(passIndex < m_passTimings.size());
+
+    m_passTimings[passIndex].name = name;
+    if (m_enabled)
+    {
+        FrameQueries& frame = m_frames[m_frameIndex];
+        frame.queries[passIndex].Begin(QueryObject::TimeElapsed);
+        frame.sampleQueries[passIndex].Begin(QueryObject::SamplesPassed);
+        frame.issued[passIndex] = true;
+        m_activePass = passIndex;
+    }
+}
+
+void RenderPassTimers::EndPass()
+{
+    if (m_activePass != ~0u)
+    {
+        QueryObject::End(QueryObject::SamplesPassed);
+        QueryObject::End(QueryObject::TimeElapsed);
+        m_activePass = ~0u;
+    }
+}
+
+float RenderPassTimers::GetTotalAverageTime() const
+{
+    float totalTime = 0.0f;
+    for (const PassTiming& passTiming : m_passTimings)
+    {
+        totalTime += passTiming.averageTime;
+    }
+    return totalTime;
+}
+
+void RenderPassTimers::AddSample(PassTiming& passTiming, float time)
+{
+    // Replace the oldest sample when the history is full
+    unsigned int index = (passTiming.historyOffset + passTiming.historyCount) % HistorySize;
+    if (passTiming.historyCount < HistorySize)
+    {
+        ++passTiming.historyCount;
+    }
+    else
+    {
+        passTiming.historyOffset = (passTiming.historyOffset + 1) % HistorySize;
+    }
+    passTiming.history[index] = time;
+    passTiming.lastTime = time;
+
+    float sum = 0.0f;
+    for (unsigned int i = 0; i < passTiming.historyCount; ++i)
+    {
+        sum += passTiming.history[i];
+    }
+    passTiming.averageTime = sum / passTiming.historyCount;
+}
+
+void RenderPassTimers::SetSamplesPassed(PassTiming& passTiming, uint64_t samplesPassed, unsigned int pixelCount)
+{
+    passTiming.samplesPassed = samplesPassed;
+    passTiming.samplesPerPixel = pixelCount ? static_cast<float>(samplesPassed) / pixelCount : 0.0f;
+}
+
+void RenderPassTimers::DrawGUI(DearImGui& imGui)
+{
+    if (auto window = imGui.UseWindow("GPU Timers"))
+    {
+        ImGui::Checkbox("Enabled", &m_enabled);
+        ImGui::Text("Total: %.3f ms", GetTotalAverageTime());
+
+        for (unsigned int passIndex = 0; passIndex < m_passTimings.size(); ++passIndex)
+        {
+            const PassTiming& passTiming = m_passTimings[passIndex];
+            if (!passTiming.name)
+            {
+                continue;
+            }
+
+            // Passes can share a name, so the index is part of the label
+            std::string label = std::to_string(passIndex) + " " + passTiming.name;
+            ImGui::Text("%s: %.3f ms (avg %.3f ms)", label.c_str(), passTiming.lastTime, passTiming.averageTime);
+            ImGui::Text("    %.2f samples per pixel", passTiming.samplesPerPixel);
+            ImGui::PlotLines(("##" + label).c_str(), passTiming.history.data(), passTiming.historyCount, passTiming.historyOffset,
+                nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 30.0f));
+        }
+    }
+}
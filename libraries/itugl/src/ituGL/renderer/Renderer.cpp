@@ -2,6 +2,7 @@
 
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/geometry/VertexAttribute.h>
 #include <ituGL/geometry/Drawcall.h>
 #include <ituGL/geometry/Mesh.h>
 #include <ituGL/geometry/Model.h>
@@ -9,16 +10,26 @@
 #include <ituGL/camera/Camera.h>
 #include <ituGL/texture/FramebufferObject.h>
 #include <ituGL/renderer/RenderPass.h>
+#include <ituGL/scene/Bounds.h>
+#include <ituGL/scene/Transform.h>
+#include <ituGL/utils/Profiler.h>
+#include <ituGL/utils/DearImGui.h>
+#include <imgui.h>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
 #include <span>
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cmath>
 
 Renderer::DrawcallInfo::DrawcallInfo(const Material& material, unsigned int worldMatrixIndex, const VertexArrayObject& vao, const Drawcall& drawcall)
-    : m_material(material), m_worldMatrixIndex(worldMatrixIndex), m_vao(vao), m_drawcall(drawcall)
+    : m_material(material), m_worldMatrixIndex(worldMatrixIndex), m_vao(vao), m_drawcall(drawcall), m_sortKey(0)
 {
 }
 
-Renderer::DrawcallCollection::DrawcallCollection(const DrawcallSupportedFunction& isSupported) : m_isSupported(isSupported)
+Renderer::DrawcallCollection::DrawcallCollection(const DrawcallSupportedFunction& isSupported) : m_isSupported(isSupported), m_sorted(false), m_depthPrePass(false)
 {
 }
 
@@ -37,24 +48,144 @@ void Renderer::DrawcallCollection::AddDrawcall(const DrawcallInfo& drawcallInfo)
     if (IsSupported(drawcallInfo))
     {
         m_drawcallInfos.push_back(drawcallInfo);
+        m_sorted = false;
     }
 }
 
+void Renderer::DrawcallCollection::AddSupportedDrawcalls(std::span<const DrawcallInfo> drawcallInfos)
+{
+    if (!drawcallInfos.empty())
+    {
+        m_drawcallInfos.insert(m_drawcallInfos.end(), drawcallInfos.begin(), drawcallInfos.end());
+        m_sorted = false;
+    }
+}
+
+void Renderer::DrawcallCollection::MergeSupportedDrawcalls(std::span<const DrawcallInfo> drawcallInfos, const DrawcallSortFunction& drawcallSortFunction)
+{
+    if (drawcallInfos.empty())
+    {
+        return;
+    }
+
+    // std::merge is stable: for equivalent drawcalls, the ones already in the collection go first
+    m_sortedDrawcallInfos.clear();
+    m_sortedDrawcallInfos.reserve(m_drawcallInfos.size() + drawcallInfos.size());
+    std::merge(m_drawcallInfos.begin(), m_drawcallInfos.end(), drawcallInfos.begin(), drawcallInfos.end(),
+        std::back_inserter(m_sortedDrawcallInfos), drawcallSortFunction);
+    m_drawcallInfos.swap(m_sortedDrawcallInfos);
+}
+
 void Renderer::DrawcallCollection::Clear()
 {
     m_drawcallInfos.clear();
+    m_sortFunction = nullptr;
+    m_sorted = false;
+}
+
+void Renderer::DrawcallCollection::Sort(const DrawcallSortFunction& drawcallSortFunction)
+{
+    m_sortFunction = drawcallSortFunction;
+    std::stable_sort(m_drawcallInfos.begin(), m_drawcallInfos.end(), m_sortFunction);
+    m_sorted = true;
+}
+
+void Renderer::DrawcallCollection::SortWithSortFunction()
+{
+    assert(m_sortFunction);
+    if (!m_sorted)
+    {
+        std::stable_sort(m_drawcallInfos.begin(), m_drawcallInfos.end(), m_sortFunction);
+        m_sorted = true;
+    }
+}
+
+void Renderer::DrawcallCollection::SortByKey()
+{
+    unsigned int count = static_cast<unsigned int>(m_drawcallInfos.size());
+    if (count < 2)
+    {
+        return;
+    }
+
+    // Sort pairs of (key, index) instead of moving the drawcalls on every pass
+    m_sortKeys.resize(count);
+    m_sortKeysTemp.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        m_sortKeys[i] = std::make_pair(m_drawcallInfos[i].GetSortKey(), i);
+    }
+
+    // One pass per byte, from the least significant. Each pass is stable, so the order of the previous passes is kept
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        std::array<unsigned int, 256> offsets = {};
+        for (const auto& sortKey : m_sortKeys)
+        {
+            offsets[(sortKey.first >> shift) & 0xFF]++;
+        }
+
+        // If all keys have the same byte, this pass would not change anything
+        if (offsets[(m_sortKeys[0].first >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        // Convert the histogram into the first output position for each byte value
+        unsigned int offset = 0;
+        for (unsigned int& bucket : offsets)
+        {
+            unsigned int bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (const auto& sortKey : m_sortKeys)
+        {
+            m_sortKeysTemp[offsets[(sortKey.first >> shift) & 0xFF]++] = sortKey;
+        }
+        m_sortKeys.swap(m_sortKeysTemp);
+    }
+
+    // Gather the drawcalls in the sorted order
+    m_sortedDrawcallInfos.clear();
+    m_sortedDrawcallInfos.reserve(count);
+    for (const auto& sortKey : m_sortKeys)
+    {
+        m_sortedDrawcallInfos.push_back(m_drawcallInfos[sortKey.second]);
+    }
+    m_drawcallInfos.swap(m_sortedDrawcallInfos);
+    m_sorted = true;
 }
 
 
 Renderer::Renderer(DeviceGL& device)
     : m_device(device)
     , m_currentCamera(nullptr)
+    , m_currentMaterial(nullptr)
+    , m_frameUniforms()
+    , m_lightArrayUniforms()
+    , m_lightArrayUploaded(false)
     , m_defaultFramebuffer(FramebufferObject::GetDefault())
     , m_currentFramebuffer(m_defaultFramebuffer)
+    , m_staticModelsVersion(0)
+    , m_staticDrawcallsDirty(false)
+    , m_frustumCullingEnabled(true)
+    , m_occlusionCullingEnabled(true)
+    , m_lodSelectionEnabled(true)
+    , m_lodHysteresis(0.1f)
+    , m_gpuCullingEnabled(false)
+    , m_gpuInstancesDirty(false)
     , m_drawcallCollections(1)
 {
     InitializeFullscreenMesh();
 
+    m_frameUniformBuffer.Bind();
+    m_frameUniformBuffer.AllocateData(m_frameUniforms);
+
+    m_lightArrayUniformBuffer.Bind();
+    m_lightArrayUniformBuffer.AllocateData(m_lightArrayUniforms);
+
     device.EnableFeature(GL_FRAMEBUFFER_SRGB);
     device.EnableFeature(GL_DEPTH_TEST);
     device.EnableFeature(GL_CULL_FACE);
@@ -104,21 +235,70 @@ const Mesh& Renderer::GetFullscreenMesh() const
 
 void Renderer::Render()
 {
+    ITUGL_PROFILE_SCOPE("Renderer::Render");
     assert(m_currentCamera);
 
-    for (auto& pass : m_passes)
+    // State could have been changed outside of the renderer since the last frame
+    m_device.InvalidateState();
+    m_device.ResetStateStats();
+    for (CameraState& cameraState : m_cameraStates)
+    {
+        cameraState.valid = false;
+    }
+    m_instancedVAOs.clear();
+
     {
-        SetCurrentFramebuffer(pass->GetTargetFramebuffer());
-        pass->Render();
+        ITUGL_PROFILE_SCOPE("UpdateUniforms");
+        UpdateFrameUniforms();
+        UpdateLightArrayUniforms();
+    }
+    {
+        ITUGL_PROFILE_SCOPE("UpdateStaticModels");
+        UpdateStaticModels();
+    }
+    {
+        ITUGL_PROFILE_SCOPE("CullModels");
+        CullModels();
+    }
+    if (IsGpuCullingActive() && m_gpuCuller.GetInstanceCount() > 0)
+    {
+        ITUGL_PROFILE_SCOPE("GpuCulling");
+        m_gpuCuller.Cull(m_currentCamera->GetViewProjectionMatrix());
+    }
+    {
+        ITUGL_PROFILE_SCOPE("SortDrawcalls");
+        SortDrawcalls();
+    }
+
+    unsigned int passCount = static_cast<unsigned int>(m_passes.size());
+    m_passTimers.BeginFrame(passCount);
+    for (unsigned int passIndex = 0; passIndex < passCount; ++passIndex)
+    {
+        RenderPass& pass = *m_passes[passIndex];
+        ITUGL_PROFILE_SCOPE(pass.GetName());
+
+        // Passes can use materials and programs directly, so don't trust the current material between passes
+        m_currentMaterial = nullptr;
+
+        SetCurrentFramebuffer(pass.GetTargetFramebuffer());
+        m_passTimers.BeginPass(passIndex, pass.GetName());
+        pass.Render();
+        m_passTimers.EndPass();
     }
 
+    m_frameStats.state = m_device.GetStateStats();
+    m_frameStats.culling = m_cullingStats;
+    m_frameStats.occlusion = m_occlusionCuller.IsRasterized() ? m_occlusionCuller.GetStats() : OcclusionCuller::Stats();
+
     Reset();
 }
 
 void Renderer::Reset()
 {
     m_worldMatrices.clear();
+    m_models.clear();
     m_lights.clear();
+    m_occlusionCuller.Clear();
 
     for (auto& collection : m_drawcallCollections)
     {
@@ -126,6 +306,43 @@ void Renderer::Reset()
     }
 
     m_currentCamera = nullptr;
+    m_currentMaterial = nullptr;
+}
+
+void Renderer::DrawFrameStatsGUI(DearImGui& imGui) const
+{
+    if (auto window = imGui.UseOverlay("Frame Stats"))
+    {
+        const DeviceGL::StateStats& state = m_frameStats.state;
+        const CullingStats& culling = m_frameStats.culling;
+
+        ImGui::Text("Drawcalls: %u (%u instanced)", state.drawcalls, state.instancedDrawcalls);
+        ImGui::Text("Instances: %u", state.instances);
+        ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(state.triangles));
+        ImGui::Text("Vertices: %llu", static_cast<unsigned long long>(state.vertices));
+        ImGui::Separator();
+        ImGui::Text("Program binds: %u", state.programBinds);
+        ImGui::Text("Texture binds: %u", state.textureBinds);
+        ImGui::Text("Uniform uploads: %u", state.uniformUploads);
+        ImGui::Text("Framebuffer binds: %u", state.framebufferBinds);
+        ImGui::Text("Buffer uploads: %.1f KB", state.bufferBytesUploaded / 1024.0);
+        ImGui::Text("State calls: %u issued, %u skipped", state.issuedCalls, state.skippedCalls);
+        ImGui::Separator();
+        ImGui::Text("Visible: %u, culled: %u, occluded: %u", culling.visibleDrawcalls, culling.culledDrawcalls, culling.occludedDrawcalls);
+        if (m_frameStats.occlusion.occluders > 0)
+        {
+            const OcclusionCuller::Stats& occlusion = m_frameStats.occlusion;
+            ImGui::Text("Occluders: %u (%u triangles), %.3f ms", occlusion.occluders, occlusion.triangles, occlusion.rasterTime);
+        }
+        if (culling.gpuDrawcalls > 0)
+        {
+            ImGui::Text("GPU culled: %u", culling.gpuDrawcalls);
+        }
+        if (culling.reducedLodDrawcalls > 0)
+        {
+            ImGui::Text("Reduced LOD: %u", culling.reducedLodDrawcalls);
+        }
+    }
 }
 
 int Renderer::AddRenderPass(std::unique_ptr<RenderPass> renderPass)
@@ -143,29 +360,71 @@ void Renderer::RegisterShaderProgram(std::shared_ptr<const ShaderProgram> shader
 {
     assert(shaderProgramPtr);
 
+    unsigned int shaderProgramId = shaderProgramPtr->GetId();
+    if (shaderProgramId >= m_shaderPrograms.size())
+    {
+        m_shaderPrograms.resize(shaderProgramId + 1);
+        m_cameraStates.resize(shaderProgramId + 1);
+    }
+
+    RegisteredShaderProgram& registeredShaderProgram = m_shaderPrograms[shaderProgramId];
+    registeredShaderProgram.shaderProgram = shaderProgramPtr;
+
     if (updateTransformFunction)
     {
-        m_updateTransformsFunctions[shaderProgramPtr] = updateTransformFunction;
+        registeredShaderProgram.updateTransformsFunction = updateTransformFunction;
     }
 
     if (updateLightsFunction)
     {
-        m_updateLightsFunctions[shaderProgramPtr] = updateLightsFunction;
+        registeredShaderProgram.updateLightsFunction = updateLightsFunction;
+    }
+
+    // Programs using the frame uniforms read them from the shared buffer
+    GLuint frameUniformsBlockIndex = shaderProgramPtr->GetUniformBlockIndex("FrameUniforms");
+    if (frameUniformsBlockIndex != GL_INVALID_INDEX)
+    {
+        shaderProgramPtr->SetUniformBlockBinding(frameUniformsBlockIndex, FrameUniformsBinding);
+    }
+
+    // Same for the light array
+    GLuint lightArrayUniformsBlockIndex = shaderProgramPtr->GetUniformBlockIndex("LightArrayUniforms");
+    if (lightArrayUniformsBlockIndex != GL_INVALID_INDEX)
+    {
+        shaderProgramPtr->SetUniformBlockBinding(lightArrayUniformsBlockIndex, LightArrayUniformsBinding);
+    }
+
+    // Shaders opt in to instancing by declaring the instance world matrix attribute
+    registeredShaderProgram.instanced = shaderProgramPtr->GetAttributeLocation("InstanceWorldMatrix") == static_cast<ShaderProgram::Location>(InstanceWorldMatrixLocation);
+}
+
+const Renderer::RegisteredShaderProgram* Renderer::FindShaderProgram(const ShaderProgram& shaderProgram) const
+{
+    unsigned int shaderProgramId = shaderProgram.GetId();
+    if (shaderProgramId < m_shaderPrograms.size() && m_shaderPrograms[shaderProgramId].shaderProgram)
+    {
+        return &m_shaderPrograms[shaderProgramId];
     }
+    return nullptr;
+}
+
+bool Renderer::IsInstancingSupported(const ShaderProgram& shaderProgram) const
+{
+    const RegisteredShaderProgram* registeredShaderProgram = FindShaderProgram(shaderProgram);
+    return registeredShaderProgram && registeredShaderProgram->instanced;
 }
 
-void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, unsigned int worldMatrixIndex, bool cameraChanged) const
+void Renderer::UpdateTransforms(const ShaderProgram& shaderProgram, unsigned int worldMatrixIndex, bool cameraChanged) const
 {
-    const glm::mat4& worldMatrix = m_worldMatrices[worldMatrixIndex];
-    UpdateTransforms(shaderProgramPtr, worldMatrix);
+    UpdateTransforms(shaderProgram, GetWorldMatrix(worldMatrixIndex), cameraChanged);
 }
 
-void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& worldMatrix, bool cameraChanged) const
+void Renderer::UpdateTransforms(const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, bool cameraChanged) const
 {
-    const auto& itFind = m_updateTransformsFunctions.find(shaderProgramPtr);
-    if (itFind != m_updateTransformsFunctions.end())
+    const RegisteredShaderProgram* registeredShaderProgram = FindShaderProgram(shaderProgram);
+    if (registeredShaderProgram && registeredShaderProgram->updateTransformsFunction)
     {
-        itFind->second(*shaderProgramPtr, worldMatrix, *m_currentCamera, cameraChanged);
+        registeredShaderProgram->updateTransformsFunction(shaderProgram, worldMatrix, *m_currentCamera, cameraChanged);
     }
 }
 
@@ -177,9 +436,21 @@ Renderer::UpdateLightsFunction Renderer::GetDefaultUpdateLightsFunction(const Sh
     ShaderProgram::Location lightPositionLocation = shaderProgram.GetUniformLocation("LightPosition");
     ShaderProgram::Location lightDirectionLocation = shaderProgram.GetUniformLocation("LightDirection");
     ShaderProgram::Location lightAttenuationLocation = shaderProgram.GetUniformLocation("LightAttenuation");
+    ShaderProgram::Location lightArrayEnabledLocation = shaderProgram.GetUniformLocation("LightArrayEnabled");
+    bool lightArraySupported = shaderProgram.GetUniformBlockIndex("LightArrayUniforms") != GL_INVALID_INDEX;
 
-    return [=](const ShaderProgram& shaderProgram, std::span<const Light* const> lights, unsigned int& lightIndex) -> bool
+    return [=, this](const ShaderProgram& shaderProgram, std::span<const Light* const> lights, unsigned int& lightIndex) -> bool
     {
+        // Draw all the lights in a single pass, with the indirect light. The next call finishes the loop
+        if (lightArraySupported && lightIndex == 0 && !lights.empty() && IsLightArrayUploaded(lights))
+        {
+            shaderProgram.SetUniform(lightArrayEnabledLocation, 1);
+            shaderProgram.SetUniform(lightIndirectLocation, 1);
+            lightIndex = static_cast<unsigned int>(lights.size());
+            return true;
+        }
+        shaderProgram.SetUniform(lightArrayEnabledLocation, 0);
+
         bool needsRender = lightIndex == 0;
 
         shaderProgram.SetUniform(lightIndirectLocation, lightIndex == 0 ? 1 : 0);
@@ -205,12 +476,12 @@ Renderer::UpdateLightsFunction Renderer::GetDefaultUpdateLightsFunction(const Sh
     };
 }
 
-bool Renderer::UpdateLights(std::shared_ptr<const ShaderProgram> shaderProgramPtr, std::span<const Light* const> lights, unsigned int& lightIndex) const
+bool Renderer::UpdateLights(const ShaderProgram& shaderProgram, std::span<const Light* const> lights, unsigned int& lightIndex) const
 {
-    const auto& itFind = m_updateLightsFunctions.find(shaderProgramPtr);
-    if (itFind != m_updateLightsFunctions.end())
+    const RegisteredShaderProgram* registeredShaderProgram = FindShaderProgram(shaderProgram);
+    if (registeredShaderProgram && registeredShaderProgram->updateLightsFunction)
     {
-        return itFind->second(*shaderProgramPtr, lights, lightIndex);
+        return registeredShaderProgram->updateLightsFunction(shaderProgram, lights, lightIndex);
     }
     return false;
 }
@@ -235,15 +506,558 @@ void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix)
     unsigned int worldMatrixIndex = static_cast<unsigned int>(m_worldMatrices.size());
     m_worldMatrices.push_back(worldMatrix);
 
+    // The camera could still change before rendering, so culling is delayed until then
+    m_models.emplace_back(&model, worldMatrixIndex);
+}
+
+void Renderer::AddOccluder(const OccluderMesh& occluder, const glm::mat4& worldMatrix)
+{
+    m_occlusionCuller.AddOccluder(occluder, worldMatrix);
+}
+
+Renderer::StaticModelId Renderer::AddStaticModel(const Model& model, const glm::mat4& worldMatrix)
+{
+    StaticModelId staticModelId;
+    if (!m_freeStaticModelIds.empty())
+    {
+        staticModelId = m_freeStaticModelIds.back();
+        m_freeStaticModelIds.pop_back();
+    }
+    else
+    {
+        staticModelId = static_cast<StaticModelId>(m_staticModels.size());
+        assert((staticModelId & StaticWorldMatrixFlag) == 0);
+        m_staticModels.emplace_back();
+        m_staticWorldMatrices.emplace_back();
+    }
+
+    m_staticModels[staticModelId] = StaticModel{ &model, nullptr, 0 };
+    m_staticWorldMatrices[staticModelId] = worldMatrix;
+    m_staticDrawcallsDirty = true;
+    ++m_staticModelsVersion;
+    return staticModelId;
+}
+
+Renderer::StaticModelId Renderer::AddStaticModel(const Model& model, std::shared_ptr<const Transform> transform)
+{
+    assert(transform);
+    StaticModelId staticModelId = AddStaticModel(model, transform->GetTransformMatrix());
+    m_staticModels[staticModelId].transform = transform;
+    m_staticModels[staticModelId].transformVersion = transform->GetVersion();
+    return staticModelId;
+}
+
+void Renderer::SetStaticModelWorldMatrix(StaticModelId staticModelId, const glm::mat4& worldMatrix)
+{
+    assert(m_staticModels[staticModelId].model);
+    // Opaque sort keys don't depend on the position, so the cached drawcalls are still valid
+    m_staticWorldMatrices[staticModelId] = worldMatrix;
+    m_gpuInstancesDirty = true;
+    ++m_staticModelsVersion;
+}
+
+void Renderer::RemoveStaticModel(StaticModelId staticModelId)
+{
+    assert(m_staticModels[staticModelId].model);
+    m_staticModels[staticModelId] = StaticModel{ nullptr, nullptr, 0 };
+    m_freeStaticModelIds.push_back(staticModelId);
+    m_staticDrawcallsDirty = true;
+    ++m_staticModelsVersion;
+}
+
+void Renderer::UpdateStaticModels()
+{
+    for (StaticModelId staticModelId = 0; staticModelId < m_staticModels.size(); ++staticModelId)
+    {
+        StaticModel& staticModel = m_staticModels[staticModelId];
+        if (staticModel.transform && staticModel.transform->GetVersion() != staticModel.transformVersion)
+        {
+            m_staticWorldMatrices[staticModelId] = staticModel.transform->GetTransformMatrix();
+            staticModel.transformVersion = staticModel.transform->GetVersion();
+            m_gpuInstancesDirty = true;
+            ++m_staticModelsVersion;
+        }
+    }
+
+    // Collections could have been added or changed since the last build
+    if (m_staticDrawcallIndices.size() != m_drawcallCollections.size())
+    {
+        m_staticDrawcallsDirty = true;
+    }
+
+    if (m_staticDrawcallsDirty)
+    {
+        BuildStaticDrawcalls();
+        m_staticDrawcallsDirty = false;
+    }
+
+    if (m_gpuInstancesDirty)
+    {
+        UploadGpuInstances();
+        m_gpuInstancesDirty = false;
+    }
+}
+
+void Renderer::BuildStaticDrawcalls()
+{
+    m_staticDrawcalls.clear();
+    for (StaticModelId staticModelId = 0; staticModelId < m_staticModels.size(); ++staticModelId)
+    {
+        const Model* model = m_staticModels[staticModelId].model;
+        if (!model)
+        {
+            continue;
+        }
+
+        const Mesh& mesh = model->GetMesh();
+        for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+        {
+            DrawcallInfo drawcallInfo(model->GetMaterial(submeshIndex), staticModelId | StaticWorldMatrixFlag,
+                mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex));
+            // Key without depth: opaque drawcalls keep this order, translucent ones get a new key every frame
+            drawcallInfo.SetSortKey(ComputeSortKey(drawcallInfo, 0.0f));
+            m_staticDrawcalls.push_back(StaticDrawcall{ drawcallInfo, staticModelId, submeshIndex, NoGpuCommand });
+        }
+    }
+
+    std::stable_sort(m_staticDrawcalls.begin(), m_staticDrawcalls.end(), [](const StaticDrawcall& a, const StaticDrawcall& b)
+        {
+            return a.drawcallInfo.GetSortKey() < b.drawcallInfo.GetSortKey();
+        });
+    m_staticDrawcallLods.assign(m_staticDrawcalls.size(), 0);
+
+    // Filter once per collection, instead of every frame
+    m_staticDrawcallIndices.resize(m_drawcallCollections.size());
+    for (unsigned int collectionIndex = 0; collectionIndex < m_drawcallCollections.size(); ++collectionIndex)
+    {
+        std::vector<unsigned int>& indices = m_staticDrawcallIndices[collectionIndex];
+        indices.clear();
+        for (unsigned int i = 0; i < m_staticDrawcalls.size(); ++i)
+        {
+            if (m_drawcallCollections[collectionIndex].IsSupported(m_staticDrawcalls[i].drawcallInfo))
+            {
+                indices.push_back(i);
+            }
+        }
+    }
+
+    BuildGpuDrawcalls();
+}
+
+void Renderer::SetGpuCullingEnabled(bool enabled)
+{
+    if (enabled != m_gpuCullingEnabled)
+    {
+        m_gpuCullingEnabled = enabled;
+        m_staticDrawcallsDirty = true;
+        // The depth of the last frame can be from long ago
+        m_gpuCuller.InvalidateHiZ();
+    }
+}
+
+bool Renderer::IsGpuCullingActive() const
+{
+    return m_gpuCullingEnabled && GpuCuller::IsSupported();
+}
+
+bool Renderer::IsGpuCullingSupported(const DrawcallInfo& drawcallInfo, const Mesh& mesh, unsigned int submeshIndex) const
+{
+    // Translucent drawcalls are sorted every frame, and the commands can only draw indexed meshes with the instance attribute
+    return !drawcallInfo.GetMaterial().HasBlend()
+        && IsInstancingSupported(drawcallInfo.GetMaterial().GetShaderProgramRef())
+        && drawcallInfo.GetDrawcall().GetEBOType() != Data::Type::None
+        && mesh.HasSubmeshBounds(submeshIndex);
+}
+
+void Renderer::BuildGpuDrawcalls()
+{
+    m_gpuDrawCommands.clear();
+    m_gpuDrawcalls.resize(m_drawcallCollections.size());
+    for (std::vector<GpuDrawcall>& gpuDrawcalls : m_gpuDrawcalls)
+    {
+        gpuDrawcalls.clear();
+    }
+    m_gpuInstancesDirty = true;
+
+    // Drawcalls with the same material, VAO and drawcall are next to each other after sorting. Each group is a command
+    bool gpuCullingActive = IsGpuCullingActive();
+    const DrawcallInfo* previousDrawcallInfo = nullptr;
+    unsigned int instanceCount = 0;
+    for (StaticDrawcall& staticDrawcall : m_staticDrawcalls)
+    {
+        staticDrawcall.gpuCommandIndex = NoGpuCommand;
+        const DrawcallInfo& drawcallInfo = staticDrawcall.drawcallInfo;
+        const Mesh& mesh = m_staticModels[staticDrawcall.staticModelId].model->GetMesh();
+        if (!gpuCullingActive || !IsGpuCullingSupported(drawcallInfo, mesh, staticDrawcall.submeshIndex))
+        {
+            continue;
+        }
+
+        bool sameCommand = previousDrawcallInfo
+            && &previousDrawcallInfo->GetMaterial() == &drawcallInfo.GetMaterial()
+            && &previousDrawcallInfo->GetVAO() == &drawcallInfo.GetVAO()
+            && &previousDrawcallInfo->GetDrawcall() == &drawcallInfo.GetDrawcall();
+        if (!sameCommand)
+        {
+            const Drawcall& drawcall = drawcallInfo.GetDrawcall();
+            GLuint firstIndex = drawcall.GetFirst() / Data::GetTypeSize(drawcall.GetEBOType());
+            m_gpuDrawCommands.push_back(GpuCuller::DrawCommand{ static_cast<GLuint>(drawcall.GetCount()), 0, firstIndex, 0, instanceCount });
+        }
+        staticDrawcall.gpuCommandIndex = static_cast<unsigned int>(m_gpuDrawCommands.size() - 1);
+        previousDrawcallInfo = &drawcallInfo;
+        instanceCount++;
+    }
+
+    // Consecutive commands of each collection that share the material and the VAO are drawn together
+    for (unsigned int collectionIndex = 0; collectionIndex < m_drawcallCollections.size(); ++collectionIndex)
+    {
+        std::vector<GpuDrawcall>& gpuDrawcalls = m_gpuDrawcalls[collectionIndex];
+        for (unsigned int i : m_staticDrawcallIndices[collectionIndex])
+        {
+            const StaticDrawcall& staticDrawcall = m_staticDrawcalls[i];
+            unsigned int commandIndex = staticDrawcall.gpuCommandIndex;
+            if (commandIndex == NoGpuCommand)
+            {
+                continue;
+            }
+
+            if (!gpuDrawcalls.empty())
+            {
+                GpuDrawcall& gpuDrawcall = gpuDrawcalls.back();
+                unsigned int nextCommand = gpuDrawcall.firstCommand + gpuDrawcall.commandCount;
+                if (commandIndex == nextCommand - 1)
+                {
+                    continue;
+                }
+
+                const DrawcallInfo& drawcallInfo = staticDrawcall.drawcallInfo;
+                const Drawcall& drawcall = drawcallInfo.GetDrawcall();
+                const Drawcall& previousDrawcall = gpuDrawcall.drawcallInfo.GetDrawcall();
+                if (commandIndex == nextCommand
+                    && &gpuDrawcall.drawcallInfo.GetMaterial() == &drawcallInfo.GetMaterial()
+                    && &gpuDrawcall.drawcallInfo.GetVAO() == &drawcallInfo.GetVAO()
+                    && previousDrawcall.GetPrimitive() == drawcall.GetPrimitive()
+                    && previousDrawcall.GetEBOType() == drawcall.GetEBOType())
+                {
+                    gpuDrawcall.commandCount++;
+                    continue;
+                }
+            }
+            gpuDrawcalls.push_back(GpuDrawcall{ staticDrawcall.drawcallInfo, commandIndex, 1 });
+        }
+    }
+}
+
+void Renderer::UploadGpuInstances()
+{
+    m_gpuInstances.clear();
+    for (const StaticDrawcall& staticDrawcall : m_staticDrawcalls)
+    {
+        if (staticDrawcall.gpuCommandIndex != NoGpuCommand)
+        {
+            const Mesh& mesh = m_staticModels[staticDrawcall.staticModelId].model->GetMesh();
+            const AabbBounds& bounds = mesh.GetSubmeshBounds(staticDrawcall.submeshIndex);
+            m_gpuInstances.push_back(GpuCuller::Instance{ m_staticWorldMatrices[staticDrawcall.staticModelId],
+                glm::vec4(bounds.GetCenter(), static_cast<float>(staticDrawcall.gpuCommandIndex)), glm::vec4(bounds.GetSize(), 0.0f) });
+        }
+    }
+    m_gpuCuller.SetInstances(m_gpuInstances, m_gpuDrawCommands);
+}
+
+unsigned int Renderer::GetGpuDrawcallCount(unsigned int collectionIndex) const
+{
+    return collectionIndex < m_gpuDrawcalls.size() ? static_cast<unsigned int>(m_gpuDrawcalls[collectionIndex].size()) : 0;
+}
+
+const Renderer::DrawcallInfo& Renderer::PrepareGpuDrawcall(unsigned int collectionIndex, unsigned int index, Material::OverrideFlags materialOverride)
+{
+    const DrawcallInfo& drawcallInfo = m_gpuDrawcalls[collectionIndex][index].drawcallInfo;
+    PrepareDrawcall(drawcallInfo, materialOverride);
+
+    // The instanced drawcalls of the CPU point the attribute back to their buffer when they use the VAO again
+    SetInstanceAttributes(drawcallInfo.GetVAO(), m_gpuCuller.GetWorldMatrixBuffer());
+    m_instancedVAOs.erase(&drawcallInfo.GetVAO());
+    return drawcallInfo;
+}
+
+void Renderer::DrawGpuDrawcall(unsigned int collectionIndex, unsigned int index) const
+{
+    const GpuDrawcall& gpuDrawcall = m_gpuDrawcalls[collectionIndex][index];
+    const Drawcall& drawcall = gpuDrawcall.drawcallInfo.GetDrawcall();
+    m_gpuCuller.Draw(gpuDrawcall.firstCommand, gpuDrawcall.commandCount, drawcall.GetPrimitive(), drawcall.GetEBOType());
+}
+
+void Renderer::CullStaticDrawcalls(const FrustumBounds& frustum)
+{
+    unsigned int drawcallCount = static_cast<unsigned int>(m_staticDrawcalls.size());
+    m_staticDrawcallVisible.resize(drawcallCount);
+
+    m_threadPool.ParallelFor(drawcallCount, MinModelsPerCullingTask, [&](unsigned int begin, unsigned int end, unsigned int)
+        {
+            for (unsigned int i = begin; i < end; ++i)
+            {
+                const StaticDrawcall& staticDrawcall = m_staticDrawcalls[i];
+                const Mesh& mesh = m_staticModels[staticDrawcall.staticModelId].model->GetMesh();
+                const glm::mat4& worldMatrix = m_staticWorldMatrices[staticDrawcall.staticModelId];
+
+                uint8_t visibility = Visible;
+                if (staticDrawcall.gpuCommandIndex != NoGpuCommand)
+                {
+                    visibility = GpuCulled;
+                }
+                else if (mesh.HasSubmeshBounds(staticDrawcall.submeshIndex))
+                {
+                    BoxBounds box(mesh.GetSubmeshBounds(staticDrawcall.submeshIndex), worldMatrix);
+                    if (m_frustumCullingEnabled && !Bounds::Intersects(frustum, box))
+                    {
+                        visibility = Culled;
+                    }
+                    else if (!m_occlusionCuller.IsVisible(box))
+                    {
+                        visibility = Occluded;
+                    }
+                }
+                m_staticDrawcallVisible[i] = visibility;
+
+                // Indirect draws use the commands of the first level
+                if (visibility == Visible)
+                {
+                    unsigned int previousLod = m_staticDrawcallLods[i];
+                    m_staticDrawcallLods[i] = static_cast<uint8_t>(m_lodSelectionEnabled
+                        ? SelectLod(*m_staticModels[staticDrawcall.staticModelId].model, staticDrawcall.submeshIndex, worldMatrix, previousLod, m_lodHysteresis)
+                        : 0);
+                }
+            }
+        });
+
+    for (unsigned int i = 0; i < drawcallCount; ++i)
+    {
+        switch (m_staticDrawcallVisible[i])
+        {
+        case Visible:
+            m_cullingStats.visibleDrawcalls++;
+            m_cullingStats.reducedLodDrawcalls += m_staticDrawcallLods[i] > 0 ? 1 : 0;
+            break;
+        case Culled:
+            m_cullingStats.culledDrawcalls++;
+            break;
+        case Occluded:
+            m_cullingStats.occludedDrawcalls++;
+            break;
+        case GpuCulled:
+            m_cullingStats.gpuDrawcalls++;
+            break;
+        }
+    }
+
+    // Translucent drawcalls are sorted by depth every frame, so they go with the dynamic ones
+    for (unsigned int collectionIndex = 0; collectionIndex < m_drawcallCollections.size(); ++collectionIndex)
+    {
+        for (unsigned int i : m_staticDrawcallIndices[collectionIndex])
+        {
+            if (m_staticDrawcallVisible[i] == Visible && m_staticDrawcalls[i].drawcallInfo.GetMaterial().HasBlend())
+            {
+                DrawcallInfo drawcallInfo = GetStaticDrawcallInfo(i);
+                m_drawcallCollections[collectionIndex].AddSupportedDrawcalls(std::span(&drawcallInfo, 1));
+            }
+        }
+    }
+}
+
+Renderer::DrawcallInfo Renderer::GetStaticDrawcallInfo(unsigned int staticDrawcallIndex) const
+{
+    const StaticDrawcall& staticDrawcall = m_staticDrawcalls[staticDrawcallIndex];
+    unsigned int lod = m_staticDrawcallLods[staticDrawcallIndex];
+    if (lod == 0)
+    {
+        return staticDrawcall.drawcallInfo;
+    }
+
+    // Same state as the cached drawcall, so it keeps its place in the sorted order
+    const DrawcallInfo& cachedDrawcallInfo = staticDrawcall.drawcallInfo;
+    const Mesh& mesh = m_staticModels[staticDrawcall.staticModelId].model->GetMesh();
+    DrawcallInfo drawcallInfo(cachedDrawcallInfo.GetMaterial(), cachedDrawcallInfo.GetWorldMatrixIndex(), cachedDrawcallInfo.GetVAO(),
+        mesh.GetSubmeshDrawcall(staticDrawcall.submeshIndex, lod));
+    drawcallInfo.SetSortKey(cachedDrawcallInfo.GetSortKey());
+    return drawcallInfo;
+}
+
+void Renderer::GetShadowCasters(const FrustumBounds& bounds, bool staticCasters, std::vector<DrawcallInfo>& drawcallInfos) const
+{
+    // Shadows are drawn with the first level of detail, the level selected for the camera could be too coarse
+    if (staticCasters)
+    {
+        for (const StaticDrawcall& staticDrawcall : m_staticDrawcalls)
+        {
+            if (!IsInDepthPrePass(staticDrawcall.drawcallInfo))
+            {
+                continue;
+            }
+
+            const Mesh& mesh = m_staticModels[staticDrawcall.staticModelId].model->GetMesh();
+            if (mesh.HasSubmeshBounds(staticDrawcall.submeshIndex)
+                && !Bounds::Intersects(bounds, BoxBounds(mesh.GetSubmeshBounds(staticDrawcall.submeshIndex), m_staticWorldMatrices[staticDrawcall.staticModelId])))
+            {
+                continue;
+            }
+            drawcallInfos.push_back(staticDrawcall.drawcallInfo);
+        }
+        return;
+    }
+
+    for (const auto& [model, worldMatrixIndex] : m_models)
+    {
+        const Mesh& mesh = model->GetMesh();
+        const glm::mat4& worldMatrix = m_worldMatrices[worldMatrixIndex];
+        if (mesh.HasBounds() && !Bounds::Intersects(bounds, BoxBounds(mesh.GetBounds(), worldMatrix)))
+        {
+            continue;
+        }
+
+        for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+        {
+            DrawcallInfo drawcallInfo(model->GetMaterial(submeshIndex), worldMatrixIndex,
+                mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex));
+            if (IsInDepthPrePass(drawcallInfo))
+            {
+                drawcallInfos.push_back(drawcallInfo);
+            }
+        }
+    }
+}
+
+unsigned int Renderer::SelectLod(const Model& model, unsigned int submeshIndex, const glm::mat4& worldMatrix, unsigned int previousLod, float hysteresis) const
+{
     const Mesh& mesh = model.GetMesh();
-    for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+    unsigned int lodCount = mesh.GetSubmeshLodCount(submeshIndex);
+    if (lodCount == 1 || !mesh.HasSubmeshBounds(submeshIndex))
+    {
+        return 0;
+    }
+
+    // Bounding sphere of the submesh, scaled by the largest axis of the world matrix
+    const AabbBounds& bounds = mesh.GetSubmeshBounds(submeshIndex);
+    glm::vec4 center = worldMatrix * glm::vec4(bounds.GetCenter(), 1.0f);
+    float scale = std::sqrt(std::max(std::max(glm::dot(worldMatrix[0], worldMatrix[0]), glm::dot(worldMatrix[1], worldMatrix[1])), glm::dot(worldMatrix[2], worldMatrix[2])));
+    float radius = glm::length(bounds.GetSize()) * scale;
+
+    // Perspective projections divide by the distance, w in clip space. Inside the sphere, it always gets the first level
+    const glm::mat4& projMatrix = m_frameUniforms.projMatrix;
+    float distance = 1.0f;
+    if (projMatrix[3][3] == 0.0f)
     {
-        DrawcallInfo drawcallInfo(model.GetMaterial(submeshIndex), worldMatrixIndex,
-            mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex));
+        distance = (m_frameUniforms.viewProjMatrix * center).w;
+        if (distance <= radius)
+        {
+            return 0;
+        }
+    }
 
-        for (DrawcallCollection& collection : m_drawcallCollections)
+    // Diameter over the screen height, that is 2 in clip space
+    float screenSize = radius * projMatrix[1][1] / distance;
+    return model.SelectLod(screenSize, lodCount, previousLod, hysteresis);
+}
+
+void Renderer::CullModels()
+{
+    FrustumBounds frustum(m_currentCamera->GetViewProjectionMatrix());
+
+    // The depth of the occluders must be ready before the culling tasks start
+    if (m_occlusionCullingEnabled && m_occlusionCuller.HasOccluders())
+    {
+        ITUGL_PROFILE_SCOPE("RasterizeOccluders");
+        m_occlusionCuller.Rasterize(m_currentCamera->GetViewProjectionMatrix(), m_threadPool);
+    }
+
+    unsigned int modelCount = static_cast<unsigned int>(m_models.size());
+    unsigned int taskCount = m_threadPool.GetTaskCount(modelCount, MinModelsPerCullingTask);
+    if (m_cullingBuckets.size() < taskCount)
+    {
+        m_cullingBuckets.resize(taskCount);
+    }
+    for (unsigned int taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+    {
+        CullingBucket& bucket = m_cullingBuckets[taskIndex];
+        bucket.drawcallInfos.resize(m_drawcallCollections.size());
+        for (std::vector<DrawcallInfo>& drawcallInfos : bucket.drawcallInfos)
+        {
+            drawcallInfos.clear();
+        }
+        bucket.stats = CullingStats();
+    }
+
+    m_threadPool.ParallelFor(modelCount, MinModelsPerCullingTask, [&](unsigned int begin, unsigned int end, unsigned int taskIndex)
+        {
+            CullModels(begin, end, frustum, m_cullingBuckets[taskIndex]);
+        });
+
+    // Merge in task order, so the result is the same as culling all the models in a single thread
+    m_cullingStats = CullingStats();
+    for (unsigned int taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+    {
+        const CullingBucket& bucket = m_cullingBuckets[taskIndex];
+        for (unsigned int collectionIndex = 0; collectionIndex < m_drawcallCollections.size(); ++collectionIndex)
         {
-            collection.AddDrawcall(drawcallInfo);
+            m_drawcallCollections[collectionIndex].AddSupportedDrawcalls(bucket.drawcallInfos[collectionIndex]);
+        }
+        m_cullingStats.visibleDrawcalls += bucket.stats.visibleDrawcalls;
+        m_cullingStats.culledDrawcalls += bucket.stats.culledDrawcalls;
+        m_cullingStats.occludedDrawcalls += bucket.stats.occludedDrawcalls;
+        m_cullingStats.reducedLodDrawcalls += bucket.stats.reducedLodDrawcalls;
+    }
+
+    CullStaticDrawcalls(frustum);
+}
+
+void Renderer::CullModels(unsigned int begin, unsigned int end, const FrustumBounds& frustum, CullingBucket& bucket) const
+{
+    for (unsigned int modelIndex = begin; modelIndex < end; ++modelIndex)
+    {
+        const auto& [model, worldMatrixIndex] = m_models[modelIndex];
+        const Mesh& mesh = model->GetMesh();
+        const glm::mat4& worldMatrix = m_worldMatrices[worldMatrixIndex];
+        unsigned int submeshCount = mesh.GetSubmeshCount();
+
+        // Test the whole mesh first, to skip all the submeshes at once
+        if (m_frustumCullingEnabled && mesh.HasBounds() && !Bounds::Intersects(frustum, BoxBounds(mesh.GetBounds(), worldMatrix)))
+        {
+            bucket.stats.culledDrawcalls += submeshCount;
+            continue;
+        }
+
+        // Occlusion is only tested for the whole mesh. Submeshes are close to each other, they are usually hidden together
+        if (mesh.HasBounds() && !m_occlusionCuller.IsVisible(BoxBounds(mesh.GetBounds(), worldMatrix)))
+        {
+            bucket.stats.occludedDrawcalls += submeshCount;
+            continue;
+        }
+
+        for (unsigned int submeshIndex = 0; submeshIndex < submeshCount; ++submeshIndex)
+        {
+            // With a single submesh, the mesh test was enough
+            if (m_frustumCullingEnabled && submeshCount > 1 && mesh.HasSubmeshBounds(submeshIndex)
+                && !Bounds::Intersects(frustum, BoxBounds(mesh.GetSubmeshBounds(submeshIndex), worldMatrix)))
+            {
+                bucket.stats.culledDrawcalls++;
+                continue;
+            }
+
+            // Models added every frame have no previous level, so they don't use the hysteresis
+            unsigned int lod = m_lodSelectionEnabled ? SelectLod(*model, submeshIndex, worldMatrix, 0, 0.0f) : 0;
+            bucket.stats.reducedLodDrawcalls += lod > 0 ? 1 : 0;
+
+            DrawcallInfo drawcallInfo(model->GetMaterial(submeshIndex), worldMatrixIndex,
+                mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex, lod));
+
+            // Supported functions only read the drawcall, so they can run in the worker threads
+            for (unsigned int collectionIndex = 0; collectionIndex < m_drawcallCollections.size(); ++collectionIndex)
+            {
+                if (m_drawcallCollections[collectionIndex].IsSupported(drawcallInfo))
+                {
+                    bucket.drawcallInfos[collectionIndex].push_back(drawcallInfo);
+                }
+            }
+            bucket.stats.visibleDrawcalls++;
         }
     }
 }
@@ -262,20 +1076,35 @@ void Renderer::SetDrawcallCollectionSupportedFunction(unsigned int index, const
 
 void Renderer::SortDrawcallCollection(unsigned int index, const DrawcallSortFunction& drawcallSortFunction)
 {
-    auto drawcalls = m_drawcallCollections[index].GetDrawcalls();
-    std::sort(drawcalls.begin(), drawcalls.end(), drawcallSortFunction);
+    m_drawcallCollections[index].Sort(drawcallSortFunction);
 }
 
-bool Renderer::IsBackToFront(const DrawcallInfo& a, const DrawcallInfo& b) const
+bool Renderer::IsDepthPrePassEnabled(unsigned int collectionIndex) const
 {
-    const Camera& camera = GetCurrentCamera();
-    glm::vec3 cameraPosition = camera.ExtractTranslation();
-    glm::vec3 right, up, forward;
-    camera.ExtractVectors(right, up, forward);
+    return m_drawcallCollections[collectionIndex].IsDepthPrePassEnabled();
+}
+
+void Renderer::SetDepthPrePassEnabled(unsigned int collectionIndex, bool enabled)
+{
+    m_drawcallCollections[collectionIndex].SetDepthPrePassEnabled(enabled);
+}
+
+bool Renderer::IsInDepthPrePass(const DrawcallInfo& drawcallInfo)
+{
+    const Material& material = drawcallInfo.GetMaterial();
+    return !material.HasBlend() && material.GetDepthWrite();
+}
 
-    glm::vec3 aDistance = glm::vec3(GetWorldMatrix(a)[3]) - cameraPosition;
-    glm::vec3 bDistance = glm::vec3(GetWorldMatrix(b)[3]) - cameraPosition;
-    return glm::dot(forward, aDistance) < glm::dot(forward, bDistance);
+void Renderer::SetDepthPrePassRenderStates()
+{
+    // The pre-pass drew the same positions with invariant shaders, so the closest fragments match the depth exactly
+    m_device.SetDepthFunction(GL_EQUAL);
+    m_device.SetDepthWrite(false);
+}
+
+bool Renderer::IsBackToFront(const DrawcallInfo& a, const DrawcallInfo& b) const
+{
+    return GetViewDepth(a) > GetViewDepth(b);
 }
 
 bool Renderer::IsFrontToBack(const DrawcallInfo& a, const DrawcallInfo& b) const
@@ -285,29 +1114,101 @@ bool Renderer::IsFrontToBack(const DrawcallInfo& a, const DrawcallInfo& b) const
 
 void Renderer::PrepareDrawcall(const DrawcallInfo& drawcallInfo, Material::OverrideFlags materialOverride)
 {
-    std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.GetMaterial().GetShaderProgram();
-
-    // TODO: Room for optimization here, caching current material, current worldMatrixIndex and current VAO
+    const Material& material = drawcallInfo.GetMaterial();
+    const ShaderProgram& shaderProgram = material.GetShaderProgramRef();
 
     // Setup material
-    drawcallInfo.GetMaterial().Use(materialOverride);
+    if (&material != m_currentMaterial)
+    {
+        material.Use(materialOverride);
+        m_currentMaterial = &material;
+    }
+    else
+    {
+        // Same material as the previous drawcall: program and uniforms are already set
+        // Render states could have been changed in between (for example, by SetLightingRenderStates)
+        material.UseRenderStates(materialOverride);
+    }
 
     // Setup world matrix
-    // Setup camera
-    UpdateTransforms(shaderProgram, drawcallInfo.GetWorldMatrixIndex());
+    // Setup camera, only if it changed since the last upload to this program
+    UpdateTransforms(shaderProgram, drawcallInfo.GetWorldMatrixIndex(), UpdateCameraState(shaderProgram));
 
-    // Setup VAO
+    // Setup VAO. The device skips the bind if the VAO is already bound
     drawcallInfo.GetVAO().Bind();
 }
 
+unsigned int Renderer::PrepareInstancedDrawcall(std::span<const DrawcallInfo> drawcallInfos, Material::OverrideFlags materialOverride)
+{
+    assert(!drawcallInfos.empty());
+
+    const DrawcallInfo& firstDrawcallInfo = drawcallInfos[0];
+    PrepareDrawcall(firstDrawcallInfo, materialOverride);
+
+    if (!IsInstancingSupported(firstDrawcallInfo.GetMaterial().GetShaderProgramRef()))
+    {
+        return 1;
+    }
+
+    // Collect the following drawcalls that can be merged. Sort keys place them next to each other
+    m_instanceWorldMatrices.clear();
+    for (const DrawcallInfo& drawcallInfo : drawcallInfos)
+    {
+        if (&drawcallInfo.GetMaterial() != &firstDrawcallInfo.GetMaterial() ||
+            &drawcallInfo.GetVAO() != &firstDrawcallInfo.GetVAO() ||
+            &drawcallInfo.GetDrawcall() != &firstDrawcallInfo.GetDrawcall())
+        {
+            break;
+        }
+        m_instanceWorldMatrices.push_back(GetWorldMatrix(drawcallInfo));
+    }
+
+    SetInstanceWorldMatrices(firstDrawcallInfo.GetVAO(), m_instanceWorldMatrices);
+
+    return static_cast<unsigned int>(m_instanceWorldMatrices.size());
+}
+
+void Renderer::SetInstanceWorldMatrices(const VertexArrayObject& vao, std::span<const glm::mat4> worldMatrices)
+{
+    assert(VertexArrayObject::IsAnyBound());
+
+    // Allocating again orphans the previous contents, so we don't wait for drawcalls still using them
+    m_instanceBuffer.Bind();
+    m_instanceBuffer.AllocateData(worldMatrices, BufferObject::StreamDraw);
+
+    // Point the instance attributes of the VAO to the instance buffer, once per frame
+    if (!m_instancedVAOs.contains(&vao))
+    {
+        SetInstanceAttributes(vao, m_instanceBuffer);
+        m_instancedVAOs.insert(&vao);
+    }
+}
+
+void Renderer::SetInstanceAttributes(const VertexArrayObject& vao, const VertexBufferObject& buffer)
+{
+    // Attributes read the buffer bound when they are set
+    buffer.Bind();
+
+    // VAO setup methods are not const, but they don't modify the object, only the GL state it refers to
+    VertexArrayObject& mutableVao = const_cast<VertexArrayObject&>(vao);
+    VertexAttribute columnAttribute(Data::Type::Float, 4);
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        GLuint location = InstanceWorldMatrixLocation + column;
+        mutableVao.SetAttribute(location, columnAttribute, column * sizeof(glm::vec4), sizeof(glm::mat4));
+        mutableVao.SetAttributeDivisor(location, 1);
+    }
+}
+
 void Renderer::SetLightingRenderStates(bool firstPass)
 {
     // Set the render states for the first and additional lights
     if (!firstPass)
     {
         m_device.SetFeatureEnabled(GL_BLEND, true);
-        glDepthFunc(firstPass ? GL_LESS : GL_EQUAL);
-        glBlendFunc(GL_ONE, GL_ONE);
+        m_device.SetDepthFunction(GL_EQUAL);
+        m_device.SetBlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+        m_device.SetBlendFunction(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
     }
 }
 
@@ -326,5 +1227,166 @@ void Renderer::InitializeFullscreenMesh()
 
 const glm::mat4& Renderer::GetWorldMatrix(const DrawcallInfo& drawcallInfo) const
 {
-    return m_worldMatrices[drawcallInfo.GetWorldMatrixIndex()];
+    return GetWorldMatrix(drawcallInfo.GetWorldMatrixIndex());
+}
+
+const glm::mat4& Renderer::GetWorldMatrix(unsigned int worldMatrixIndex) const
+{
+    if (worldMatrixIndex & StaticWorldMatrixFlag)
+    {
+        return m_staticWorldMatrices[worldMatrixIndex & ~StaticWorldMatrixFlag];
+    }
+    return m_worldMatrices[worldMatrixIndex];
+}
+
+float Renderer::GetViewDepth(const DrawcallInfo& drawcallInfo) const
+{
+    // Camera looks down the negative Z axis in view space
+    const glm::mat4& viewMatrix = GetCurrentCamera().GetViewMatrix();
+    return -(viewMatrix * GetWorldMatrix(drawcallInfo)[3]).z;
+}
+
+void Renderer::SortDrawcalls()
+{
+    for (unsigned int collectionIndex = 0; collectionIndex < m_drawcallCollections.size(); ++collectionIndex)
+    {
+        DrawcallCollection& collection = m_drawcallCollections[collectionIndex];
+
+        // Visible static opaque drawcalls are cached in state order
+        m_visibleStaticDrawcalls.clear();
+        for (unsigned int i : m_staticDrawcallIndices[collectionIndex])
+        {
+            if (m_staticDrawcallVisible[i] == Visible && !m_staticDrawcalls[i].drawcallInfo.GetMaterial().HasBlend())
+            {
+                m_visibleStaticDrawcalls.push_back(GetStaticDrawcallInfo(i));
+            }
+        }
+
+        // The cached order doesn't match a custom function, so the static drawcalls are sorted with the rest
+        if (collection.HasSortFunction())
+        {
+            collection.AddSupportedDrawcalls(m_visibleStaticDrawcalls);
+            collection.SortWithSortFunction();
+            continue;
+        }
+
+        // Keys only read the drawcall and the camera, so they are computed in parallel
+        std::span<DrawcallInfo> drawcallInfos = collection.GetDrawcalls();
+        m_threadPool.ParallelFor(static_cast<unsigned int>(drawcallInfos.size()), MinDrawcallsPerSortTask, [&](unsigned int begin, unsigned int end, unsigned int)
+            {
+                for (unsigned int i = begin; i < end; ++i)
+                {
+                    drawcallInfos[i].SetSortKey(ComputeSortKey(drawcallInfos[i], GetViewDepth(drawcallInfos[i])));
+                }
+            });
+        collection.SortByKey();
+
+        // With the default order, the static drawcalls are merged with the sorted ones instead
+        collection.MergeSupportedDrawcalls(m_visibleStaticDrawcalls, IsStateSortedBefore);
+    }
+}
+
+uint64_t Renderer::ComputeSortKey(const DrawcallInfo& drawcallInfo, float viewDepth) const
+{
+    const Material& material = drawcallInfo.GetMaterial();
+
+    // Bits of a positive float have the same order as the value, so they can be used directly as depth
+    float depth = std::max(viewDepth, 0.0f);
+    uint64_t depthBits = std::bit_cast<uint32_t>(depth);
+
+    // Ids only need to be equal for the same state, collisions just make the grouping less effective
+    uint64_t programId = material.GetShaderProgramRef().GetId() & 0xFFFF;
+    uint64_t materialId = (reinterpret_cast<uintptr_t>(&material) >> 4) & 0xFFFF;
+    uint64_t vaoId = drawcallInfo.GetVAO().GetHandle() & 0xFFFF;
+
+    if (material.HasBlend())
+    {
+        // Translucent: after all opaque drawcalls, back to front, then grouped by state
+        // | 1 translucent | 31 inverted depth | 16 program | 16 material |
+        uint64_t invertedDepth = ~depthBits & 0x7FFFFFFF;
+        return (1ull << 63) | (invertedDepth << 32) | (programId << 16) | materialId;
+    }
+    else
+    {
+        // Opaque: grouped by state to reduce changes, then front to back to reject hidden fragments early
+        // | 1 translucent | 16 program | 16 material | 16 VAO | 15 coarse depth |
+        uint64_t coarseDepth = (depthBits >> 16) & 0x7FFF;
+        return (programId << 47) | (materialId << 31) | (vaoId << 15) | coarseDepth;
+    }
+}
+
+bool Renderer::IsStateSortedBefore(const DrawcallInfo& a, const DrawcallInfo& b)
+{
+    // Dropping the coarse depth bits keeps the order of the full keys, opaque and translucent
+    return (a.GetSortKey() >> 15) < (b.GetSortKey() >> 15);
+}
+
+void Renderer::UpdateFrameUniforms()
+{
+    // Inverses are computed here once, instead of for every shader program that needs them
+    const Camera& camera = GetCurrentCamera();
+    m_frameUniforms.viewMatrix = camera.GetViewMatrix();
+    m_frameUniforms.projMatrix = camera.GetProjectionMatrix();
+    m_frameUniforms.viewProjMatrix = camera.GetViewProjectionMatrix();
+    m_frameUniforms.invViewMatrix = glm::inverse(m_frameUniforms.viewMatrix);
+    m_frameUniforms.invProjMatrix = glm::inverse(m_frameUniforms.projMatrix);
+    m_frameUniforms.invViewProjMatrix = glm::inverse(m_frameUniforms.viewProjMatrix);
+    m_frameUniforms.cameraPosition = glm::vec3(m_frameUniforms.invViewMatrix[3]);
+
+    m_frameUniformBuffer.Bind();
+    m_frameUniformBuffer.UpdateData(m_frameUniforms);
+    m_frameUniformBuffer.BindBase(FrameUniformsBinding);
+}
+
+void Renderer::UpdateLightArrayUniforms()
+{
+    // Too many lights, the programs fall back to one pass per light
+    m_lightArrayUploaded = m_lights.size() <= MaxArrayLights;
+    if (!m_lightArrayUploaded)
+    {
+        return;
+    }
+
+    m_lightArrayUniforms.lightCount = glm::ivec4(static_cast<int>(m_lights.size()), 0, 0, 0);
+    for (unsigned int i = 0; i < m_lights.size(); ++i)
+    {
+        const Light& light = *m_lights[i];
+        LightArrayUniforms::LightUniforms& lightUniforms = m_lightArrayUniforms.lights[i];
+        lightUniforms.color = glm::vec4(light.GetColor() * light.GetIntensity(), 0.0f);
+        lightUniforms.position = glm::vec4(light.GetPosition(), 1.0f);
+        lightUniforms.direction = glm::vec4(light.GetDirection(), 0.0f);
+        lightUniforms.attenuation = light.GetAttenuation();
+    }
+
+    m_lightArrayUniformBuffer.Bind();
+    m_lightArrayUniformBuffer.UpdateData(m_lightArrayUniforms);
+    m_lightArrayUniformBuffer.BindBase(LightArrayUniformsBinding);
+}
+
+bool Renderer::IsLightArrayUploaded(std::span<const Light* const> lights) const
+{
+    // Passes can use their own list of lights. Only the lights of the frame are in the array
+    return m_lightArrayUploaded && lights.data() == m_lights.data() && lights.size() == m_lights.size();
+}
+
+bool Renderer::UpdateCameraState(const ShaderProgram& shaderProgram)
+{
+    const glm::mat4& viewMatrix = m_currentCamera->GetViewMatrix();
+    const glm::mat4& projectionMatrix = m_currentCamera->GetProjectionMatrix();
+
+    // Only registered programs have a camera state, the others don't have hooks to skip
+    unsigned int shaderProgramId = shaderProgram.GetId();
+    if (shaderProgramId >= m_cameraStates.size())
+    {
+        return true;
+    }
+
+    CameraState& cameraState = m_cameraStates[shaderProgramId];
+    if (cameraState.valid && cameraState.viewMatrix == viewMatrix && cameraState.projectionMatrix == projectionMatrix)
+    {
+        return false;
+    }
+
+    cameraState = CameraState{ viewMatrix, projectionMatrix, true };
+    return true;
 }
@@ -0,0 +1,419 @@
+#include <ituGL/renderer/ShadowMapRenderPass.h>
+
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/lighting/DirectionalLight.h>
+#include <ituGL/scene/Bounds.h>
+#include <ituGL/shader/Shader.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <glm/geometric.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+static const char* s_vertexShaderSource = R"(#version 330 core
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 12) in mat4 InstanceWorldMatrix;
+
+uniform mat4 ShadowViewProjMatrix;
+
+void main()
+{
+	gl_Position = ShadowViewProjMatrix * (InstanceWorldMatrix * vec4(VertexPosition, 1.0));
+}
+)";
+
+static const char* s_fragmentShaderSource = R"(#version 330 core
+void main()
+{
+}
+)";
+
+ShadowMapRenderPass::ShadowMapRenderPass(std::shared_ptr<const DirectionalLight> light, int cascadeResolution, unsigned int cascadeCount)
+    : m_light(light)
+    , m_cascadeResolution(cascadeResolution)
+    , m_cascadeCount(cascadeCount)
+    , m_tileCountX(cascadeCount > 1 ? 2 : 1)
+    , m_tileCountY((cascadeCount + 1) / 2)
+    , m_enabled(true)
+    , m_staticCacheEnabled(true)
+    , m_maxDistance(50.0f)
+    , m_casterDistance(100.0f)
+    , m_regionMargin(0.25f)
+    , m_cascadeSplits{}
+    , m_lightDirection(0.0f)
+    , m_lightViewMatrix(1.0f)
+    , m_staticModelsVersion(0)
+    , m_frameIndex(0)
+    , m_uniforms()
+    , m_viewProjMatrixLocation(-1)
+{
+    assert(light);
+    assert(cascadeCount > 0 && cascadeCount <= MaxCascades);
+
+    // The first two cascades every frame, then every 2 and 4 frames
+    for (unsigned int cascadeIndex = 0; cascadeIndex < MaxCascades; ++cascadeIndex)
+    {
+        m_cascades[cascadeIndex].updateInterval = 1u << std::max(static_cast<int>(cascadeIndex) - 1, 0);
+    }
+
+    int width = m_tileCountX * cascadeResolution;
+    int height = m_tileCountY * cascadeResolution;
+
+    // Same format for both, so the tiles can be copied with a blit
+    m_staticCacheTexture = std::make_shared<Texture2DObject>();
+    m_staticCacheTexture->Bind();
+    m_staticCacheTexture->SetImage(0, width, height, TextureObject::FormatDepth, TextureObject::InternalFormatDepth32F);
+    m_staticCacheTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+    m_staticCacheTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+
+    // Linear filter with comparison: each lookup blends the result of 2x2 texels
+    m_shadowMapTexture = std::make_shared<Texture2DObject>();
+    m_shadowMapTexture->Bind();
+    m_shadowMapTexture->SetImage(0, width, height, TextureObject::FormatDepth, TextureObject::InternalFormatDepth32F);
+    m_shadowMapTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    m_shadowMapTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    m_shadowMapTexture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+    m_shadowMapTexture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+    m_shadowMapTexture->SetParameter(TextureObject::ParameterEnum::CompareMode, GL_COMPARE_REF_TO_TEXTURE);
+    m_shadowMapTexture->SetParameter(TextureObject::ParameterEnum::CompareFunction, GL_LEQUAL);
+    Texture2DObject::Unbind();
+
+    // Depth only, without color buffers
+    m_staticCacheFramebuffer = std::make_shared<FramebufferObject>();
+    m_staticCacheFramebuffer->Bind();
+    m_staticCacheFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Depth, *m_staticCacheTexture);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    m_shadowMapFramebuffer = std::make_shared<FramebufferObject>();
+    m_shadowMapFramebuffer->Bind();
+    m_shadowMapFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Depth, *m_shadowMapTexture);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    FramebufferObject::Unbind();
+
+    m_uniformBuffer.Bind();
+    m_uniformBuffer.AllocateData(m_uniforms);
+}
+
+ShadowMapRenderPass::~ShadowMapRenderPass()
+{
+}
+
+void ShadowMapRenderPass::SetUpdateInterval(unsigned int cascadeIndex, unsigned int interval)
+{
+    assert(cascadeIndex < MaxCascades);
+    assert(interval > 0);
+    m_cascades[cascadeIndex].updateInterval = interval;
+}
+
+void ShadowMapRenderPass::Invalidate()
+{
+    for (Cascade& cascade : m_cascades)
+    {
+        cascade.staticValid = false;
+    }
+}
+
+void ShadowMapRenderPass::SetupShaderProgram(const ShaderProgram& shaderProgram)
+{
+    GLuint blockIndex = shaderProgram.GetUniformBlockIndex("ShadowUniforms");
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        shaderProgram.SetUniformBlockBinding(blockIndex, ShadowUniformsBinding);
+    }
+}
+
+void ShadowMapRenderPass::InitializeShaderProgram()
+{
+    Shader vertexShader(Shader::VertexShader);
+    vertexShader.SetSource(s_vertexShaderSource);
+    bool compiled = vertexShader.Compile();
+    assert(compiled);
+
+    Shader fragmentShader(Shader::FragmentShader);
+    fragmentShader.SetSource(s_fragmentShaderSource);
+    compiled = fragmentShader.Compile();
+    assert(compiled);
+
+    m_shaderProgram = std::make_shared<ShaderProgram>();
+    bool built = m_shaderProgram->Build(vertexShader, fragmentShader);
+    assert(built);
+
+    m_viewProjMatrixLocation = m_shaderProgram->GetUniformLocation("ShadowViewProjMatrix");
+
+    // The world matrices come from the instance buffer, so there are no hooks
+    GetRenderer().RegisterShaderProgram(m_shaderProgram, nullptr, nullptr);
+    assert(GetRenderer().IsInstancingSupported(*m_shaderProgram));
+}
+
+void ShadowMapRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    m_stats = Stats();
+
+    if (!m_enabled)
+    {
+        UploadUniforms(0);
+        return;
+    }
+
+    if (!m_shaderProgram)
+    {
+        InitializeShaderProgram();
+    }
+
+    // The regions are in light space, so a new direction moves all of them
+    glm::vec3 lightDirection = glm::normalize(m_light->GetDirection());
+    if (lightDirection != m_lightDirection)
+    {
+        m_lightDirection = lightDirection;
+        glm::vec3 up = std::abs(lightDirection.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        m_lightViewMatrix = glm::lookAt(glm::vec3(0.0f), lightDirection, up);
+        for (Cascade& cascade : m_cascades)
+        {
+            cascade.radius = 0.0f;
+        }
+        Invalidate();
+    }
+
+    if (renderer.GetStaticModelsVersion() != m_staticModelsVersion)
+    {
+        m_staticModelsVersion = renderer.GetStaticModelsVersion();
+        Invalidate();
+    }
+
+    // Corners of the view frustum on the near and far planes, in view space
+    const Renderer::FrameUniforms& frameUniforms = renderer.GetFrameUniforms();
+    std::array<glm::vec3, 4> nearCorners;
+    std::array<glm::vec3, 4> farCorners;
+    for (int i = 0; i < 4; ++i)
+    {
+        glm::vec2 corner((i & 1) != 0 ? 1.0f : -1.0f, (i & 2) != 0 ? 1.0f : -1.0f);
+        glm::vec4 nearCorner = frameUniforms.invProjMatrix * glm::vec4(corner, -1.0f, 1.0f);
+        glm::vec4 farCorner = frameUniforms.invProjMatrix * glm::vec4(corner, 1.0f, 1.0f);
+        nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+        farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+    }
+    float nearDepth = -nearCorners[0].z;
+    float farDepth = -farCorners[0].z;
+    float maxDepth = std::min(farDepth, m_maxDistance);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    device.SetFeatureEnabled(GL_BLEND, false);
+    device.SetFeatureEnabled(GL_DEPTH_TEST, true);
+    device.SetDepthFunction(GL_LESS);
+    device.SetDepthWrite(true);
+    // Casters in front of the near plane are clamped to it, so the regions don't need to include them
+    device.SetFeatureEnabled(GL_DEPTH_CLAMP, true);
+    device.SetFeatureEnabled(GL_POLYGON_OFFSET_FILL, true);
+    glPolygonOffset(2.0f, 4.0f);
+
+    float sliceNearDepth = nearDepth;
+    for (unsigned int cascadeIndex = 0; cascadeIndex < m_cascadeCount; ++cascadeIndex)
+    {
+        Cascade& cascade = m_cascades[cascadeIndex];
+
+        // Split between a logarithmic and a uniform distribution, so the near cascades get more resolution
+        float t = static_cast<float>(cascadeIndex + 1) / m_cascadeCount;
+        float logSplit = nearDepth * std::pow(maxDepth / nearDepth, t);
+        float uniformSplit = nearDepth + (maxDepth - nearDepth) * t;
+        float sliceFarDepth = 0.75f * logSplit + 0.25f * uniformSplit;
+        m_cascadeSplits[cascadeIndex] = sliceFarDepth;
+
+        // Sphere around the slice, computed in view space so it doesn't change when the camera rotates
+        glm::vec3 sliceCorners[8];
+        glm::vec3 sliceCenter(0.0f);
+        for (int i = 0; i < 4; ++i)
+        {
+            glm::vec3 edge = farCorners[i] - nearCorners[i];
+            sliceCorners[i] = nearCorners[i] + edge * ((sliceNearDepth - nearDepth) / (farDepth - nearDepth));
+            sliceCorners[i + 4] = nearCorners[i] + edge * ((sliceFarDepth - nearDepth) / (farDepth - nearDepth));
+            sliceCenter += sliceCorners[i] + sliceCorners[i + 4];
+        }
+        sliceCenter /= 8.0f;
+        float sliceRadius = 0.0f;
+        for (const glm::vec3& sliceCorner : sliceCorners)
+        {
+            sliceRadius = std::max(sliceRadius, glm::distance(sliceCorner, sliceCenter));
+        }
+        sliceNearDepth = sliceFarDepth;
+
+        glm::vec3 lightSliceCenter = glm::vec3(m_lightViewMatrix * (frameUniforms.invViewMatrix * glm::vec4(sliceCenter, 1.0f)));
+        if (UpdateCascadeRegion(cascade, lightSliceCenter, sliceRadius))
+        {
+            cascade.staticValid = false;
+        }
+
+        // A cascade with a new region must be drawn now. The rest only on their frames
+        bool renderStatic = !cascade.staticValid || !m_staticCacheEnabled;
+        bool updateDue = (m_frameIndex + cascadeIndex) % cascade.updateInterval == 0;
+        if (!renderStatic && !updateDue)
+        {
+            continue;
+        }
+
+        // Casters are culled with the region extended towards the light
+        FrustumBounds casterBounds(ComputeProjectionMatrix(cascade, m_casterDistance) * m_lightViewMatrix);
+        m_dynamicCasters.clear();
+        renderer.GetShadowCasters(casterBounds, false, m_dynamicCasters);
+
+        // Nothing changed in the tile since the last update
+        if (!renderStatic && m_dynamicCasters.empty() && !cascade.hasDynamicCasters)
+        {
+            continue;
+        }
+
+        m_stats.updatedCascades++;
+
+        if (renderStatic)
+        {
+            m_staticCasters.clear();
+            renderer.GetShadowCasters(casterBounds, true, m_staticCasters);
+
+            renderer.SetCurrentFramebuffer(m_staticCacheFramebuffer);
+            SetTileViewport(cascadeIndex, true);
+            DrawCasters(m_staticCasters, cascade.viewProjMatrix);
+            cascade.staticValid = true;
+
+            m_stats.staticCascades++;
+            m_stats.staticDrawcalls += static_cast<unsigned int>(m_staticCasters.size());
+        }
+
+        // Start from the static depth. Blits are limited by the scissor, so it is disabled
+        renderer.SetCurrentFramebuffer(m_shadowMapFramebuffer);
+        m_staticCacheFramebuffer->Bind(FramebufferObject::Target::Read);
+        GLint x = (cascadeIndex % m_tileCountX) * m_cascadeResolution;
+        GLint y = (cascadeIndex / m_tileCountX) * m_cascadeResolution;
+        glBlitFramebuffer(x, y, x + m_cascadeResolution, y + m_cascadeResolution,
+            x, y, x + m_cascadeResolution, y + m_cascadeResolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        m_shadowMapFramebuffer->Bind(FramebufferObject::Target::Read);
+
+        SetTileViewport(cascadeIndex, false);
+        DrawCasters(m_dynamicCasters, cascade.viewProjMatrix);
+        cascade.hasDynamicCasters = !m_dynamicCasters.empty();
+
+        m_stats.dynamicDrawcalls += static_cast<unsigned int>(m_dynamicCasters.size());
+    }
+
+    device.SetFeatureEnabled(GL_DEPTH_CLAMP, false);
+    device.SetFeatureEnabled(GL_POLYGON_OFFSET_FILL, false);
+    device.SetViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    UploadUniforms(m_cascadeCount);
+    m_frameIndex++;
+}
+
+bool ShadowMapRenderPass::UpdateCascadeRegion(Cascade& cascade, const glm::vec3& sliceCenter, float sliceRadius)
+{
+    // Keep the region while it contains the slice, unless it became too big, for example after the field of view changed
+    float regionRadius = sliceRadius * (1.0f + m_regionMargin);
+    if (glm::distance(sliceCenter, cascade.center) + sliceRadius <= cascade.radius && regionRadius > 0.75f * cascade.radius)
+    {
+        return false;
+    }
+
+    cascade.center = sliceCenter;
+    cascade.radius = regionRadius;
+    cascade.viewProjMatrix = ComputeProjectionMatrix(cascade, 0.0f) * m_lightViewMatrix;
+    return true;
+}
+
+glm::mat4 ShadowMapRenderPass::ComputeProjectionMatrix(const Cascade& cascade, float casterDistance) const
+{
+    // Light space looks down -z, so the casters closer to the light have a higher z
+    const glm::vec3& center = cascade.center;
+    float radius = cascade.radius;
+    return glm::ortho(center.x - radius, center.x + radius, center.y - radius, center.y + radius,
+        -(center.z + radius + casterDistance), -(center.z - radius));
+}
+
+void ShadowMapRenderPass::SetTileViewport(unsigned int cascadeIndex, bool clear)
+{
+    DeviceGL& device = GetRenderer().GetDevice();
+
+    GLint x = (cascadeIndex % m_tileCountX) * m_cascadeResolution;
+    GLint y = (cascadeIndex / m_tileCountX) * m_cascadeResolution;
+    device.SetViewport(x, y, m_cascadeResolution, m_cascadeResolution);
+
+    // Clears ignore the viewport, the scissor keeps the other tiles
+    if (clear)
+    {
+        device.SetFeatureEnabled(GL_SCISSOR_TEST, true);
+        glScissor(x, y, m_cascadeResolution, m_cascadeResolution);
+        device.Clear(false, Color(), true, 1.0f);
+        device.SetFeatureEnabled(GL_SCISSOR_TEST, false);
+    }
+}
+
+void ShadowMapRenderPass::DrawCasters(std::span<const Renderer::DrawcallInfo> drawcallInfos, const glm::mat4& viewProjMatrix)
+{
+    Renderer& renderer = GetRenderer();
+
+    // Group the drawcalls of the same mesh, to draw them as instances
+    for (InstanceGroup& instanceGroup : m_instanceGroups)
+    {
+        instanceGroup.worldMatrices.clear();
+    }
+    unsigned int instanceGroupCount = 0;
+    m_instanceGroupIndices.clear();
+    for (const Renderer::DrawcallInfo& drawcallInfo : drawcallInfos)
+    {
+        auto itGroup = m_instanceGroupIndices.try_emplace(&drawcallInfo.GetDrawcall(), instanceGroupCount).first;
+        if (itGroup->second == instanceGroupCount)
+        {
+            if (instanceGroupCount == m_instanceGroups.size())
+            {
+                m_instanceGroups.emplace_back();
+            }
+            InstanceGroup& instanceGroup = m_instanceGroups[instanceGroupCount++];
+            instanceGroup.vao = &drawcallInfo.GetVAO();
+            instanceGroup.drawcall = &drawcallInfo.GetDrawcall();
+        }
+        m_instanceGroups[itGroup->second].worldMatrices.push_back(renderer.GetWorldMatrix(drawcallInfo));
+    }
+
+    m_shaderProgram->Use();
+    m_shaderProgram->SetUniform(m_viewProjMatrixLocation, viewProjMatrix);
+    for (unsigned int groupIndex = 0; groupIndex < instanceGroupCount; ++groupIndex)
+    {
+        const InstanceGroup& instanceGroup = m_instanceGroups[groupIndex];
+        instanceGroup.vao->Bind();
+        renderer.SetInstanceWorldMatrices(*instanceGroup.vao, instanceGroup.worldMatrices);
+        instanceGroup.drawcall->DrawInstanced(static_cast<GLsizei>(instanceGroup.worldMatrices.size()));
+    }
+}
+
+void ShadowMapRenderPass::UploadUniforms(unsigned int cascadeCount)
+{
+    glm::vec2 tileScale(1.0f / m_tileCountX, 1.0f / m_tileCountY);
+    for (unsigned int cascadeIndex = 0; cascadeIndex < cascadeCount; ++cascadeIndex)
+    {
+        const Cascade& cascade = m_cascades[cascadeIndex];
+
+        // From clip space to the texture coordinates of the tile, and depth from 0 to 1
+        glm::vec2 tileOffset = glm::vec2(cascadeIndex % m_tileCountX, cascadeIndex / m_tileCountX) * tileScale;
+        glm::mat4 tileMatrix(1.0f);
+        tileMatrix[0][0] = 0.5f * tileScale.x;
+        tileMatrix[1][1] = 0.5f * tileScale.y;
+        tileMatrix[2][2] = 0.5f;
+        tileMatrix[3] = glm::vec4(tileOffset + 0.5f * tileScale, 0.5f, 1.0f);
+
+        m_uniforms.cascadeMatrices[cascadeIndex] = tileMatrix * cascade.viewProjMatrix;
+        m_uniforms.cascadeSplits[cascadeIndex] = m_cascadeSplits[cascadeIndex];
+        m_uniforms.cascadeTexelSizes[cascadeIndex] = 2.0f * cascade.radius / m_cascadeResolution;
+    }
+    m_uniforms.lightDirection = glm::vec4(m_lightDirection, static_cast<float>(cascadeCount));
+
+    m_uniformBuffer.Bind();
+    m_uniformBuffer.UpdateData(m_uniforms);
+    m_uniformBuffer.BindBase(ShadowUniformsBinding);
+}
@@ -6,8 +6,9 @@
 #include <ituGL/asset/ShaderLoader.h>
 #include <ituGL/texture/TextureCubemapObject.h>
 
-SkyboxRenderPass::SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture)
-    : m_texture(texture)
+SkyboxRenderPass::SkyboxRenderPass(std::shared_ptr<TextureCubemapObject> texture, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+    : RenderPass(targetFramebuffer)
+    , m_texture(texture)
     , m_cameraPositionLocation(-1)
     , m_invViewProjMatrixLocation(-1)
     , m_skyboxTextureLocation(-1)
@@ -45,11 +46,11 @@ void SkyboxRenderPass::Render()
     m_shaderProgram.SetTexture(m_skyboxTextureLocation, 0, *m_texture);
 
     // Only write to depth == 1
-    glDepthFunc(GL_EQUAL);
+    renderer.GetDevice().SetDepthFunction(GL_EQUAL);
 
     const Mesh& fullscreenMesh = renderer.GetFullscreenMesh();
     fullscreenMesh.DrawSubmesh(0);
     
     // Restore default value
-    glDepthFunc(GL_LESS);
+    renderer.GetDevice().SetDepthFunction(GL_LESS);
 }
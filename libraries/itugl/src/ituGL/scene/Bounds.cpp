@@ -1,5 +1,9 @@
 #include <ituGL/scene/Bounds.h>
 
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <cmath>
+
 SphereBounds::SphereBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m_radius(0.0f)
 {
     switch (bounds.GetType())
@@ -8,10 +12,10 @@ SphereBounds::SphereBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m
         m_radius = static_cast<const SphereBounds&>(bounds).GetRadius();
         break;
     case Type::AABB:
-        m_radius = static_cast<const AabbBounds&>(bounds).GetSize().length();
+        m_radius = glm::length(static_cast<const AabbBounds&>(bounds).GetSize());
         break;
     case Type::Box:
-        m_radius = static_cast<const BoxBounds&>(bounds).GetSize().length();
+        m_radius = glm::length(static_cast<const BoxBounds&>(bounds).GetSize());
         break;
     default:
         assert(false);
@@ -31,9 +35,8 @@ AabbBounds::AabbBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m_siz
     case Type::Box:
         {
             glm::mat3 scaledMatrix = static_cast<const BoxBounds&>(bounds).GetScaledMatrix();
-            m_size = glm::abs(scaledMatrix[0]);
-            m_size = glm::max(m_size, glm::abs(scaledMatrix[1]));
-            m_size = glm::max(m_size, glm::abs(scaledMatrix[2]));
+            // Each axis of the box adds its extent along x, y and z
+            m_size = glm::abs(scaledMatrix[0]) + glm::abs(scaledMatrix[1]) + glm::abs(scaledMatrix[2]);
         }
         break;
     default:
@@ -61,6 +64,41 @@ BoxBounds::BoxBounds(const Bounds& bounds) : RotatedBounds(bounds.GetCenter(), g
     }
 }
 
+BoxBounds::BoxBounds(const AabbBounds& bounds, const glm::mat4& transformMatrix)
+    : RotatedBounds(transformMatrix * glm::vec4(bounds.GetCenter(), 1.0f), glm::mat3(1.0f)), m_size(0.0f)
+{
+    // Split each transformed axis in direction and length. Scale goes to the size, so the rotation stays orthonormal
+    for (int i = 0; i < 3; ++i)
+    {
+        glm::vec3 axis(transformMatrix[i]);
+        float length = glm::length(axis);
+        m_rotationMatrix[i] = length > 0.0f ? axis / length : glm::vec3(0.0f);
+        m_size[i] = bounds.GetSize()[i] * length;
+    }
+}
+
+FrustumBounds::FrustumBounds(const glm::mat4& viewProjMatrix) : Bounds(glm::vec3(0.0f))
+{
+    // Each plane is a combination of the 4th row with another row (Gribb & Hartmann)
+    // glm matrices are column-major, so we get the rows from the transpose
+    glm::mat4 rows = glm::transpose(viewProjMatrix);
+    m_planes[0] = rows[3] + rows[0];
+    m_planes[1] = rows[3] - rows[0];
+    m_planes[2] = rows[3] + rows[1];
+    m_planes[3] = rows[3] - rows[1];
+    m_planes[4] = rows[3] + rows[2];
+    m_planes[5] = rows[3] - rows[2];
+
+    for (glm::vec4& plane : m_planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    // Center is the middle point of the frustum, it is not used for the intersections
+    glm::vec4 center = glm::inverse(viewProjMatrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    m_center = glm::vec3(center) / center.w;
+}
+
 template<>
 bool Bounds::Intersects(const SphereBounds& boundsA, const SphereBounds& boundsB)
 {
@@ -100,8 +138,15 @@ bool Bounds::Intersects(const BoxBounds& boundsA, const AabbBounds& boundsB)
     return Bounds::Intersects(boundsA, BoxBounds(boundsB.GetCenter(), glm::mat3(1.0f), boundsB.GetSize()));
 }
 
-bool TestSeparationAxis(const glm::vec3& axis, const glm::vec3& distance, const glm::mat3& mA, const glm::mat3& mB)
+// The boxes don't overlap along the axis if their projected distance is bigger than the sum of their projected half sizes
+bool IsSeparatingAxis(const glm::vec3& axis, const glm::vec3& distance, const glm::mat3& mA, const glm::mat3& mB)
 {
+    // Cross products of parallel edges are 0, and can't separate the boxes. Their other axes are already tested
+    if (glm::dot(axis, axis) < 1e-6f)
+    {
+        return false;
+    }
+
     float projDistance = std::abs(glm::dot(distance, axis));
     float projSize = 0.0f;
     for (int i = 0; i < 3; ++i)
@@ -109,7 +154,7 @@ bool TestSeparationAxis(const glm::vec3& axis, const glm::vec3& distance, const
         projSize += std::abs(glm::dot(mA[i], axis));
         projSize += std::abs(glm::dot(mB[i], axis));
     }
-    return projSize <= projDistance;
+    return projSize < projDistance;
 }
 
 template<>
@@ -117,39 +162,79 @@ bool Bounds::Intersects(const BoxBounds& boundsA, const BoxBounds& boundsB)
 {
     glm::vec3 distance = boundsB.GetCenter() - boundsA.GetCenter();
     glm::mat3 mA = boundsA.GetScaledMatrix();
-    glm::mat3 mB = boundsA.GetScaledMatrix();
-    return TestSeparationAxis(boundsA.GetXVector(), distance, mA, mB)
-        && TestSeparationAxis(boundsA.GetYVector(), distance, mA, mB)
-        && TestSeparationAxis(boundsA.GetZVector(), distance, mA, mB)
-        && TestSeparationAxis(boundsB.GetXVector(), distance, mA, mB)
-        && TestSeparationAxis(boundsB.GetYVector(), distance, mA, mB)
-        && TestSeparationAxis(boundsB.GetZVector(), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetXVector(), boundsB.GetXVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetXVector(), boundsB.GetYVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetXVector(), boundsB.GetZVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetYVector(), boundsB.GetXVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetYVector(), boundsB.GetYVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetYVector(), boundsB.GetZVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetZVector(), boundsB.GetXVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetZVector(), boundsB.GetYVector()), distance, mA, mB)
-        && TestSeparationAxis(glm::cross(boundsA.GetZVector(), boundsB.GetZVector()), distance, mA, mB);
+    glm::mat3 mB = boundsB.GetScaledMatrix();
+
+    // Separating axis theorem: the face normals of both boxes, and the cross products of their edges
+    glm::vec3 axesA[3] = { boundsA.GetXVector(), boundsA.GetYVector(), boundsA.GetZVector() };
+    glm::vec3 axesB[3] = { boundsB.GetXVector(), boundsB.GetYVector(), boundsB.GetZVector() };
+    for (int i = 0; i < 3; ++i)
+    {
+        if (IsSeparatingAxis(axesA[i], distance, mA, mB) || IsSeparatingAxis(axesB[i], distance, mA, mB))
+        {
+            return false;
+        }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            if (IsSeparatingAxis(glm::cross(axesA[i], axesB[j]), distance, mA, mB))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
+// Conservative tests: the bounds are rejected only if they are completely outside one of the planes.
+// Some bounds near the corners of the frustum are accepted even if they are outside
+
 template<>
 bool Bounds::Intersects(const FrustumBounds& boundsA, const SphereBounds& boundsB)
 {
+    for (int i = 0; i < 6; ++i)
+    {
+        if (boundsA.GetDistance(i, boundsB.GetCenter()) < -boundsB.GetRadius())
+        {
+            return false;
+        }
+    }
     return true;
 }
 
 template<>
 bool Bounds::Intersects(const FrustumBounds& boundsA, const AabbBounds& boundsB)
 {
+    for (int i = 0; i < 6; ++i)
+    {
+        // Projected half size of the box on the plane normal
+        glm::vec3 normal(boundsA.GetPlanes()[i]);
+        float radius = glm::dot(glm::abs(normal), boundsB.GetSize());
+        if (boundsA.GetDistance(i, boundsB.GetCenter()) < -radius)
+        {
+            return false;
+        }
+    }
     return true;
 }
 
 template<>
 bool Bounds::Intersects(const FrustumBounds& boundsA, const BoxBounds& boundsB)
 {
+    glm::mat3 scaledMatrix = boundsB.GetScaledMatrix();
+    for (int i = 0; i < 6; ++i)
+    {
+        // Projected half size of the box on the plane normal
+        glm::vec3 normal(boundsA.GetPlanes()[i]);
+        float radius = std::abs(glm::dot(normal, scaledMatrix[0]))
+            + std::abs(glm::dot(normal, scaledMatrix[1]))
+            + std::abs(glm::dot(normal, scaledMatrix[2]));
+        if (boundsA.GetDistance(i, boundsB.GetCenter()) < -radius)
+        {
+            return false;
+        }
+    }
     return true;
 }
 
@@ -163,6 +248,8 @@ bool Bounds::Intersects(const Bounds& boundsA, const Bounds& boundsB)
         return Bounds::Intersects(static_cast<const AabbBounds&>(boundsA), boundsB);
     case Type::Box:
         return Bounds::Intersects(static_cast<const BoxBounds&>(boundsA), boundsB);
+    case Type::Frustum:
+        return Bounds::Intersects(static_cast<const FrustumBounds&>(boundsA), boundsB);
     default:
         assert(false);
         return false;
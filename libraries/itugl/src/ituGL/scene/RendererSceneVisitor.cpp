@@ -24,5 +24,10 @@ void RendererSceneVisitor::VisitLight(SceneLight& sceneLight)
 void RendererSceneVisitor::VisitModel(SceneModel& sceneModel)
 {
     assert(sceneModel.GetTransform());
-    m_renderer.AddModel(*sceneModel.GetModel(), sceneModel.GetTransform()->GetTransformMatrix());
+    glm::mat4 worldMatrix = sceneModel.GetTransform()->GetTransformMatrix();
+    m_renderer.AddModel(*sceneModel.GetModel(), worldMatrix);
+    if (std::shared_ptr<const OccluderMesh> occluder = sceneModel.GetOccluder())
+    {
+        m_renderer.AddOccluder(*occluder, worldMatrix);
+    }
 }
@@ -2,6 +2,7 @@
 
 #include <ituGL/scene/SceneNode.h>
 #include <ituGL/scene/SceneVisitor.h>
+#include <ituGL/utils/Profiler.h>
 #include <cassert>
 
 Scene::Scene()
@@ -32,6 +33,7 @@ bool Scene::AddSceneNode(std::shared_ptr<SceneNode> node)
     assert(m_nodes.find(node->GetName()) == m_nodes.end());
     m_nodes[node->GetName()] = node;
     node->SetOwnerScene(this);
+    m_bvh.AddSceneNode(*node);
     return true;
 }
 
@@ -49,6 +51,7 @@ bool Scene::RemoveSceneNode(const std::string& name)
         assert(it->second);
         assert(it->second->GetOwnerScene() == this);
         it->second->SetOwnerScene(nullptr);
+        m_bvh.RemoveSceneNode(*it->second);
         m_nodes.erase(it);
         return true;
     }
@@ -57,6 +60,7 @@ bool Scene::RemoveSceneNode(const std::string& name)
 
 void Scene::AcceptVisitor(SceneVisitor& visitor)
 {
+    ITUGL_PROFILE_SCOPE("Scene::AcceptVisitor");
     for (auto& pair : m_nodes)
     {
         pair.second->AcceptVisitor(visitor);
@@ -65,8 +69,34 @@ void Scene::AcceptVisitor(SceneVisitor& visitor)
 
 void Scene::AcceptVisitor(SceneVisitor& visitor) const
 {
+    ITUGL_PROFILE_SCOPE("Scene::AcceptVisitor");
     for (auto& pair : m_nodes)
     {
         pair.second->AcceptVisitor(visitor);
     }
 }
+
+void Scene::AcceptVisitor(SceneVisitor& visitor, const Bounds& bounds)
+{
+    ITUGL_PROFILE_SCOPE("Scene::AcceptVisitor");
+    UpdateSpatialIndex();
+    m_bvh.Query(bounds, [&](SceneNode& node) { node.AcceptVisitor(visitor); });
+}
+
+void Scene::AcceptVisitor(SceneVisitor& visitor, const Bounds& bounds) const
+{
+    ITUGL_PROFILE_SCOPE("Scene::AcceptVisitor");
+    m_bvh.Query(bounds, [&](const SceneNode& node) { node.AcceptVisitor(visitor); });
+}
+
+void Scene::UpdateSpatialIndex()
+{
+    ITUGL_PROFILE_SCOPE("Scene::UpdateSpatialIndex");
+    m_bvh.Refit();
+}
+
+void Scene::InvalidateSceneNodeBounds(const SceneNode& node)
+{
+    assert(m_bvh.ContainsSceneNode(node));
+    m_bvh.InvalidateSceneNode(node);
+}
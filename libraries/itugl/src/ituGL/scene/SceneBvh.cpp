@@ -0,0 +1,447 @@
+#include <ituGL/scene/SceneBvh.h>
+
+#include <ituGL/scene/SceneNode.h>
+#include <ituGL/scene/Transform.h>
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+#include <algorithm>
+#include <limits>
+
+SceneBvh::SceneBvh() : m_root(NullIndex), m_freeList(NullIndex), m_margin(0.1f)
+{
+}
+
+SceneBvh::~SceneBvh()
+{
+    for (auto& pair : m_leaves)
+    {
+        SetLeafTransform(*pair.first, pair.second, nullptr);
+    }
+}
+
+void SceneBvh::AddSceneNode(SceneNode& sceneNode)
+{
+    assert(!ContainsSceneNode(sceneNode));
+
+    NodeIndex leafIndex = AllocateNode();
+    Node& leaf = m_nodes[leafIndex];
+    leaf.sceneNode = &sceneNode;
+
+    // References to the elements of the map stay valid when it grows, so the functions can keep them
+    LeafInfo& info = m_leaves[&sceneNode];
+    info = LeafInfo{ leafIndex, nullptr, false };
+    SetLeafTransform(sceneNode, info, static_cast<const SceneNode&>(sceneNode).GetTransform());
+
+    // Force the insertion with empty bounds, so the tight bounds are never contained
+    leaf.min = glm::vec3(std::numeric_limits<float>::max());
+    leaf.max = glm::vec3(std::numeric_limits<float>::lowest());
+    UpdateLeafBounds(leafIndex, sceneNode.GetAabbBounds());
+}
+
+void SceneBvh::RemoveSceneNode(const SceneNode& sceneNode)
+{
+    auto it = m_leaves.find(&sceneNode);
+    assert(it != m_leaves.end());
+
+    SetLeafTransform(sceneNode, it->second, nullptr);
+    if (it->second.dirty)
+    {
+        std::erase(m_dirtyNodes, &sceneNode);
+    }
+
+    NodeIndex leafIndex = it->second.nodeIndex;
+    RemoveLeaf(leafIndex);
+    FreeNode(leafIndex);
+    m_leaves.erase(it);
+}
+
+bool SceneBvh::ContainsSceneNode(const SceneNode& sceneNode) const
+{
+    return m_leaves.find(&sceneNode) != m_leaves.end();
+}
+
+void SceneBvh::InvalidateSceneNode(const SceneNode& sceneNode)
+{
+    auto it = m_leaves.find(&sceneNode);
+    if (it != m_leaves.end())
+    {
+        MarkDirty(sceneNode, it->second);
+    }
+}
+
+unsigned int SceneBvh::Refit()
+{
+    unsigned int movedCount = 0;
+    for (const SceneNode* sceneNode : m_dirtyNodes)
+    {
+        LeafInfo& info = m_leaves.find(sceneNode)->second;
+        info.dirty = false;
+
+        // The node can have a new transform
+        std::shared_ptr<const Transform> transform = sceneNode->GetTransform();
+        if (transform != info.transform)
+        {
+            SetLeafTransform(*sceneNode, info, transform);
+        }
+
+        if (UpdateLeafBounds(info.nodeIndex, sceneNode->GetAabbBounds()))
+        {
+            ++movedCount;
+        }
+    }
+    m_dirtyNodes.clear();
+    return movedCount;
+}
+
+void SceneBvh::SetLeafTransform(const SceneNode& sceneNode, LeafInfo& info, std::shared_ptr<const Transform> transform)
+{
+    if (info.transform)
+    {
+        info.transform->RemoveChangedFunction(&sceneNode);
+    }
+    info.transform = transform;
+    if (info.transform)
+    {
+        info.transform->AddChangedFunction(&sceneNode, [this, &sceneNode, &info]() { MarkDirty(sceneNode, info); });
+    }
+}
+
+void SceneBvh::MarkDirty(const SceneNode& sceneNode, LeafInfo& info)
+{
+    if (!info.dirty)
+    {
+        info.dirty = true;
+        m_dirtyNodes.push_back(&sceneNode);
+    }
+}
+
+void SceneBvh::Query(const Bounds& bounds, const QueryFunction& function) const
+{
+    if (m_root == NullIndex)
+    {
+        return;
+    }
+
+    std::vector<NodeIndex> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if (!Bounds::Intersects(bounds, AabbBounds(0.5f * (node.min + node.max), 0.5f * (node.max - node.min))))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            // The enlarged bounds intersect, check the real ones before reporting
+            if (Bounds::Intersects(bounds, AabbBounds(0.5f * (node.tightMin + node.tightMax), 0.5f * (node.tightMax - node.tightMin))))
+            {
+                function(*node.sceneNode);
+            }
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void SceneBvh::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayQueryFunction& function) const
+{
+    if (m_root == NullIndex)
+    {
+        return;
+    }
+
+    // Division by 0 gives infinity, that is handled by the slab test
+    glm::vec3 inverseDirection = 1.0f / direction;
+
+    std::vector<NodeIndex> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        float distance;
+        if (!IntersectsRay(node.min, node.max, origin, inverseDirection, maxDistance, distance))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (IntersectsRay(node.tightMin, node.tightMax, origin, inverseDirection, maxDistance, distance))
+            {
+                function(*node.sceneNode, distance);
+            }
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+SceneNode* SceneBvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float& distance) const
+{
+    SceneNode* closestNode = nullptr;
+    if (m_root == NullIndex)
+    {
+        return closestNode;
+    }
+
+    glm::vec3 inverseDirection = 1.0f / direction;
+
+    // Same as QueryRay, but the max distance shrinks with every hit to skip the subtrees behind it
+    std::vector<NodeIndex> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        float nodeDistance;
+        if (!IntersectsRay(node.min, node.max, origin, inverseDirection, maxDistance, nodeDistance))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            if (IntersectsRay(node.tightMin, node.tightMax, origin, inverseDirection, maxDistance, nodeDistance))
+            {
+                closestNode = node.sceneNode;
+                maxDistance = nodeDistance;
+                distance = nodeDistance;
+            }
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+    return closestNode;
+}
+
+unsigned int SceneBvh::GetHeight() const
+{
+    return GetHeight(m_root);
+}
+
+unsigned int SceneBvh::GetHeight(NodeIndex index) const
+{
+    if (index == NullIndex)
+    {
+        return 0;
+    }
+    const Node& node = m_nodes[index];
+    return node.IsLeaf() ? 1 : 1 + std::max(GetHeight(node.left), GetHeight(node.right));
+}
+
+SceneBvh::NodeIndex SceneBvh::AllocateNode()
+{
+    NodeIndex index;
+    if (m_freeList != NullIndex)
+    {
+        // Free nodes are linked through the parent index
+        index = m_freeList;
+        m_freeList = m_nodes[index].parent;
+    }
+    else
+    {
+        index = static_cast<NodeIndex>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& node = m_nodes[index];
+    node.min = node.max = glm::vec3(0.0f);
+    node.tightMin = node.tightMax = glm::vec3(0.0f);
+    node.parent = node.left = node.right = NullIndex;
+    node.sceneNode = nullptr;
+    return index;
+}
+
+void SceneBvh::FreeNode(NodeIndex index)
+{
+    Node& node = m_nodes[index];
+    node.parent = m_freeList;
+    node.sceneNode = nullptr;
+    m_freeList = index;
+}
+
+bool SceneBvh::UpdateLeafBounds(NodeIndex leafIndex, const AabbBounds& bounds)
+{
+    Node& leaf = m_nodes[leafIndex];
+    leaf.tightMin = bounds.GetMin();
+    leaf.tightMax = bounds.GetMax();
+
+    // If the enlarged bounds still contain the node, the tree stays the same
+    if (glm::all(glm::greaterThanEqual(leaf.tightMin, leaf.min)) && glm::all(glm::lessThanEqual(leaf.tightMax, leaf.max)))
+    {
+        return false;
+    }
+
+    if (leaf.parent != NullIndex || m_root == leafIndex)
+    {
+        RemoveLeaf(leafIndex);
+    }
+
+    glm::vec3 margin = m_margin * glm::max(leaf.tightMax - leaf.tightMin, glm::vec3(1.0f));
+    leaf.min = leaf.tightMin - margin;
+    leaf.max = leaf.tightMax + margin;
+    InsertLeaf(leafIndex);
+    return true;
+}
+
+void SceneBvh::InsertLeaf(NodeIndex leafIndex)
+{
+    if (m_root == NullIndex)
+    {
+        m_root = leafIndex;
+        m_nodes[leafIndex].parent = NullIndex;
+        return;
+    }
+
+    const glm::vec3 leafMin = m_nodes[leafIndex].min;
+    const glm::vec3 leafMax = m_nodes[leafIndex].max;
+
+    // Find the best sibling going down the tree with the surface area heuristic
+    NodeIndex index = m_root;
+    while (!m_nodes[index].IsLeaf())
+    {
+        const Node& node = m_nodes[index];
+
+        float area = GetSurfaceArea(node.min, node.max);
+        float combinedArea = GetSurfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+        // Cost of creating a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        NodeIndex children[2] = { node.left, node.right };
+        for (int i = 0; i < 2; ++i)
+        {
+            const Node& child = m_nodes[children[i]];
+            float childArea = GetSurfaceArea(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+            if (!child.IsLeaf())
+            {
+                childArea -= GetSurfaceArea(child.min, child.max);
+            }
+            childCosts[i] = childArea + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+        {
+            break;
+        }
+
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    // Create a new parent for the sibling and the leaf. AllocateNode can move the nodes, so no references are kept
+    NodeIndex sibling = index;
+    NodeIndex oldParent = m_nodes[sibling].parent;
+    NodeIndex newParent = AllocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].left = sibling;
+    m_nodes[newParent].right = leafIndex;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leafIndex].parent = newParent;
+
+    if (oldParent == NullIndex)
+    {
+        m_root = newParent;
+    }
+    else if (m_nodes[oldParent].left == sibling)
+    {
+        m_nodes[oldParent].left = newParent;
+    }
+    else
+    {
+        m_nodes[oldParent].right = newParent;
+    }
+
+    RefitAncestors(newParent);
+}
+
+void SceneBvh::RemoveLeaf(NodeIndex leafIndex)
+{
+    if (leafIndex == m_root)
+    {
+        m_root = NullIndex;
+        return;
+    }
+
+    NodeIndex parent = m_nodes[leafIndex].parent;
+    NodeIndex grandParent = m_nodes[parent].parent;
+    NodeIndex sibling = m_nodes[parent].left == leafIndex ? m_nodes[parent].right : m_nodes[parent].left;
+
+    // The sibling takes the place of the parent
+    if (grandParent == NullIndex)
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = NullIndex;
+    }
+    else
+    {
+        if (m_nodes[grandParent].left == parent)
+        {
+            m_nodes[grandParent].left = sibling;
+        }
+        else
+        {
+            m_nodes[grandParent].right = sibling;
+        }
+        m_nodes[sibling].parent = grandParent;
+        RefitAncestors(grandParent);
+    }
+
+    FreeNode(parent);
+    m_nodes[leafIndex].parent = NullIndex;
+}
+
+void SceneBvh::RefitAncestors(NodeIndex index)
+{
+    while (index != NullIndex)
+    {
+        Node& node = m_nodes[index];
+        const Node& left = m_nodes[node.left];
+        const Node& right = m_nodes[node.right];
+        node.min = glm::min(left.min, right.min);
+        node.max = glm::max(left.max, right.max);
+        index = node.parent;
+    }
+}
+
+float SceneBvh::GetSurfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+    glm::vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool SceneBvh::IntersectsRay(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, float& distance)
+{
+    // Slab test: intersect the ray with the 3 pairs of planes and keep the overlapping interval
+    glm::vec3 t0 = (min - origin) * inverseDirection;
+    glm::vec3 t1 = (max - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+
+    float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+    distance = entry;
+    return entry <= exit;
+}
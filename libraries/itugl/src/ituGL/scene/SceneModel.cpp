@@ -22,6 +22,17 @@ std::shared_ptr<Model> SceneModel::GetModel() const
 void SceneModel::SetModel(std::shared_ptr<Model> model)
 {
     m_model = model;
+    InvalidateBounds();
+}
+
+std::shared_ptr<const OccluderMesh> SceneModel::GetOccluder() const
+{
+    return m_occluder;
+}
+
+void SceneModel::SetOccluder(std::shared_ptr<const OccluderMesh> occluder)
+{
+    m_occluder = occluder;
 }
 
 /*glm::mat4 SceneModel::GetWorldMatrix() const
@@ -57,7 +68,13 @@ BoxBounds SceneModel::GetBoxBounds() const
 {
     assert(m_transform);
     assert(m_model);
-    return BoxBounds(m_transform->GetTranslation(), m_transform->GetRotationMatrix(), m_transform->GetScale() /* * m_model->GetSize()*/);
+    const Mesh& mesh = m_model->GetMesh();
+    if (!mesh.HasBounds())
+    {
+        // Without mesh bounds, fall back to a unit box around the transform
+        return BoxBounds(m_transform->GetTranslation(), m_transform->GetRotationMatrix(), m_transform->GetScale());
+    }
+    return BoxBounds(mesh.GetBounds(), m_transform->GetTransformMatrix());
 }
 
 void SceneModel::AcceptVisitor(SceneVisitor& visitor)
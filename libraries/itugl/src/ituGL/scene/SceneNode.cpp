@@ -49,6 +49,7 @@ std::shared_ptr<const Transform> SceneNode::GetTransform() const
 void SceneNode::SetTransform(std::shared_ptr<Transform> transform)
 {
     m_transform = transform;
+    InvalidateBounds();
 }
 
 Scene* SceneNode::GetOwnerScene() const
@@ -61,6 +62,14 @@ void SceneNode::SetOwnerScene(Scene* scene)
     m_scene = scene;
 }
 
+void SceneNode::InvalidateBounds()
+{
+    if (m_scene)
+    {
+        m_scene->InvalidateSceneNodeBounds(*this);
+    }
+}
+
 SphereBounds SceneNode::GetSphereBounds() const
 {
     return SphereBounds(glm::vec3(m_transform->GetTranslation()), 0.0f); // use world translation?
@@ -1,9 +1,35 @@
 #include <ituGL/scene/Transform.h>
 
 #include <glm/ext/matrix_transform.hpp>
+#include <algorithm>
+#include <cassert>
 
-Transform::Transform() : m_translation(0, 0, 0), m_rotation(0, 0, 0), m_scale(1, 1, 1), m_matrix(1.0f), m_dirty(false)
+uint64_t Transform::s_versionCounter = 0;
+
+Transform::Transform() : m_translation(0, 0, 0), m_rotation(0, 0, 0), m_scale(1, 1, 1), m_matrix(1.0f), m_dirty(false), m_version(0)
+{
+}
+
+Transform::~Transform()
+{
+    if (m_parent)
+    {
+        std::erase(m_parent->m_children, this);
+    }
+}
+
+void Transform::SetParent(std::shared_ptr<Transform> parent)
 {
+    if (m_parent)
+    {
+        std::erase(m_parent->m_children, this);
+    }
+    m_parent = parent;
+    if (m_parent)
+    {
+        m_parent->m_children.push_back(this);
+    }
+    SetDirty();
 }
 
 glm::mat4 Transform::GetTranslationMatrix() const
@@ -43,3 +69,39 @@ bool Transform::IsDirty() const
 {
     return m_dirty || (m_parent && m_parent->IsDirty());
 }
+
+uint64_t Transform::GetVersion() const
+{
+    return m_parent ? std::max(m_version, m_parent->GetVersion()) : m_version;
+}
+
+void Transform::AddChangedFunction(const void* key, ChangedFunction function) const
+{
+    assert(key);
+    m_changedFunctions.emplace_back(key, std::move(function));
+}
+
+void Transform::RemoveChangedFunction(const void* key) const
+{
+    std::erase_if(m_changedFunctions, [key](const auto& pair) { return pair.first == key; });
+}
+
+void Transform::SetDirty()
+{
+    m_dirty = true;
+    m_version = ++s_versionCounter;
+    NotifyChanged();
+}
+
+void Transform::NotifyChanged() const
+{
+    for (const auto& pair : m_changedFunctions)
+    {
+        pair.second();
+    }
+    // The children move with the parent
+    for (const Transform* child : m_children)
+    {
+        child->NotifyChanged();
+    }
+}
@@ -2,13 +2,25 @@
 
 #include <ituGL/shader/Shader.h>
 #include <ituGL/texture/TextureObject.h>
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
+unsigned int ShaderProgram::s_idCounter = 0;
+
 #ifndef NDEBUG
 ShaderProgram::Handle ShaderProgram::s_usedHandle = ShaderProgram::NullHandle;
 #endif
 
-ShaderProgram::ShaderProgram() : Object(NullHandle)
+// Count a glUniform call in the device stats
+static void CountUniformUpload()
+{
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        device->AddUniformUploadStats();
+    }
+}
+
+ShaderProgram::ShaderProgram() : Object(NullHandle), m_id(s_idCounter++)
 {
     Handle& handle = GetHandle();
     handle = glCreateProgram();
@@ -19,12 +31,17 @@ ShaderProgram::~ShaderProgram()
     if (IsValid())
     {
         Handle& handle = GetHandle();
+        if (DeviceGL* device = DeviceGL::GetInstancePointer())
+        {
+            device->InvalidateShaderProgram(handle);
+        }
         glDeleteProgram(handle);
         handle = NullHandle;
     }
 }
 
-ShaderProgram::ShaderProgram(ShaderProgram&& shaderProgram) noexcept : Object(std::move(shaderProgram))
+// The id belongs to the C++ object, so the new object gets its own
+ShaderProgram::ShaderProgram(ShaderProgram&& shaderProgram) noexcept : Object(std::move(shaderProgram)), m_id(s_idCounter++)
 {
 }
 
@@ -124,7 +141,7 @@ void ShaderProgram::Use() const
     assert(IsValid());
     assert(IsLinked());
     Handle handle = GetHandle();
-    glUseProgram(handle);
+    DeviceGL::GetInstance().UseShaderProgram(handle);
 #ifndef NDEBUG
     s_usedHandle = handle;
 #endif
@@ -146,6 +163,22 @@ ShaderProgram::Location ShaderProgram::GetUniformLocation(const char* name) cons
     return glGetUniformLocation(GetHandle(), name);
 }
 
+// Find a uniform block index by name
+GLuint ShaderProgram::GetUniformBlockIndex(const char* name) const
+{
+    assert(IsValid());
+    assert(IsLinked());
+    return glGetUniformBlockIndex(GetHandle(), name);
+}
+
+// Set the binding point where the uniform block reads its uniform buffer from
+void ShaderProgram::SetUniformBlockBinding(GLuint blockIndex, GLuint bindingPoint) const
+{
+    assert(IsValid());
+    assert(blockIndex != GL_INVALID_INDEX);
+    glUniformBlockBinding(GetHandle(), blockIndex, bindingPoint);
+}
+
 // Get how many uniforms exist in this shader program
 unsigned int ShaderProgram::GetUniformCount() const
 {
@@ -198,6 +231,7 @@ void ShaderProgram::SetUniforms<GLint, 1>(Location location, const GLint* values
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform1iv(location, count, values);
 }
 
@@ -206,6 +240,7 @@ void ShaderProgram::SetUniforms<GLint, 2>(Location location, const GLint* values
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform2iv(location, count, values);
 }
 
@@ -214,6 +249,7 @@ void ShaderProgram::SetUniforms<GLint, 3>(Location location, const GLint* values
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform3iv(location, count, values);
 }
 
@@ -222,6 +258,7 @@ void ShaderProgram::SetUniforms<GLint, 4>(Location location, const GLint* values
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform4iv(location, count, values);
 }
 
@@ -230,6 +267,7 @@ void ShaderProgram::SetUniforms<GLuint, 1>(Location location, const GLuint* valu
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform1uiv(location, count, values);
 }
 
@@ -238,6 +276,7 @@ void ShaderProgram::SetUniforms<GLuint, 2>(Location location, const GLuint* valu
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform2uiv(location, count, values);
 }
 
@@ -246,6 +285,7 @@ void ShaderProgram::SetUniforms<GLuint, 3>(Location location, const GLuint* valu
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform3uiv(location, count, values);
 }
 
@@ -254,6 +294,7 @@ void ShaderProgram::SetUniforms<GLuint, 4>(Location location, const GLuint* valu
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform4uiv(location, count, values);
 }
 
@@ -262,6 +303,7 @@ void ShaderProgram::SetUniforms<GLfloat, 1>(Location location, const GLfloat* va
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform1fv(location, count, values);
 }
 
@@ -270,6 +312,7 @@ void ShaderProgram::SetUniforms<GLfloat, 2>(Location location, const GLfloat* va
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform2fv(location, count, values);
 }
 
@@ -278,6 +321,7 @@ void ShaderProgram::SetUniforms<GLfloat, 3>(Location location, const GLfloat* va
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform3fv(location, count, values);
 }
 
@@ -286,6 +330,7 @@ void ShaderProgram::SetUniforms<GLfloat, 4>(Location location, const GLfloat* va
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform4fv(location, count, values);
 }
 
@@ -294,6 +339,7 @@ void ShaderProgram::SetUniforms<GLdouble, 1>(Location location, const GLdouble*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform1dv(location, count, values);
 }
 
@@ -302,6 +348,7 @@ void ShaderProgram::SetUniforms<GLdouble, 2>(Location location, const GLdouble*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform2dv(location, count, values);
 }
 
@@ -310,6 +357,7 @@ void ShaderProgram::SetUniforms<GLdouble, 3>(Location location, const GLdouble*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform3dv(location, count, values);
 }
 
@@ -318,6 +366,7 @@ void ShaderProgram::SetUniforms<GLdouble, 4>(Location location, const GLdouble*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniform4dv(location, count, values);
 }
 
@@ -326,6 +375,7 @@ void ShaderProgram::SetUniforms<GLfloat, 2, 2>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix2fv(location, count, false, values);
 }
 
@@ -334,6 +384,7 @@ void ShaderProgram::SetUniforms<GLfloat, 2, 3>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix2x3fv(location, count, false, values);
 }
 
@@ -342,6 +393,7 @@ void ShaderProgram::SetUniforms<GLfloat, 2, 4>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix2x4fv(location, count, false, values);
 }
 
@@ -350,6 +402,7 @@ void ShaderProgram::SetUniforms<GLfloat, 3, 2>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix3x2fv(location, count, false, values);
 }
 
@@ -358,6 +411,7 @@ void ShaderProgram::SetUniforms<GLfloat, 3, 3>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix3fv(location, count, false, values);
 }
 
@@ -366,6 +420,7 @@ void ShaderProgram::SetUniforms<GLfloat, 3, 4>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix3x4fv(location, count, false, values);
 }
 
@@ -374,6 +429,7 @@ void ShaderProgram::SetUniforms<GLfloat, 4, 2>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix4x2fv(location, count, false, values);
 }
 
@@ -382,6 +438,7 @@ void ShaderProgram::SetUniforms<GLfloat, 4, 3>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix4x3fv(location, count, false, values);
 }
 
@@ -390,6 +447,7 @@ void ShaderProgram::SetUniforms<GLfloat, 4, 4>(Location location, const GLfloat*
 {
     assert(IsValid());
     assert(IsUsed());
+    CountUniformUpload();
     glUniformMatrix4fv(location, count, false, values);
 }
 
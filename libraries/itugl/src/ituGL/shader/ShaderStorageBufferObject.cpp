@@ -0,0 +1,12 @@
+#include <ituGL/shader/ShaderStorageBufferObject.h>
+
+ShaderStorageBufferObject::ShaderStorageBufferObject()
+{
+    // Nothing to do here, it is done by the base class
+}
+
+// Bind to the indexed target. It also binds to the generic target, like glBindBuffer
+void ShaderStorageBufferObject::BindBase(GLuint bindingPoint) const
+{
+    BufferObject::BindBase(GetTarget(), bindingPoint);
+}
@@ -86,8 +86,10 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
             continue;
 
         // Get the uniform location
+        // Uniforms inside blocks don't have a location, their values come from uniform buffers
         ShaderProgram::Location location = GetUniformLocation(uniformName);
-        assert(location >= 0);
+        if (location < 0)
+            continue;
 
         Data::Type type;
         UniformDimension dimension;
@@ -233,9 +235,11 @@ bool ShaderUniformCollection::IsTextureUniform(GLenum glType, TextureObject::Tar
         target = TextureObject::Target::Texture1DArray;
         break;
     case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_SHADOW:
         target = TextureObject::Target::Texture2D;
         break;
     case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
         target = TextureObject::Target::Texture2DArray;
         break;
     case GL_SAMPLER_2D_MULTISAMPLE:
@@ -248,6 +252,7 @@ bool ShaderUniformCollection::IsTextureUniform(GLenum glType, TextureObject::Tar
         target = TextureObject::Target::Texture3D;
         break;
     case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_CUBE_SHADOW:
         target = TextureObject::Target::TextureCubemap;
         break;
     case GL_SAMPLER_CUBE_MAP_ARRAY:
@@ -0,0 +1,12 @@
+#include <ituGL/shader/UniformBufferObject.h>
+
+UniformBufferObject::UniformBufferObject()
+{
+    // Nothing to do here, it is done by the base class
+}
+
+// Bind to the indexed target. It also binds to the generic target, like glBindBuffer
+void UniformBufferObject::BindBase(GLuint bindingPoint) const
+{
+    glBindBufferBase(GetTarget(), bindingPoint, GetHandle());
+}
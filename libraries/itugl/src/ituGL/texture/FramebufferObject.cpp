@@ -1,9 +1,19 @@
 #include <ituGL/texture/FramebufferObject.h>
 
 #include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
-std::shared_ptr<const FramebufferObject> FramebufferObject::s_defaultFramebuffer(std::make_shared<FramebufferObject>(FramebufferObject(Object::NullHandle)));
+std::shared_ptr<const FramebufferObject> FramebufferObject::s_defaultFramebuffer(GetWindowFramebuffer());
+
+// Count the bind in the device stats
+static void CountFramebufferBind()
+{
+    if (DeviceGL* device = DeviceGL::GetInstancePointer())
+    {
+        device->AddFramebufferBindStats();
+    }
+}
 
 FramebufferObject::FramebufferObject() : Object(NullHandle)
 {
@@ -34,6 +44,7 @@ void FramebufferObject::Bind() const
 void FramebufferObject::Bind(Target target) const
 {
     Handle handle = GetHandle();
+    CountFramebufferBind();
     glBindFramebuffer(static_cast<GLenum>(target), handle);
 }
 
@@ -44,7 +55,8 @@ void FramebufferObject::Unbind()
 
 void FramebufferObject::Unbind(Target target)
 {
-    Handle handle = NullHandle;
+    Handle handle = s_defaultFramebuffer->GetHandle();
+    CountFramebufferBind();
     glBindFramebuffer(static_cast<GLenum>(target), handle);
 }
 
@@ -53,6 +65,17 @@ std::shared_ptr<const FramebufferObject> FramebufferObject::GetDefault()
     return FramebufferObject::s_defaultFramebuffer;
 }
 
+void FramebufferObject::SetDefault(std::shared_ptr<const FramebufferObject> framebuffer)
+{
+    s_defaultFramebuffer = framebuffer ? framebuffer : GetWindowFramebuffer();
+}
+
+std::shared_ptr<const FramebufferObject> FramebufferObject::GetWindowFramebuffer()
+{
+    static std::shared_ptr<const FramebufferObject> windowFramebuffer(std::make_shared<FramebufferObject>(FramebufferObject(Object::NullHandle)));
+    return windowFramebuffer;
+}
+
 void FramebufferObject::SetTexture(Target target, Attachment attachment, const Texture2DObject& texture, int level)
 {
     glFramebufferTexture2D(static_cast<GLenum>(target), static_cast<GLenum>(attachment), texture.GetTarget(), texture.GetHandle(), level);
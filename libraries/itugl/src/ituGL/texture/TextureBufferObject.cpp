@@ -0,0 +1,13 @@
+#include <ituGL/texture/TextureBufferObject.h>
+
+#include <cassert>
+
+TextureBufferObject::TextureBufferObject()
+{
+}
+
+void TextureBufferObject::SetBuffer(InternalFormat internalFormat, const TextureBufferDataObject& buffer)
+{
+    assert(IsBound());
+    glTexBuffer(GetTarget(), internalFormat, buffer.GetHandle());
+}
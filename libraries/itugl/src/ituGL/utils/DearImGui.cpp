@@ -50,9 +50,21 @@ DearImGui::Window DearImGui::UseWindow(const char* name)
     return name;
 }
 
-DearImGui::Window::Window(const char* name) : m_open(false)
+DearImGui::Window DearImGui::UseOverlay(const char* name)
 {
-    m_open = ImGui::Begin(name);
+    const float padding = 10.0f;
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImVec2 position(viewport->WorkPos.x + viewport->WorkSize.x - padding, viewport->WorkPos.y + padding);
+    ImGui::SetNextWindowPos(position, ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowBgAlpha(0.35f);
+
+    return Window(name, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings
+        | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoMove);
+}
+
+DearImGui::Window::Window(const char* name, int flags) : m_open(false)
+{
+    m_open = ImGui::Begin(name, nullptr, flags);
 }
 
 DearImGui::Window::~Window()
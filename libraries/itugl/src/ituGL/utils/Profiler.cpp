@@ -0,0 +1,280 @@
+#include <ituGL/utils/Profiler.h>
+
+#include <ituGL/utils/DearImGui.h>
+#include <imgui.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+
+// Time origin of the profiler. Static, so zones recorded before the first GetInstance share it
+static const std::chrono::steady_clock::time_point s_startTime = std::chrono::steady_clock::now();
+
+// Buffer of the calling thread, found once and kept for the lifetime of the thread
+static thread_local void* t_threadBuffer = nullptr;
+
+Profiler& Profiler::GetInstance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_enabled(true)
+    , m_frameStartTime(0), m_lastFrameStartTime(0)
+{
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    buffer.name = name;
+}
+
+void Profiler::BeginFrame()
+{
+    m_lastFrameStartTime = m_frameStartTime;
+    m_frameStartTime = GetTime();
+}
+
+int64_t Profiler::GetTime() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+int64_t Profiler::BeginZone(unsigned int& depth)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    depth = buffer.depth++;
+    return GetTime();
+}
+
+void Profiler::EndZone(const char* name, int64_t startTime, unsigned int depth)
+{
+    int64_t endTime = GetTime();
+
+    ThreadBuffer& buffer = GetThreadBuffer();
+    assert(buffer.depth == depth + 1);
+    buffer.depth = depth;
+
+    // Only this thread writes the buffer. The count is published after the zone, so readers never see it half written
+    // The fence keeps the last published count before the new zone, so a reader that copies it sees the count that overwrites it
+    uint64_t zoneCount = buffer.zoneCount.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    buffer.zones[zoneCount % ZonesPerThread] = Zone{ name, startTime, endTime, depth };
+    buffer.zoneCount.store(zoneCount + 1, std::memory_order_release);
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+{
+    if (!t_threadBuffer)
+    {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->zones.reset(new Zone[ZonesPerThread]);
+
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        buffer->threadIndex = static_cast<unsigned int>(m_threadBuffers.size());
+        buffer->name = "Thread " + std::to_string(buffer->threadIndex);
+        t_threadBuffer = buffer.get();
+        m_threadBuffers.push_back(std::move(buffer));
+    }
+    return *static_cast<ThreadBuffer*>(t_threadBuffer);
+}
+
+void Profiler::CollectZones(const ThreadBuffer& buffer, int64_t beginTime, int64_t endTime, std::vector<Zone>& zones) const
+{
+    uint64_t zoneCount = buffer.zoneCount.load(std::memory_order_acquire);
+    uint64_t firstZone = zoneCount > ZonesPerThread ? zoneCount - ZonesPerThread : 0;
+
+    for (uint64_t i = firstZone; i < zoneCount; ++i)
+    {
+        Zone zone = buffer.zones[i % ZonesPerThread];
+
+        // The owner thread keeps writing while we copy. Zone i is overwritten when the thread writes zone i + ZonesPerThread
+        // The fence keeps the copy before the count is read again, an acquire load alone would let the copy move after it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (buffer.zoneCount.load(std::memory_order_relaxed) >= i + ZonesPerThread)
+        {
+            continue;
+        }
+
+        if (zone.endTime >= beginTime && zone.startTime <= endTime)
+        {
+            zones.push_back(zone);
+        }
+    }
+}
+
+bool Profiler::WriteChromeTrace(const char* path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    // Zone and thread names come from the code, but escape them anyway to always write valid JSON
+    auto writeString = [&file](const std::string& string)
+    {
+        file << '"';
+        for (char c : string)
+        {
+            if (c == '"' || c == '\\')
+            {
+                file << '\\';
+            }
+            file << c;
+        }
+        file << '"';
+    };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    std::vector<Zone> zones;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : m_threadBuffers)
+    {
+        // Metadata event with the name of the thread
+        file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadIndex << ",\"args\":{\"name\":";
+        writeString(buffer->name);
+        file << "}}";
+        first = false;
+
+        // Complete events, with timestamps in microseconds
+        zones.clear();
+        CollectZones(*buffer, 0, INT64_MAX, zones);
+        for (const Zone& zone : zones)
+        {
+            file << ",\n{\"name\":";
+            writeString(zone.name);
+            file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadIndex
+                << ",\"ts\":" << zone.startTime * 1e-3
+                << ",\"dur\":" << (zone.endTime - zone.startTime) * 1e-3
+                << "}";
+        }
+    }
+
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+void Profiler::DrawGUI(DearImGui& imGui)
+{
+    if (auto window = imGui.UseWindow("Profiler"))
+    {
+        bool enabled = IsEnabled();
+        if (ImGui::Checkbox("Enabled", &enabled))
+        {
+            SetEnabled(enabled);
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Save trace"))
+        {
+            const char* path = "trace.json";
+            m_exportMessage = WriteChromeTrace(path) ? std::string("Saved ") + path : std::string("Failed to write ") + path;
+        }
+        if (!m_exportMessage.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextUnformatted(m_exportMessage.c_str());
+        }
+
+        // Last complete frame
+        int64_t frameStart = m_lastFrameStartTime;
+        int64_t frameEnd = m_frameStartTime;
+        if (frameEnd <= frameStart)
+        {
+            return;
+        }
+        double frameDuration = static_cast<double>(frameEnd - frameStart);
+        ImGui::Text("Frame: %.3f ms", frameDuration * 1e-6);
+
+        float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+        // Copy the thread list, so the mutex is not held while drawing
+        std::vector<std::pair<std::string, const ThreadBuffer*>> threads;
+        {
+            std::lock_guard<std::mutex> lock(m_threadsMutex);
+            for (const std::unique_ptr<ThreadBuffer>& buffer : m_threadBuffers)
+            {
+                threads.emplace_back(buffer->name, buffer.get());
+            }
+        }
+
+        std::vector<Zone> zones;
+        for (const auto& [threadName, buffer] : threads)
+        {
+            zones.clear();
+            CollectZones(*buffer, frameStart, frameEnd, zones);
+            if (zones.empty())
+            {
+                continue;
+            }
+
+            ImGui::TextUnformatted(threadName.c_str());
+
+            unsigned int maxDepth = 0;
+            for (const Zone& zone : zones)
+            {
+                maxDepth = std::max(maxDepth, zone.depth);
+            }
+
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+            ImVec2 size(width, (maxDepth + 1) * rowHeight);
+            ImGui::InvisibleButton(threadName.c_str(), size);
+            bool hovered = ImGui::IsItemHovered();
+            ImVec2 mousePosition = ImGui::GetIO().MousePos;
+
+            for (const Zone& zone : zones)
+            {
+                // Clamp to the frame, zones can start in the previous one
+                float x0 = origin.x + static_cast<float>(std::max(zone.startTime - frameStart, int64_t(0)) / frameDuration) * width;
+                float x1 = origin.x + static_cast<float>(std::min(zone.endTime - frameStart, frameEnd - frameStart) / frameDuration) * width;
+                x1 = std::max(x1, x0 + 1.0f);
+                float y0 = origin.y + zone.depth * rowHeight;
+                float y1 = y0 + rowHeight - 1.0f;
+
+                // Same color for the same name, from the address of the literal
+                size_t hash = std::hash<const void*>()(zone.name);
+                ImU32 color = IM_COL32(96 + hash % 128, 96 + (hash >> 8) % 128, 96 + (hash >> 16) % 128, 255);
+                drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), color);
+
+                ImVec2 textSize = ImGui::CalcTextSize(zone.name);
+                if (textSize.x + 4.0f < x1 - x0)
+                {
+                    drawList->AddText(ImVec2(x0 + 2.0f, y0), IM_COL32_BLACK, zone.name);
+                }
+
+                if (hovered && mousePosition.x >= x0 && mousePosition.x < x1 && mousePosition.y >= y0 && mousePosition.y < y1)
+                {
+                    ImGui::SetTooltip("%s: %.3f ms", zone.name, (zone.endTime - zone.startTime) * 1e-6);
+                }
+            }
+        }
+    }
+}
+
+ProfileScope::ProfileScope(const char* name) : m_name(name), m_startTime(-1), m_depth(0)
+{
+    Profiler& profiler = Profiler::GetInstance();
+    if (profiler.IsEnabled())
+    {
+        m_startTime = profiler.BeginZone(m_depth);
+    }
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (m_startTime >= 0)
+    {
+        Profiler::GetInstance().EndZone(m_name, m_startTime, m_depth);
+    }
+}
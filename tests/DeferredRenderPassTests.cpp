@@ -0,0 +1,44 @@
+#include "TestCheck.h"
+
+#include <ituGL/renderer/DeferredRenderPass.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+// The unit cone has the apex at the origin and the base of radius 1 at z = -1
+static bool IsInsideCone(const glm::mat4& worldMatrix, const glm::vec3& point)
+{
+    glm::vec3 localPoint = glm::vec3(glm::inverse(worldMatrix) * glm::vec4(point, 1.0f));
+    float epsilon = 1e-4f;
+    return localPoint.z <= epsilon && localPoint.z >= -1.0f - epsilon && glm::length(glm::vec2(localPoint)) <= -localPoint.z + epsilon;
+}
+
+static void TestSpotLightCone()
+{
+    glm::vec3 position(1.0f, 2.0f, 3.0f);
+    float range = 10.0f;
+    float angle = glm::quarter_pi<float>() * 0.5f;
+
+    // Directions along and across the up vector used to build the rotation
+    const glm::vec3 directions[] = { glm::normalize(glm::vec3(1.0f, -1.0f, 0.5f)), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) };
+    for (const glm::vec3& direction : directions)
+    {
+        glm::mat4 worldMatrix = DeferredRenderPass::GetSpotLightConeMatrix(position, direction, range, angle);
+
+        // The shaders light the points at -direction from the light
+        Check(IsInsideCone(worldMatrix, position - direction * range * 0.5f), "Cone covers the lit side of the spot light");
+        Check(IsInsideCone(worldMatrix, position - direction * range * 0.99f), "Cone reaches the range of the spot light");
+        Check(!IsInsideCone(worldMatrix, position + direction * range * 0.5f), "Cone doesn't cover the unlit side of the spot light");
+
+        // A point on the outer angle, just inside the range
+        glm::vec3 side = glm::normalize(glm::cross(direction, std::abs(direction.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0)));
+        glm::vec3 edgeDirection = -direction * std::cos(angle * 0.99f) + side * std::sin(angle * 0.99f);
+        Check(IsInsideCone(worldMatrix, position + edgeDirection * range * 0.9f), "Cone covers the outer angle of the spot light");
+    }
+}
+
+int main()
+{
+    TestSpotLightCone();
+
+    return ReportChecks();
+}
@@ -0,0 +1,188 @@
+#include "TestCheck.h"
+
+#include <ituGL/geometry/MeshSimplifier.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+struct TestMesh
+{
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+};
+
+// Cube with each face split in a grid, pushed out to a sphere. Vertices are shared between the faces, so it is closed
+static TestMesh CreateCubeSphere(int segments)
+{
+    TestMesh mesh;
+    std::map<std::tuple<int, int, int>, unsigned int> vertexIndices;
+    auto getVertex = [&](int x, int y, int z)
+    {
+        auto [it, inserted] = vertexIndices.try_emplace(std::make_tuple(x, y, z), static_cast<unsigned int>(mesh.positions.size()));
+        if (inserted)
+        {
+            mesh.positions.push_back(glm::normalize(glm::vec3(x, y, z) / static_cast<float>(segments) * 2.0f - 1.0f));
+        }
+        return it->second;
+    };
+
+    // Each face is the grid of two axes, at 0 or segments in the third one
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            for (int v = 0; v < segments; ++v)
+            {
+                for (int u = 0; u < segments; ++u)
+                {
+                    unsigned int corners[4];
+                    for (int corner = 0; corner < 4; ++corner)
+                    {
+                        int coordinates[3];
+                        coordinates[axis] = side * segments;
+                        coordinates[(axis + 1) % 3] = u + (corner == 1 || corner == 2 ? 1 : 0);
+                        coordinates[(axis + 2) % 3] = v + (corner >= 2 ? 1 : 0);
+                        corners[corner] = getVertex(coordinates[0], coordinates[1], coordinates[2]);
+                    }
+                    // The winding doesn't matter for the simplifier, only that it is consistent in each face
+                    mesh.indices.insert(mesh.indices.end(), { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] });
+                }
+            }
+        }
+    }
+    return mesh;
+}
+
+// Grid of vertices on the XZ plane, with some height so that the inner collapses are not free
+// With a seam, the vertices of the middle column are duplicated, like a UV seam, and the triangles on the right use the copies
+static TestMesh CreateGrid(int segments, bool seam)
+{
+    TestMesh mesh;
+    for (int z = 0; z <= segments; ++z)
+    {
+        for (int x = 0; x <= segments; ++x)
+        {
+            mesh.positions.push_back(glm::vec3(x, 0.1f * std::sin(x * 0.7f) * std::cos(z * 0.9f), z));
+        }
+    }
+
+    unsigned int rowSize = segments + 1;
+    int seamColumn = segments / 2;
+    std::vector<unsigned int> seamCopies;
+    if (seam)
+    {
+        for (int z = 0; z <= segments; ++z)
+        {
+            seamCopies.push_back(static_cast<unsigned int>(mesh.positions.size()));
+            mesh.positions.push_back(mesh.positions[z * rowSize + seamColumn]);
+        }
+    }
+
+    auto getVertex = [&](int x, int z, bool right)
+    {
+        return seam && right && x == seamColumn ? seamCopies[z] : z * rowSize + x;
+    };
+    for (int z = 0; z < segments; ++z)
+    {
+        for (int x = 0; x < segments; ++x)
+        {
+            bool right = x >= seamColumn;
+            unsigned int v00 = getVertex(x, z, right);
+            unsigned int v10 = getVertex(x + 1, z, right);
+            unsigned int v01 = getVertex(x, z + 1, right);
+            unsigned int v11 = getVertex(x + 1, z + 1, right);
+            mesh.indices.insert(mesh.indices.end(), { v00, v01, v11, v00, v11, v10 });
+        }
+    }
+    return mesh;
+}
+
+static bool AllIndicesValid(std::span<const unsigned int> indices, size_t vertexCount)
+{
+    return std::all_of(indices.begin(), indices.end(), [vertexCount](unsigned int index) { return index < vertexCount; });
+}
+
+// Every edge of a closed mesh is shared by exactly two triangles
+static bool IsClosed(std::span<const unsigned int> indices)
+{
+    std::map<std::pair<unsigned int, unsigned int>, int> edgeCounts;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int a = indices[i + corner];
+            unsigned int b = indices[i + (corner + 1) % 3];
+            edgeCounts[std::minmax(a, b)]++;
+        }
+    }
+    return std::all_of(edgeCounts.begin(), edgeCounts.end(), [](const auto& edgeCount) { return edgeCount.second == 2; });
+}
+
+static void TestClosedMesh()
+{
+    TestMesh mesh = CreateCubeSphere(12);
+    unsigned int originalCount = static_cast<unsigned int>(mesh.indices.size() / 3);
+
+    MeshSimplifier simplifier(mesh.positions, mesh.indices);
+    Check(simplifier.GetTriangleCount() == originalCount, "Simplifier starts with all the triangles");
+
+    // Levels of detail, each one from the previous
+    const unsigned int targets[] = { originalCount / 2, originalCount / 8, originalCount / 32 };
+    for (unsigned int target : targets)
+    {
+        simplifier.Simplify(target);
+        unsigned int count = simplifier.GetTriangleCount();
+        Check(count <= target, "Closed mesh reaches the target triangle count");
+        Check(count + target / 10 + 2 >= target, "Closed mesh doesn't go far below the target triangle count");
+        Check(AllIndicesValid(simplifier.GetIndices(), mesh.positions.size()), "Closed mesh indices refer to original vertices");
+        Check(IsClosed(simplifier.GetIndices()), "Closed mesh stays closed");
+    }
+}
+
+static void TestOpenGrid(bool seam)
+{
+    const int segments = 16;
+    TestMesh mesh = CreateGrid(segments, seam);
+    unsigned int originalCount = static_cast<unsigned int>(mesh.indices.size() / 3);
+
+    MeshSimplifier simplifier(mesh.positions, mesh.indices);
+    simplifier.Simplify(originalCount / 4);
+    std::span<const unsigned int> indices = simplifier.GetIndices();
+
+    Check(simplifier.GetTriangleCount() < originalCount / 2, seam ? "Grid with a seam is simplified" : "Grid is simplified");
+    Check(AllIndicesValid(indices, mesh.positions.size()), "Grid indices refer to original vertices");
+
+    // Vertices are never moved, a collapsed vertex stops being used. Border and seam vertices must all still be there
+    std::set<unsigned int> usedVertices(indices.begin(), indices.end());
+    bool bordersKept = true;
+    for (int z = 0; z <= segments; ++z)
+    {
+        for (int x = 0; x <= segments; ++x)
+        {
+            bool border = x == 0 || z == 0 || x == segments || z == segments;
+            bool onSeam = seam && x == segments / 2;
+            if (border || onSeam)
+            {
+                bordersKept &= usedVertices.count(z * (segments + 1) + x) > 0;
+            }
+        }
+    }
+    for (unsigned int i = (segments + 1) * (segments + 1); i < mesh.positions.size(); ++i)
+    {
+        bordersKept &= usedVertices.count(i) > 0;
+    }
+    Check(bordersKept, seam ? "Border and seam vertices of the grid are kept" : "Border vertices of the grid are kept");
+}
+
+int main()
+{
+    TestClosedMesh();
+    TestOpenGrid(false);
+    TestOpenGrid(true);
+
+    return ReportChecks();
+}
@@ -0,0 +1,92 @@
+#include "TestCheck.h"
+
+#include <ituGL/renderer/OcclusionCuller.h>
+#include <ituGL/geometry/OccluderMesh.h>
+#include <ituGL/scene/Bounds.h>
+#include <ituGL/core/ThreadPool.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+// Camera at the origin looking down -Z, and a 4x4 wall quad at z = -5
+static glm::mat4 GetViewProjMatrix()
+{
+    return glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+}
+
+static OccluderMesh CreateWallQuad()
+{
+    const glm::vec3 vertices[4] = { glm::vec3(-2, -2, -5), glm::vec3(2, -2, -5), glm::vec3(2, 2, -5), glm::vec3(-2, 2, -5) };
+    const unsigned int indices[6] = { 0, 1, 2,  0, 2, 3 };
+    return OccluderMesh(vertices, indices);
+}
+
+static BoxBounds CreateBox(const glm::vec3& center, float halfSize)
+{
+    return BoxBounds(center, glm::mat3(1.0f), glm::vec3(halfSize));
+}
+
+static void TestOcclusionCuller()
+{
+    ThreadPool threadPool(2);
+    OccluderMesh wall = CreateWallQuad();
+    OcclusionCuller culler;
+
+    culler.AddOccluder(wall, glm::mat4(1.0f));
+    Check(!culler.IsRasterized(), "Culler is not rasterized before Rasterize");
+    Check(culler.IsVisible(CreateBox(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f)), "Boxes are visible before Rasterize");
+
+    culler.Rasterize(GetViewProjMatrix(), threadPool);
+    Check(culler.IsRasterized(), "Culler is rasterized after Rasterize");
+
+    const OcclusionCuller::Stats& stats = culler.GetStats();
+    Check(stats.occluders == 1, "Stats count the occluders");
+    Check(stats.triangles == 2, "Stats count the submitted triangles");
+    Check(stats.rasterizedTriangles == 2, "Stats count the rasterized triangles");
+
+    Check(!culler.IsVisible(CreateBox(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f)), "Box behind the wall is hidden");
+    Check(culler.IsVisible(CreateBox(glm::vec3(0.0f, 0.0f, -3.0f), 0.5f)), "Box in front of the wall is visible");
+    Check(culler.IsVisible(CreateBox(glm::vec3(0.0f, 0.0f, -4.8f), 0.5f)), "Box crossing the wall is visible");
+    Check(culler.IsVisible(CreateBox(glm::vec3(0.0f, 0.0f, 0.0f), 0.5f)), "Box crossing the near plane is visible");
+    Check(culler.IsVisible(CreateBox(glm::vec3(12.0f, 0.0f, -10.0f), 0.5f)), "Box behind the wall but beside it is visible");
+    Check(culler.IsVisible(CreateBox(glm::vec3(3.5f, 0.0f, -10.0f), 0.5f)), "Box partially behind the wall is visible");
+
+    // The depth in the middle of the wall matches the projection, and the pixels around it are far
+    glm::vec4 clipPosition = GetViewProjMatrix() * glm::vec4(0.0f, 0.0f, -5.0f, 1.0f);
+    float expectedDepth = clipPosition.z / clipPosition.w * 0.5f + 0.5f;
+    std::span<const float> depthBuffer = culler.GetDepthBuffer();
+    int width = culler.GetWidth();
+    int height = culler.GetHeight();
+    Check(std::abs(depthBuffer[(height / 2) * width + width / 2] - expectedDepth) < 1e-4f, "Depth of the wall matches the projection");
+    Check(depthBuffer[(height / 2) * width + 1] == 1.0f, "Pixels outside of the wall stay far");
+
+    culler.Clear();
+    Check(culler.IsVisible(CreateBox(glm::vec3(0.0f, 0.0f, -10.0f), 0.5f)), "Boxes are visible after Clear");
+}
+
+// Occluders crossing the near plane are clipped, the part in front of the camera still hides what is behind it
+static void TestNearPlaneClipping()
+{
+    ThreadPool threadPool(2);
+    const glm::vec3 vertices[4] = { glm::vec3(-50, -1, 10), glm::vec3(50, -1, 10), glm::vec3(50, -1, -50), glm::vec3(-50, -1, -50) };
+    const unsigned int indices[6] = { 0, 1, 2,  0, 2, 3 };
+    OccluderMesh floor(vertices, indices);
+
+    OcclusionCuller culler;
+    culler.AddOccluder(floor, glm::mat4(1.0f));
+    culler.Rasterize(GetViewProjMatrix(), threadPool);
+
+    const OcclusionCuller::Stats& stats = culler.GetStats();
+    Check(stats.triangles == 2, "Stats count the triangles before clipping");
+    Check(stats.rasterizedTriangles >= 2, "Clipped triangles are rasterized");
+    Check(!culler.IsVisible(CreateBox(glm::vec3(0.0f, -3.0f, -10.0f), 0.5f)), "Box under the clipped floor is hidden");
+    Check(culler.IsVisible(CreateBox(glm::vec3(0.0f, 1.0f, -10.0f), 0.5f)), "Box over the clipped floor is visible");
+}
+
+int main()
+{
+    TestOcclusionCuller();
+    TestNearPlaneClipping();
+
+    return ReportChecks();
+}
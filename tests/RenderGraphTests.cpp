@@ -0,0 +1,102 @@
+#include "TestCheck.h"
+
+#include <ituGL/renderer/RenderGraph.h>
+#include <ituGL/renderer/RenderPass.h>
+#include <algorithm>
+#include <span>
+
+// Passes are never created, the graph is only planned
+static const RenderGraph::CreatePassFunction s_createNothing = [](const RenderGraph&, std::shared_ptr<const FramebufferObject>) { return nullptr; };
+
+static const RenderGraph::TextureDesc s_colorDesc = { 64, 64, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
+static const RenderGraph::TextureDesc s_smallColorDesc = { 32, 32, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16F };
+
+static unsigned int GetPosition(const RenderGraph& graph, unsigned int passIndex)
+{
+    std::span<const unsigned int> executionOrder = graph.GetExecutionOrder();
+    return static_cast<unsigned int>(std::find(executionOrder.begin(), executionOrder.end(), passIndex) - executionOrder.begin());
+}
+
+// A -> B -> C -> D -> backbuffer. A and C, and B and D, are never alive at the same time
+static void TestChainAliasing()
+{
+    RenderGraph graph(64, 64);
+    RenderGraph::ResourceId a = graph.CreateTexture("A", s_colorDesc);
+    RenderGraph::ResourceId b = graph.CreateTexture("B", s_colorDesc);
+    RenderGraph::ResourceId c = graph.CreateTexture("C", s_colorDesc);
+    RenderGraph::ResourceId d = graph.CreateTexture("D", s_colorDesc);
+
+    graph.AddPass("WriteA", {}, { a }, s_createNothing);
+    graph.AddPass("AToB", { a }, { b }, s_createNothing);
+    graph.AddPass("BToC", { b }, { c }, s_createNothing);
+    graph.AddPass("CToD", { c }, { d }, s_createNothing);
+    graph.AddPass("DToBackbuffer", { d }, { graph.GetBackbuffer() }, s_createNothing);
+    graph.Plan();
+
+    Check(graph.GetExecutionOrder().size() == 5, "Chain keeps all the passes");
+    Check(graph.GetTransientTextureCount() == 4, "Chain has 4 transient resources");
+    Check(graph.GetAllocatedTextureCount() == 2, "Chain allocates 2 textures");
+    Check(graph.GetTextureIndex(a) == graph.GetTextureIndex(c), "Non-overlapping transients share a texture");
+    Check(graph.GetTextureIndex(b) == graph.GetTextureIndex(d), "Non-overlapping transients share a texture");
+    Check(graph.GetTextureIndex(a) != graph.GetTextureIndex(b), "Transients read and written by the same pass don't share");
+    Check(graph.GetTextureIndex(graph.GetBackbuffer()) == RenderGraph::InvalidResource, "Imported resources don't use the pool");
+}
+
+static void TestOverlappingLifetimes()
+{
+    RenderGraph graph(64, 64);
+    RenderGraph::ResourceId a = graph.CreateTexture("A", s_colorDesc);
+    RenderGraph::ResourceId b = graph.CreateTexture("B", s_colorDesc);
+    RenderGraph::ResourceId c = graph.CreateTexture("C", s_colorDesc);
+    RenderGraph::ResourceId small = graph.CreateTexture("Small", s_smallColorDesc);
+
+    // A is alive until the last pass, so nothing can share its texture
+    graph.AddPass("WriteA", {}, { a }, s_createNothing);
+    graph.AddPass("AToB", { a }, { b }, s_createNothing);
+    graph.AddPass("BToC", { b }, { c }, s_createNothing);
+    graph.AddPass("CToSmall", { c }, { small }, s_createNothing);
+    graph.AddPass("Combine", { a, small }, { graph.GetBackbuffer() }, s_createNothing);
+    graph.Plan();
+
+    Check(graph.GetTextureIndex(a) != graph.GetTextureIndex(b), "Overlapping transients don't share");
+    Check(graph.GetTextureIndex(a) != graph.GetTextureIndex(c), "Overlapping transients don't share");
+    Check(graph.GetTextureIndex(b) != graph.GetTextureIndex(c), "Transients read and written by the same pass don't share");
+    // B is free when Small is written, but the size is different
+    Check(graph.GetTextureIndex(small) != graph.GetTextureIndex(b), "Transients of different sizes don't share");
+    Check(graph.GetAllocatedTextureCount() == 4, "Each overlapping transient gets its own texture");
+}
+
+static void TestPassOrder()
+{
+    RenderGraph graph(64, 64);
+    RenderGraph::ResourceId gbuffer = graph.CreateTexture("GBuffer", s_colorDesc);
+    RenderGraph::ResourceId lighting = graph.CreateTexture("Lighting", s_colorDesc);
+    RenderGraph::ResourceId unused = graph.CreateTexture("Unused", s_colorDesc);
+
+    // Added out of order: the readers come before their writers
+    graph.AddPass("Compose", { lighting }, { graph.GetBackbuffer() }, s_createNothing);
+    graph.AddPass("Lighting", { gbuffer }, { lighting }, s_createNothing);
+    graph.AddPass("GBuffer", {}, { gbuffer }, s_createNothing);
+    graph.AddPass("Decals", { gbuffer }, { gbuffer }, s_createNothing);
+    graph.AddPass("Debug", { gbuffer }, { unused }, s_createNothing);
+    graph.Plan();
+
+    // Indices of the passes, in the order they were added
+    const unsigned int compose = 0, lightingPass = 1, gbufferPass = 2, decals = 3, debug = 4;
+    Check(graph.GetExecutionOrder().size() == 4, "Passes whose outputs are never read are culled");
+    Check(graph.GetCulledPassCount() == 1, "Culled passes are counted");
+    Check(GetPosition(graph, debug) == graph.GetExecutionOrder().size(), "Culled pass is not executed");
+    Check(GetPosition(graph, gbufferPass) < GetPosition(graph, decals), "Writers of the same resource keep the order they were added");
+    Check(GetPosition(graph, gbufferPass) < GetPosition(graph, lightingPass), "Readers run after the writers of what they read");
+    Check(GetPosition(graph, decals) < GetPosition(graph, lightingPass), "Readers run after all the writers of what they read");
+    Check(GetPosition(graph, lightingPass) < GetPosition(graph, compose), "Readers run after the writers of what they read");
+}
+
+int main()
+{
+    TestChainAliasing();
+    TestOverlappingLifetimes();
+    TestPassOrder();
+
+    return ReportChecks();
+}
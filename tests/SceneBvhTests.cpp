@@ -0,0 +1,85 @@
+#include "TestCheck.h"
+
+#include <ituGL/scene/Bounds.h>
+#include <ituGL/scene/SceneBvh.h>
+#include <ituGL/scene/SceneNode.h>
+#include <ituGL/scene/Transform.h>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtx/euler_angles.hpp>
+#include <memory>
+
+// Scene node with a fixed size around its translation
+class BoxSceneNode : public SceneNode
+{
+public:
+    BoxSceneNode(const std::string& name, const glm::vec3& center, const glm::vec3& size) : SceneNode(name), m_size(size)
+    {
+        GetTransform()->SetTranslation(center);
+    }
+
+    AabbBounds GetAabbBounds() const override
+    {
+        return AabbBounds(GetTransform()->GetTranslation(), m_size);
+    }
+
+private:
+    glm::vec3 m_size;
+};
+
+static unsigned int CountHits(const SceneBvh& bvh, const Bounds& bounds)
+{
+    unsigned int hitCount = 0;
+    bvh.Query(bounds, [&](SceneNode&) { ++hitCount; });
+    return hitCount;
+}
+
+static void TestBoxBounds()
+{
+    glm::mat3 identity(1.0f);
+    glm::mat3 rotated(glm::eulerAngleY(glm::quarter_pi<float>()));
+
+    BoxBounds unitBox(glm::vec3(0.0f), identity, glm::vec3(1.0f));
+    Check(Bounds::Intersects(unitBox, BoxBounds(glm::vec3(1.0f, 0.5f, 0.0f), identity, glm::vec3(1.0f))), "Overlapping aligned boxes intersect");
+    Check(Bounds::Intersects(unitBox, BoxBounds(glm::vec3(2.0f, 0.0f, 0.0f), identity, glm::vec3(1.0f))), "Touching aligned boxes intersect");
+    Check(!Bounds::Intersects(unitBox, BoxBounds(glm::vec3(2.5f, 0.0f, 0.0f), identity, glm::vec3(1.0f))), "Separated aligned boxes don't intersect");
+
+    // The corner of the rotated box reaches sqrt(2) along x
+    Check(Bounds::Intersects(unitBox, BoxBounds(glm::vec3(2.3f, 0.0f, 0.0f), rotated, glm::vec3(1.0f))), "Overlapping rotated boxes intersect");
+    Check(!Bounds::Intersects(unitBox, BoxBounds(glm::vec3(2.5f, 0.0f, 0.0f), rotated, glm::vec3(1.0f))), "Separated rotated boxes don't intersect");
+    // Overlapping along the axes of the aligned box, but not along the diagonal axis of the rotated one
+    Check(!Bounds::Intersects(unitBox, BoxBounds(glm::vec3(2.3f, 0.0f, 2.3f), rotated, glm::vec3(1.0f))), "Diagonally separated boxes don't intersect");
+    Check(Bounds::Intersects(unitBox, BoxBounds(glm::vec3(2.0f, 2.0f, 0.0f), rotated, glm::vec3(1.0f))), "Boxes touching at an edge intersect");
+}
+
+static void TestBvhBoxQuery()
+{
+    SceneBvh bvh;
+    BoxSceneNode nodeA("a", glm::vec3(0.0f), glm::vec3(1.0f));
+    BoxSceneNode nodeB("b", glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+    bvh.AddSceneNode(nodeA);
+    bvh.AddSceneNode(nodeB);
+
+    glm::mat3 identity(1.0f);
+    glm::mat3 rotated(glm::eulerAngleY(glm::quarter_pi<float>()));
+    Check(CountHits(bvh, BoxBounds(glm::vec3(0.5f), rotated, glm::vec3(0.5f))) == 1, "Box query finds the overlapping node");
+    Check(CountHits(bvh, BoxBounds(glm::vec3(2.0f, 0.0f, 0.0f), identity, glm::vec3(1.0f))) == 1, "Box query finds the touching node");
+    Check(CountHits(bvh, BoxBounds(glm::vec3(5.0f, 0.0f, 0.0f), rotated, glm::vec3(1.0f))) == 0, "Box query between the nodes finds nothing");
+    Check(CountHits(bvh, BoxBounds(glm::vec3(5.0f, 0.0f, 0.0f), identity, glm::vec3(6.0f, 1.0f, 1.0f))) == 2, "Box query covering both nodes finds both");
+
+    // Moving a node is found by the next refit, without invalidating it
+    nodeB.GetTransform()->SetTranslation(glm::vec3(5.0f, 0.0f, 0.0f));
+    Check(bvh.Refit() == 1, "Refit moves the changed node");
+    Check(CountHits(bvh, BoxBounds(glm::vec3(5.0f, 0.0f, 0.0f), rotated, glm::vec3(1.0f))) == 1, "Box query finds the moved node");
+    Check(bvh.Refit() == 0, "Refit without changes moves nothing");
+
+    bvh.RemoveSceneNode(nodeA);
+    bvh.RemoveSceneNode(nodeB);
+}
+
+int main()
+{
+    TestBoxBounds();
+    TestBvhBoxQuery();
+
+    return ReportChecks();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iostream>
+
+// Checks shared by the test executables. Failures are counted, so a run reports all of them
+inline int s_failureCount = 0;
+
+inline void Check(bool condition, const char* description)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << description << std::endl;
+        ++s_failureCount;
+    }
+}
+
+// Result of main, after printing the number of failed checks
+inline int ReportChecks()
+{
+    if (s_failureCount > 0)
+    {
+        std::cerr << s_failureCount << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}